@@ -59,6 +59,8 @@ quickjs_apply_patches(
 		"005-fix-pedantic-cxx-warnings.patch"
 		"006-bsd-compile-fixes.patch"
 		"007-msvc-64bit-compatibility.patch"
+		"008-add-update-stack-top.patch"
+		"009-add-get-malloc-size.patch"
 )
 
 message(STATUS "Finished applying patches.")
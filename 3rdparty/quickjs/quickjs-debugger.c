@@ -25,6 +25,8 @@
  * THE SOFTWARE.
  */
 
+#include "quickjs-debugger.h"
+
 JSValue js_debugger_get_current_funcObject(JSContext *ctx)
 {
 	JSStackFrame *sf = ctx->rt->current_stack_frame;
@@ -107,3 +109,29 @@ JSValue js_debugger_build_backtrace(JSContext *ctx, const uint8_t *cur_pc)
     }
     return ret;
 }
+
+int js_debugger_get_stack(JSRuntime *rt, JSDebuggerStackFrame *frames, int max_frames)
+{
+    JSStackFrame *sf;
+    JSObject *p;
+    int count = 0;
+
+    for(sf = rt->current_stack_frame; sf != NULL && count < max_frames; sf = sf->prev_frame) {
+        JSDebuggerStackFrame *frame = &frames[count++];
+        frame->function_name = JS_ATOM_NULL;
+        frame->filename = JS_ATOM_NULL;
+        frame->line = -1;
+        if (JS_VALUE_GET_TAG(sf->cur_func) != JS_TAG_OBJECT)
+            continue;
+        p = JS_VALUE_GET_OBJ(sf->cur_func);
+        if (js_class_has_bytecode(p->class_id)) {
+            JSFunctionBytecode *b = p->u.func.function_bytecode;
+            frame->function_name = b->func_name;
+            if (b->has_debug) {
+                frame->filename = b->debug.filename;
+                frame->line = b->debug.line_num;
+            }
+        }
+    }
+    return count;
+}
@@ -36,6 +36,17 @@ JSValue js_debugger_get_caller_funcObject(JSContext *ctx);
 JSValue js_debugger_get_caller_name(JSContext *ctx);
 JSValue js_debugger_build_backtrace(JSContext *ctx, const uint8_t *cur_pc);
 
+typedef struct JSDebuggerStackFrame
+{
+	JSAtom function_name; // JS_ATOM_NULL for native functions
+	JSAtom filename;      // JS_ATOM_NULL if unknown
+	int line;             // line of the function definition, or -1 if unknown
+} JSDebuggerStackFrame;
+
+// Fills frames with the current call stack, innermost frame first, and returns the number of frames filled in.
+// Does not allocate, so it can be called from an interrupt handler. The atoms are not duplicated.
+int js_debugger_get_stack(JSRuntime *rt, JSDebuggerStackFrame *frames, int max_frames);
+
 #ifdef __cplusplus
 } /* extern "C" { */
 #endif
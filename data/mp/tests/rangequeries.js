@@ -0,0 +1,47 @@
+// Checks the batched range queries against enumRange(), which takes the same positions, a few times during the game.
+// Loaded by rangequeries.json, see tests/test.sh.
+
+const RANGE = 8;
+const NEAREST = 5;
+
+function checkRangeQueries()
+{
+	var positions = [];
+	for (var playnum = 0; playnum < maxPlayers; playnum++)
+	{
+		enumDroid(playnum).concat(enumStruct(playnum)).forEach(function(obj) {
+			positions.push({ x: obj.x, y: obj.y });
+		});
+	}
+	var nearest = enumRangeNearest(positions, RANGE, NEAREST);
+	var counts = countRange(positions, RANGE);
+	var threats = threatRange(positions, RANGE, ALL_PLAYERS);
+	hackAssert(nearest.length === positions.length, "enumRangeNearest() returned", nearest.length, "results for", positions.length, "positions");
+	hackAssert(counts.length === positions.length, "countRange() returned", counts.length, "results for", positions.length, "positions");
+	hackAssert(threats.length === positions.length, "threatRange() returned", threats.length, "results for", positions.length, "positions");
+	for (var i = 0; i < positions.length; i++)
+	{
+		var pos = positions[i];
+		var all = enumRange(pos.x, pos.y, RANGE);
+		var ids = all.map(function(obj) { return obj.id; });
+		var droids = all.filter(function(obj) { return obj.type === DROID; }).length;
+		var structures = all.filter(function(obj) { return obj.type === STRUCTURE; }).length;
+		var features = all.filter(function(obj) { return obj.type === FEATURE; }).length;
+		var where = "at " + pos.x + ", " + pos.y;
+		hackAssert(counts[i].droids === droids, "countRange() found", counts[i].droids, "droids", where, "but enumRange()", droids);
+		hackAssert(counts[i].structures === structures, "countRange() found", counts[i].structures, "structures", where, "but enumRange()", structures);
+		hackAssert(counts[i].features === features, "countRange() found", counts[i].features, "features", where, "but enumRange()", features);
+		hackAssert(nearest[i].length === Math.min(NEAREST, all.length), "enumRangeNearest() found", nearest[i].length, "objects", where, "but enumRange()", all.length);
+		nearest[i].forEach(function(obj) {
+			hackAssert(ids.indexOf(obj.id) >= 0, "enumRangeNearest() found object", obj.id, where, "which enumRange() didn't");
+		});
+		hackAssert(threats[i] >= 0, "threatRange() returned", threats[i], where);
+	}
+	debug("Range queries checked at", positions.length, "positions");
+}
+
+function eventStartLevel()
+{
+	checkRangeQueries();
+	setTimer("checkRangeQueries", 60000);
+}
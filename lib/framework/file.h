@@ -23,6 +23,8 @@
 
 #include "crc.h"
 
+#include <vector>
+
 /*! Open a file for reading */
 WZ_DECL_NONNULL(1) PHYSFS_file *openLoadFile(const char *fileName, bool hard_fail);
 
@@ -43,4 +45,18 @@ WZ_DECL_NONNULL(1, 2) bool loadFileToBufferNoError(const char *pFileName, char *
 
 WZ_DECL_NONNULL(1) Sha256 findHashOfFile(char const *realFileName);
 
+#define CACHE_FILE_MAGIC_SIZE 8
+
+/**
+ * Load a file saved by saveCacheFile(), if it is there and has the given magic and an intact checksum.
+ * Only files in the write directory are loaded, not ones that map archives or mods put in the search path ahead of it.
+ */
+WZ_DECL_NONNULL(1) bool loadCacheFile(const char *fileName, const char (&magic)[CACHE_FILE_MAGIC_SIZE], std::vector<uint8_t> &data);
+
+/**
+ * Save the data into the given file in the cache directory, after the magic and a checksum.
+ * Failing is not an error, since whatever is cached can be worked out again, so it is only logged, and the file is deleted.
+ */
+WZ_DECL_NONNULL(1) bool saveCacheFile(const char *fileName, const char (&magic)[CACHE_FILE_MAGIC_SIZE], const void *data, size_t size);
+
 #endif // _file_h
@@ -34,6 +34,8 @@
 #include "frameresource.h"
 #include "input.h"
 
+#include <string>
+
 /************************************************************************************
  *
  *	Player globals
@@ -335,6 +337,78 @@ Sha256 findHashOfFile(char const *realFileName)
 	return zero;
 }
 
+/// Bigger cache files are taken to be damaged.
+#define CACHE_FILE_MAX_SIZE (64 * 1024 * 1024)
+
+// Layout of a cache file: magic, SHA-256 of the data, data.
+bool loadCacheFile(const char *fileName, const char (&magic)[CACHE_FILE_MAGIC_SIZE], std::vector<uint8_t> &data)
+{
+	// Only trust files we wrote ourselves. Map archives and mods are searched before the write dir, and could otherwise ship
+	// a cache file for any key, since the keys are only hashes of things they know.
+	const char *realDir = PHYSFS_getRealDir(fileName);
+	const char *writeDir = PHYSFS_getWriteDir();
+	if (realDir == nullptr || writeDir == nullptr || strcmp(realDir, writeDir) != 0)
+	{
+		if (realDir != nullptr)
+		{
+			debug(LOG_WARNING, "Ignoring cache file %s from %s, outside the write directory", fileName, realDir);
+		}
+		return false;
+	}
+	PHYSFS_file *fileHandle = PHYSFS_openRead(fileName);
+	if (fileHandle == nullptr)
+	{
+		return false;
+	}
+	const PHYSFS_sint64 headerSize = CACHE_FILE_MAGIC_SIZE + Sha256::Bytes;
+	const PHYSFS_sint64 fileSize = PHYSFS_fileLength(fileHandle);
+	char storedMagic[CACHE_FILE_MAGIC_SIZE];
+	Sha256 storedHash;
+	bool ok = fileSize >= headerSize && fileSize <= CACHE_FILE_MAX_SIZE;
+	ok = ok && WZ_PHYSFS_readBytes(fileHandle, storedMagic, CACHE_FILE_MAGIC_SIZE) == CACHE_FILE_MAGIC_SIZE && memcmp(storedMagic, magic, CACHE_FILE_MAGIC_SIZE) == 0;
+	ok = ok && WZ_PHYSFS_readBytes(fileHandle, storedHash.bytes, Sha256::Bytes) == Sha256::Bytes;
+	data.resize(ok ? fileSize - headerSize : 0);
+	ok = ok && WZ_PHYSFS_readBytes(fileHandle, data.data(), static_cast<PHYSFS_uint32>(data.size())) == static_cast<PHYSFS_sint64>(data.size());
+	PHYSFS_close(fileHandle);
+	if (ok && sha256Sum(data.data(), data.size()) != storedHash)
+	{
+		debug(LOG_WARNING, "Ignoring damaged cache file %s", fileName);
+		ok = false;
+	}
+	if (!ok)
+	{
+		data.clear();
+	}
+	return ok;
+}
+
+bool saveCacheFile(const char *fileName, const char (&magic)[CACHE_FILE_MAGIC_SIZE], const void *data, size_t size)
+{
+	std::string dir = fileName;
+	size_t slash = dir.find_last_of('/');
+	if (slash != std::string::npos)
+	{
+		PHYSFS_mkdir(dir.erase(slash).c_str());
+	}
+	Sha256 hash = sha256Sum(data, size);
+	PHYSFS_file *fileHandle = PHYSFS_openWrite(fileName);
+	bool ok = fileHandle != nullptr && size <= CACHE_FILE_MAX_SIZE;
+	ok = ok && WZ_PHYSFS_writeBytes(fileHandle, magic, CACHE_FILE_MAGIC_SIZE) == CACHE_FILE_MAGIC_SIZE;
+	ok = ok && WZ_PHYSFS_writeBytes(fileHandle, hash.bytes, Sha256::Bytes) == Sha256::Bytes;
+	ok = ok && WZ_PHYSFS_writeBytes(fileHandle, data, static_cast<PHYSFS_uint32>(size)) == static_cast<PHYSFS_sint64>(size);
+	if (fileHandle != nullptr && !PHYSFS_close(fileHandle))
+	{
+		ok = false;
+	}
+	if (!ok)
+	{
+		// Not a problem, whatever was cached will just be worked out again next time.
+		debug(LOG_WZ, "Could not write cache file %s: %s", fileName, WZ_PHYSFS_getLastError());
+		PHYSFS_delete(fileName);
+	}
+	return ok;
+}
+
 bool PHYSFS_printf(PHYSFS_file *file, const char *format, ...)
 {
 	char vaBuffer[PATH_MAX];
@@ -18,12 +18,14 @@
 */
 #include "frame.h"
 
+#include <mutex>
 #include <sstream>
 #include <vector>
 
 #include <locale.h>
 #include <physfs.h>
 #include "wzpaths.h"
+#include "stringhash.h"
 
 #ifdef WZ_OS_MAC
 # include <CoreFoundation/CoreFoundation.h>
@@ -214,6 +216,59 @@ static unsigned int selectedLanguage = 0;
 
 static char *compileDate = nullptr;
 
+#if defined(ENABLE_NLS)
+/// Stop caching translations after this many, in case something translates lots of made up strings.
+#define MAX_CACHED_TRANSLATIONS 8192
+
+/// Translations looked up so far, NULL for strings which have none. Function local, since _() can be used by static initialisers.
+static StringHashTable &translationCache(std::mutex **lock)
+{
+	static std::mutex cacheLock;
+	static StringHashTable cache;
+	*lock = &cacheLock;
+	return cache;
+}
+
+static void clearTranslationCache()
+{
+	std::mutex *lock;
+	StringHashTable &cache = translationCache(&lock);
+	std::lock_guard<std::mutex> guard(*lock);
+	cache.clear();
+}
+#endif
+
+/*!
+ * Translate a message, like gettext(). The same labels and tooltips are translated over and over by the UI,
+ * and gettext() has to check the locale and search the loaded catalogs every time, so remember the results.
+ */
+const char *wzGettext(const char *msgid)
+{
+#if !defined(ENABLE_NLS)
+	return msgid;
+#else
+	std::mutex *lock;
+	StringHashTable &cache = translationCache(&lock);
+	std::lock_guard<std::mutex> guard(*lock);
+	const char *translation;
+	if (!cache.find(msgid, &translation))
+	{
+		// gettext() returns msgid itself when there is no translation. Don't keep that, it belongs to the caller.
+		// Translations stay valid after changing language, so pointers already handed out don't dangle.
+		translation = gettext(msgid);
+		if (translation == msgid)
+		{
+			translation = nullptr;
+		}
+		if (cache.size() < MAX_CACHED_TRANSLATIONS)
+		{
+			cache.insert(msgid, translation, false);
+		}
+	}
+	return translation != nullptr ? translation : msgid;
+#endif
+}
+
 /*!
  * Return the language part of the selected locale
  */
@@ -390,6 +445,7 @@ bool setLanguage(const char *language)
 		if (strcmp(language, map[i].language) == 0)
 		{
 			selectedLanguage = i;
+			clearTranslationCache();
 			debug(LOG_WZ, "Setting language to \"%s\" (%s)", map[i].name, map[i].language);
 
 #  if defined(WZ_OS_WIN)
@@ -42,7 +42,7 @@
 #endif
 
 
-#define _(String) gettext(String)
+#define _(String) wzGettext(String)
 #define N_(String) gettext_noop(String)
 
 // Context sensitive strings
@@ -52,6 +52,9 @@
 // Make xgettext recognize the context
 #define NP_(Context, String) gettext_noop(String)
 
+/// Cached gettext(), see _().
+const char *wzGettext(const char *msgid);
+
 WZ_DECL_PURE const char *getLanguage();
 WZ_DECL_PURE const char *getLanguageName();
 WZ_DECL_NONNULL(1) bool setLanguage(const char *name);
@@ -67,8 +67,10 @@ int lexer_input(lexerinput_t *input, char *buf, size_t max_size, int nullvalue)
 	case LEXINPUT_BUFFER:
 		if (input->input.buffer.begin != input->input.buffer.end)
 		{
-			buf[0] = *input->input.buffer.begin++;
-			return 1;
+			size_t length = std::min<size_t>(std::min<size_t>(max_size, input->input.buffer.end - input->input.buffer.begin), std::numeric_limits<int>::max());
+			memcpy(buf, input->input.buffer.begin, length);
+			input->input.buffer.begin += length;
+			return static_cast<int>(length);
 		}
 		else
 		{
@@ -20,6 +20,19 @@
 #include "physfs_ext.h"
 #include "frame.h"
 
+#include <limits>
+#include <string.h>
+
+#if defined(WZ_OS_UNIX)
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+/// Smaller files are read into a buffer, since setting up and tearing down a mapping costs more than copying them.
+#define FILE_VIEW_MIN_MAPPED_SIZE (64 * 1024)
+
 bool WZ_PHYSFS_enumerateFiles(const char *dir, const std::function<bool (char* file)>& enumFunc)
 {
 	char **files = PHYSFS_enumerateFiles(dir);
@@ -38,3 +51,181 @@ bool WZ_PHYSFS_enumerateFiles(const char *dir, const std::function<bool (char* f
 	PHYSFS_freeList(files);
 	return true;
 }
+
+WzFileView::WzFileView(WzFileView &&other)
+	: mData(other.mData)
+	, mSize(other.mSize)
+	, mMapped(other.mMapped)
+	, mBuffer(std::move(other.mBuffer))
+{
+	other.mData = nullptr;
+	other.mSize = 0;
+	other.mMapped = false;
+}
+
+WzFileView &WzFileView::operator =(WzFileView &&other)
+{
+	if (this != &other)
+	{
+		close();
+		mData = other.mData;
+		mSize = other.mSize;
+		mMapped = other.mMapped;
+		mBuffer = std::move(other.mBuffer);
+		other.mData = nullptr;
+		other.mSize = 0;
+		other.mMapped = false;
+	}
+	return *this;
+}
+
+WzFileView::~WzFileView()
+{
+	close();
+}
+
+void WzFileView::close()
+{
+	if (mMapped)
+	{
+#if defined(WZ_OS_WIN)
+		UnmapViewOfFile(mData);
+#elif defined(WZ_OS_UNIX)
+		munmap(const_cast<char *>(mData), mSize);
+#endif
+	}
+	mData = nullptr;
+	mSize = 0;
+	mMapped = false;
+	mBuffer.clear();
+	mBuffer.shrink_to_fit();
+}
+
+/// Maps the file, if it is a plain file on disk. Files in archives can't be mapped, since PhysFS doesn't say where in the archive they are, nor whether they are compressed.
+bool WzFileView::map(const char *fileName)
+{
+	const char *realDir = PHYSFS_getRealDir(fileName);
+	const char *mountPoint = realDir != nullptr ? PHYSFS_getMountPoint(realDir) : nullptr;
+	if (mountPoint == nullptr)
+	{
+		return false;
+	}
+	if (strcmp(mountPoint, "/") != 0)
+	{
+		size_t mountPointLength = strlen(mountPoint);
+		if (strncmp(fileName, mountPoint, mountPointLength) != 0)
+		{
+			return false;
+		}
+		fileName += mountPointLength;
+	}
+	std::string path = realDir;
+	if (!path.empty() && path.back() != *PHYSFS_getDirSeparator())
+	{
+		path += PHYSFS_getDirSeparator();
+	}
+	for (const char *c = fileName; *c != '\0'; ++c)
+	{
+		path += *c == '/' ? *PHYSFS_getDirSeparator() : *c;
+	}
+
+	// If realDir is an archive, opening a path inside it fails, and the file is read through PhysFS instead.
+#if defined(WZ_OS_WIN)
+	int wcharsRequired = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+	if (wcharsRequired <= 0)
+	{
+		return false;
+	}
+	std::vector<wchar_t> widePath(wcharsRequired);
+	if (MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, widePath.data(), wcharsRequired) == 0)
+	{
+		return false;
+	}
+	HANDLE file = CreateFileW(widePath.data(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < FILE_VIEW_MIN_MAPPED_SIZE || static_cast<uint64_t>(fileSize.QuadPart) > std::numeric_limits<size_t>::max())
+	{
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr)
+	{
+		return false;
+	}
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);  // The view keeps the mapping alive.
+	if (data == nullptr)
+	{
+		return false;
+	}
+	mData = static_cast<const char *>(data);
+	mSize = static_cast<size_t>(fileSize.QuadPart);
+	mMapped = true;
+	return true;
+#elif defined(WZ_OS_UNIX)
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size < FILE_VIEW_MIN_MAPPED_SIZE || static_cast<uint64_t>(fileStat.st_size) > std::numeric_limits<size_t>::max())
+	{
+		::close(fd);
+		return false;
+	}
+	void *data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);  // The mapping keeps the file open.
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+	mData = static_cast<const char *>(data);
+	mSize = static_cast<size_t>(fileStat.st_size);
+	mMapped = true;
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool WzFileView::open(const char *fileName)
+{
+	close();
+	if (map(fileName))
+	{
+		return true;
+	}
+
+	PHYSFS_file *fileHandle = PHYSFS_openRead(fileName);
+	if (fileHandle == nullptr)
+	{
+		debug(LOG_ERROR, "Could not open \"%s\": %s", fileName, WZ_PHYSFS_getLastError());
+		return false;
+	}
+	PHYSFS_sint64 fileSize = PHYSFS_fileLength(fileHandle);
+	if (fileSize < 0 || fileSize >= static_cast<PHYSFS_sint64>(std::numeric_limits<PHYSFS_sint32>::max()))
+	{
+		debug(LOG_ERROR, "Could not get a usable length of \"%s\"", fileName);
+		PHYSFS_close(fileHandle);
+		return false;
+	}
+	mBuffer.resize(static_cast<size_t>(fileSize));
+	PHYSFS_sint64 lengthRead = WZ_PHYSFS_readBytes(fileHandle, mBuffer.data(), static_cast<PHYSFS_uint32>(fileSize));
+	PHYSFS_close(fileHandle);
+	if (lengthRead != fileSize)
+	{
+		debug(LOG_ERROR, "Reading \"%s\" short: %s", fileName, WZ_PHYSFS_getLastError());
+		mBuffer.clear();
+		return false;
+	}
+	mData = mBuffer.data();
+	mSize = mBuffer.size();
+	return true;
+}
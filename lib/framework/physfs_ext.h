@@ -29,6 +29,7 @@
 #include "wzglobal.h"
 
 #include <functional>
+#include <vector>
 
 #define PHYSFS_APPEND 1
 #define PHYSFS_PREPEND 0
@@ -152,6 +153,49 @@ static inline PHYSFS_ErrorCode _WZ_PHYSFS_setBuffer(PHYSFS_File *fileHandle, PHY
 // enumFunc receives each enumerated file, and returns true to continue enumeration, or false to shortcut / stop enumeration
 bool WZ_PHYSFS_enumerateFiles(const char *dir, const std::function<bool (char* file)>& enumFunc);
 
+/**
+ * Read only view of the contents of a file in the search path.
+ *
+ * Files big enough to be worth it, which are in a plain directory rather than an archive, are memory mapped,
+ * so nothing is copied until the pages are touched. Anything else is read into a buffer, like loadFile() does.
+ * Unlike with loadFile(), the data is not nul terminated, so it must only be used together with size().
+ */
+class WzFileView
+{
+public:
+	WzFileView() = default;
+	WzFileView(WzFileView &&other);
+	WzFileView &operator =(WzFileView &&other);
+	WzFileView(const WzFileView &) = delete;
+	WzFileView &operator =(const WzFileView &) = delete;
+	~WzFileView();
+
+	/// Replaces the contents of the view by the given file. Returns false, and logs why, if it could not be read.
+	bool open(const char *fileName);
+	void close();
+
+	const char *data() const
+	{
+		return mData;
+	}
+	size_t size() const
+	{
+		return mSize;
+	}
+	bool isMapped() const
+	{
+		return mMapped;
+	}
+
+private:
+	bool map(const char *fileName);
+
+	const char *mData = nullptr;
+	size_t mSize = 0;
+	bool mMapped = false;      ///< Whether mData is a memory mapping, rather than mBuffer.
+	std::vector<char> mBuffer;
+};
+
 // Older wrappers
 
 static inline bool PHYSFS_writeSLE8(PHYSFS_file *file, int8_t val)
@@ -0,0 +1,143 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include <string.h>
+#include <stdlib.h>
+
+/* Allow frame header files to be singly included */
+#define FRAME_LIB_INCLUDE
+
+#include "types.h"
+#include "debug.h"
+#include "stringhash.h"
+
+#include <algorithm>
+
+StringHashTable::~StringHashTable()
+{
+	clear();
+}
+
+uint32_t StringHashTable::hash(const char *key)
+{
+	uint32_t h = 2166136261u;
+	for (const unsigned char *c = (const unsigned char *)key; *c != '\0'; ++c)
+	{
+		h = (h ^ *c) * 16777619u;
+	}
+	return h;
+}
+
+/// Returns the slot holding key, or the empty slot where it would go. The table must not be full.
+size_t StringHashTable::findSlot(const char *key, uint32_t keyHash) const
+{
+	size_t mask = entries.size() - 1;
+	for (size_t slot = keyHash & mask;; slot = (slot + 1) & mask)
+	{
+		Entry const &entry = entries[slot];
+		if (entry.key == nullptr || (entry.hash == keyHash && strcmp(entry.key, key) == 0))
+		{
+			return slot;
+		}
+	}
+}
+
+void StringHashTable::grow()
+{
+	std::vector<Entry> oldEntries(std::max<size_t>(entries.size() * 2, 64), Entry{0, nullptr, nullptr});
+	oldEntries.swap(entries);
+	for (Entry const &entry : oldEntries)
+	{
+		if (entry.key != nullptr)
+		{
+			entries[findSlot(entry.key, entry.hash)] = entry;
+		}
+	}
+}
+
+void StringHashTable::insert(const char *key, const char *value, bool copyValue)
+{
+	ASSERT_OR_RETURN(, value != nullptr || !copyValue, "No value to copy for \"%s\"", key);
+
+	// Keep at most half the slots in use, so probe sequences stay short.
+	if ((count + 1) * 2 > entries.size())
+	{
+		grow();
+	}
+
+	uint32_t keyHash = hash(key);
+	Entry &entry = entries[findSlot(key, keyHash)];
+	if (entry.key != nullptr)
+	{
+		free(entry.key);
+		--count;
+	}
+
+	/* Put the key and the copy of the value in the same chunk of memory, so a single free() releases both. */
+	const size_t keySize = strlen(key) + 1;
+	const size_t valueSize = copyValue ? strlen(value) + 1 : 0;
+	char *memory = (char *)malloc(keySize + valueSize);
+	if (memory == nullptr)
+	{
+		debug(LOG_FATAL, "Out of memory");
+		abort();
+		return;
+	}
+	entry.hash = keyHash;
+	entry.key = strcpy(memory, key);
+	entry.value = copyValue ? strcpy(memory + keySize, value) : value;
+	++count;
+}
+
+bool StringHashTable::find(const char *key, const char **value) const
+{
+	if (count == 0)
+	{
+		return false;
+	}
+	Entry const &entry = entries[findSlot(key, hash(key))];
+	if (entry.key == nullptr)
+	{
+		return false;
+	}
+	*value = entry.value;
+	return true;
+}
+
+const char *StringHashTable::findKey(const char *value) const
+{
+	for (Entry const &entry : entries)
+	{
+		if (entry.key != nullptr && entry.value != nullptr && strcmp(entry.value, value) == 0)
+		{
+			return entry.key;
+		}
+	}
+	return nullptr;
+}
+
+void StringHashTable::clear()
+{
+	for (Entry const &entry : entries)
+	{
+		free(entry.key);
+	}
+	entries.clear();
+	count = 0;
+}
@@ -0,0 +1,79 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/*! \file stringhash.h
+ *  \brief Hash table from strings to strings
+ *
+ * Open addressing with linear probing, for tables which are looked up far more often than they are changed.
+ * The hash of each key is kept next to it, so a probe only compares strings when the hashes match.
+ */
+#ifndef _stringhash_h
+#define _stringhash_h
+
+#include "types.h"
+
+#include <vector>
+
+class StringHashTable
+{
+public:
+	StringHashTable() = default;
+	StringHashTable(const StringHashTable &) = delete;
+	StringHashTable &operator =(const StringHashTable &) = delete;
+	~StringHashTable();
+
+	/**
+	 * Maps a copy of key to value, replacing any previous value.
+	 *
+	 * \param copyValue Whether to store a copy of value, rather than value itself, which must then outlive the table.
+	 *                  value may be NULL if it is not copied.
+	 */
+	void insert(const char *key, const char *value, bool copyValue);
+
+	/// Returns whether key is in the table, and if so, sets *value to its value.
+	bool find(const char *key, const char **value) const;
+
+	/// Returns the key of the first entry found with the given value, or NULL. Has to look at every entry.
+	const char *findKey(const char *value) const;
+
+	void clear();
+
+	size_t size() const
+	{
+		return count;
+	}
+
+	/// FNV-1a.
+	static uint32_t hash(const char *key);
+
+private:
+	struct Entry
+	{
+		uint32_t hash;
+		char *key;          ///< Allocated together with the value, if it is a copy. NULL for empty slots.
+		const char *value;
+	};
+
+	size_t findSlot(const char *key, uint32_t keyHash) const;
+	void grow();
+
+	std::vector<Entry> entries;  ///< Size is zero or a power of two.
+	size_t count = 0;
+};
+
+#endif // _stringhash_h
@@ -32,7 +32,7 @@
 
 #include "types.h"
 #include "debug.h"
-#include "treap.h"
+#include "stringhash.h"
 #include "strres.h"
 #include "strresly.h"
 #include "physfs_ext.h"
@@ -40,38 +40,19 @@
 /* A String Resource */
 struct STR_RES
 {
-	struct TREAP_NODE     **psIDTreap;              ///< The treap to store string identifiers
+	StringHashTable strings;                        ///< The strings by identifier
 };
 
 /* Initialise the string system */
 STR_RES *strresCreate()
 {
-	STR_RES *const psRes = (STR_RES *)malloc(sizeof(*psRes));
-	if (!psRes)
-	{
-		debug(LOG_FATAL, "Out of memory");
-		abort();
-		return nullptr;
-	}
-
-	psRes->psIDTreap = treapCreate();
-	if (!psRes->psIDTreap)
-	{
-		debug(LOG_FATAL, "Out of memory");
-		abort();
-		free(psRes);
-		return nullptr;
-	}
-
-	return psRes;
+	return new STR_RES;
 }
 
 /* Shutdown the string system */
 void strresDestroy(STR_RES *psRes)
 {
-	// Release the treap and free the final memory
-	treapDestroy(psRes->psIDTreap);
-	free(psRes);
+	delete psRes;
 }
 
 
@@ -79,19 +60,23 @@ void strresDestroy(STR_RES *psRes)
 bool strresStoreString(STR_RES *psRes, const char *pID, const char *pString)
 {
 	// Make sure that this ID string hasn't been used before
-	if (treapFind(psRes->psIDTreap, pID) != nullptr)
+	const char *existing;
+	if (psRes->strings.find(pID, &existing))
 	{
 		debug(LOG_FATAL, "Duplicate string for id: \"%s\"", pID);
 		abort();
 		return false;
 	}
 
-	return treapAdd(psRes->psIDTreap, pID, pString);
+	psRes->strings.insert(pID, pString, true);
+	return true;
 }
 
 const char *strresGetString(const STR_RES *psRes, const char *ID)
 {
-	return treapFind(psRes->psIDTreap, ID);
+	const char *string = nullptr;
+	psRes->strings.find(ID, &string);
+	return string;
 }
 
 /* Load a string resource file */
@@ -99,22 +84,22 @@ bool strresLoad(STR_RES *psRes, const char *fileName)
 {
 	bool retval;
 	lexerinput_t input;
+	WzFileView file;
 
-	input.type = LEXINPUT_PHYSFS;
-	input.input.physfsfile = PHYSFS_openRead(fileName);
 	debug(LOG_WZ, "Reading...[directory %s] %s", WZ_PHYSFS_getRealDir_String(fileName).c_str(), fileName);
-	if (!input.input.physfsfile)
+	if (!file.open(fileName))
 	{
-		debug(LOG_ERROR, "strresLoadFile: PHYSFS_openRead(\"%s\") failed with error: %s\n", fileName, WZ_PHYSFS_getLastError());
+		debug(LOG_ERROR, "strresLoadFile: could not read \"%s\"", fileName);
 		return false;
 	}
-	WZ_PHYSFS_SETBUFFER(input.input.physfsfile, 4096)//;
+	input.type = LEXINPUT_BUFFER;
+	input.input.buffer.begin = file.data();
+	input.input.buffer.end = file.data() + file.size();
 
 	strres_set_extra(&input);
 	retval = (strres_parse(psRes) == 0);
 
 	strres_lex_destroy();
-	PHYSFS_close(input.input.physfsfile);
 
 	return retval;
 }
@@ -122,5 +107,5 @@ bool strresLoad(STR_RES *psRes, const char *fileName)
 /* Get the ID number for a string*/
 const char *strresGetIDfromString(STR_RES *psRes, const char *pString)
 {
-	return treapFindKey(psRes->psIDTreap, pString);
+	return psRes->strings.findKey(pString);
 }
@@ -27,20 +27,239 @@
 #include <physfs.h>
 #include "file.h"
 #include <sstream>
+#include <unordered_map>
 #include "physfs_ext.h"
+#include "wzapp.h"
 
-WzConfig::~WzConfig()
+#if !defined(ZLIB_CONST)
+#  define ZLIB_CONST
+#endif
+#include <zlib.h>
+
+static const char binaryJsonMagic[4] = {'W', 'Z', 'B', 'J'};
+#define BINARY_JSON_VERSION 1
+
+/// Deflates whatever is written to it straight into a file, so that the whole document never has to be in memory twice.
+class DeflateStreamBuf : public std::streambuf
 {
-	if (mWarning == ReadAndWrite)
+public:
+	DeflateStreamBuf(PHYSFS_file *fileHandle)
+		: fileHandle(fileHandle)
+		, in(64 * 1024)
+		, out(64 * 1024)
+	{
+		memset(&stream, 0, sizeof(stream));
+		ok = deflateInit(&stream, Z_BEST_SPEED) == Z_OK;
+		setp(in.data(), in.data() + in.size());
+	}
+
+	~DeflateStreamBuf()
+	{
+		deflateEnd(&stream);
+	}
+
+	/// Writes what is left. Returns false if anything could not be written.
+	bool finish()
+	{
+		return deflateBuffer(Z_FINISH) && ok;
+	}
+
+protected:
+	int_type overflow(int_type c) override
+	{
+		if (!deflateBuffer(Z_NO_FLUSH))
+		{
+			return traits_type::eof();
+		}
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+		{
+			*pptr() = traits_type::to_char_type(c);
+			pbump(1);
+		}
+		return traits_type::not_eof(c);
+	}
+
+private:
+	bool deflateBuffer(int flush)
+	{
+		stream.next_in = reinterpret_cast<Bytef *>(pbase());
+		stream.avail_in = static_cast<uInt>(pptr() - pbase());
+		int ret;
+		do
+		{
+			stream.next_out = out.data();
+			stream.avail_out = static_cast<uInt>(out.size());
+			ret = deflate(&stream, flush);
+			size_t have = out.size() - stream.avail_out;
+			if (ret == Z_STREAM_ERROR || (have > 0 && WZ_PHYSFS_writeBytes(fileHandle, out.data(), static_cast<PHYSFS_uint32>(have)) != static_cast<PHYSFS_sint64>(have)))
+			{
+				ok = false;
+			}
+		} while (ok && (stream.avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END)));
+		setp(in.data(), in.data() + in.size());
+		return ok;
+	}
+
+	PHYSFS_file *fileHandle;
+	z_stream stream;
+	std::vector<char> in;
+	std::vector<Bytef> out;
+	bool ok;
+};
+
+struct DeferredSaveFile
+{
+	std::string fileName;
+	nlohmann::json root;
+	bool binary;
+};
+static bool deferringSaveFiles = false;
+static std::vector<DeferredSaveFile> deferredSaveFiles;
+static wz::thread deferredSaveFileWriter;
+static bool deferredSaveFileWriterRunning = false;
+
+static bool writeJsonFile(const char *fileName, const nlohmann::json &root, bool binary);
+
+void beginDeferredSaveFiles()
+{
+	waitForDeferredSaveFiles();
+	deferringSaveFiles = true;
+}
+
+void endDeferredSaveFiles(const std::function<void (bool written)> &onWritten)
+{
+	deferringSaveFiles = false;
+	if (deferredSaveFiles.empty())
+	{
+		if (onWritten)
+		{
+			onWritten(true);
+		}
+		return;
+	}
+	debug(LOG_SAVE, "Writing %zu files in the background", deferredSaveFiles.size());
+	deferredSaveFileWriter = wz::thread([onWritten](std::vector<DeferredSaveFile> files) {
+		bool written = true;
+		for (auto const &file : files)
+		{
+			written = writeJsonFile(file.fileName.c_str(), file.root, file.binary) && written;
+		}
+		if (onWritten)
+		{
+			wzAsyncExecOnMainThread([onWritten, written] { onWritten(written); });
+		}
+	}, std::move(deferredSaveFiles));
+	deferredSaveFiles.clear();
+	deferredSaveFileWriterRunning = true;
+}
+
+void waitForDeferredSaveFiles()
+{
+	if (deferredSaveFileWriterRunning)
+	{
+		deferredSaveFileWriter.join();
+		deferredSaveFileWriterRunning = false;
+	}
+}
+
+bool saveJsonFile(const char *fileName, nlohmann::json root, bool binary)
+{
+	if (deferringSaveFiles)
+	{
+		deferredSaveFiles.push_back(DeferredSaveFile{fileName, std::move(root), binary});
+		return true;
+	}
+	return writeJsonFile(fileName, root, binary);
+}
+
+static bool writeJsonFile(const char *fileName, const nlohmann::json &root, bool binary)
+{
+	if (!binary)
 	{
-		ASSERT(mObjStack.empty(), "Some json groups have not been closed, stack size %zu.", mObjStack.size());
 		std::ostringstream stream;
-		stream << mRoot.dump(4) << std::endl;
+		stream << root.dump(4) << std::endl;
 		std::string jsonString = stream.str();
 #if SIZE_MAX >= UDWORD_MAX
 		ASSERT(jsonString.size() <= static_cast<size_t>(std::numeric_limits<UDWORD>::max()), "jsonString.size (%zu) exceeds UDWORD::max", jsonString.size());
 #endif
-		saveFile(mFilename.toUtf8().c_str(), jsonString.c_str(), static_cast<UDWORD>(jsonString.size()));
+		return saveFile(fileName, jsonString.c_str(), static_cast<UDWORD>(jsonString.size()));
+	}
+
+	PHYSFS_file *fileHandle = PHYSFS_openWrite(fileName);
+	if (fileHandle == nullptr)
+	{
+		debug(LOG_ERROR, "%s could not be opened: %s", fileName, WZ_PHYSFS_getLastError());
+		return false;
+	}
+	bool ok = WZ_PHYSFS_writeBytes(fileHandle, binaryJsonMagic, sizeof(binaryJsonMagic)) == sizeof(binaryJsonMagic);
+	ok = ok && PHYSFS_writeUBE32(fileHandle, BINARY_JSON_VERSION);
+	if (ok)
+	{
+		DeflateStreamBuf buffer(fileHandle);
+		std::ostream stream(&buffer);
+		nlohmann::json::to_cbor(root, stream);
+		ok = buffer.finish();
+	}
+	if (!PHYSFS_close(fileHandle))
+	{
+		ok = false;
+	}
+	if (!ok)
+	{
+		debug(LOG_ERROR, "%s could not be written: %s", fileName, WZ_PHYSFS_getLastError());
+	}
+	return ok;
+}
+
+nlohmann::json parseJsonFile(const char *data, size_t size)
+{
+	const size_t headerSize = sizeof(binaryJsonMagic) + 4;
+	if (size < headerSize || memcmp(data, binaryJsonMagic, sizeof(binaryJsonMagic)) != 0)
+	{
+		return nlohmann::json::parse(data, data + size);
+	}
+	const unsigned char *version = reinterpret_cast<const unsigned char *>(data) + sizeof(binaryJsonMagic);
+	uint32_t fileVersion = (uint32_t)version[0] << 24 | (uint32_t)version[1] << 16 | (uint32_t)version[2] << 8 | version[3];
+	if (fileVersion != BINARY_JSON_VERSION)
+	{
+		throw std::runtime_error("unsupported binary version " + std::to_string(fileVersion));
+	}
+
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	if (inflateInit(&stream) != Z_OK)
+	{
+		throw std::runtime_error("zlib inflate not working");
+	}
+	std::vector<uint8_t> cbor(std::max<size_t>(size * 4, 64 * 1024));
+	stream.next_in = reinterpret_cast<const Bytef *>(data + headerSize);
+	stream.avail_in = static_cast<uInt>(size - headerSize);
+	int ret;
+	do
+	{
+		if (stream.total_out == cbor.size())
+		{
+			cbor.resize(cbor.size() * 2);
+		}
+		stream.next_out = cbor.data() + stream.total_out;
+		stream.avail_out = static_cast<uInt>(cbor.size() - stream.total_out);
+		ret = inflate(&stream, Z_NO_FLUSH);
+	} while (ret == Z_OK);
+	cbor.resize(stream.total_out);
+	inflateEnd(&stream);
+	if (ret != Z_STREAM_END)
+	{
+		throw std::runtime_error("compressed data is damaged");
+	}
+	return nlohmann::json::from_cbor(cbor);
+}
+
+WzConfig::~WzConfig()
+{
+	if (mWarning == ReadAndWrite)
+	{
+		ASSERT(mObjStack.empty(), "Some json groups have not been closed, stack size %zu.", mObjStack.size());
+		saveJsonFile(mFilename.toUtf8().c_str(), std::move(mRoot), mBinary);
 	}
 	debug(LOG_SAVE, "%s %s", mWarning == ReadAndWrite? "Saving" : "Closing", mFilename.toUtf8().c_str());
 }
@@ -67,12 +286,38 @@ static nlohmann::json jsonMerge(nlohmann::json original, const nlohmann::json& o
 	return original;
 }
 
-WzConfig::WzConfig(const WzString &name, WzConfig::warning warning)
-: mArray(nlohmann::json::array())
+struct WzConfigCachedDocument
+{
+	std::string stamp;
+	nlohmann::json root;
+	std::string compact;  ///< compactStringRepresentation(), once asked for.
+};
+
+static std::unordered_map<std::string, std::shared_ptr<WzConfigCachedDocument>> cachedDocuments;
+
+/// Tells whether any of the files a document is made of changed, or was overridden by another mod or map.
+static std::string documentStamp(const std::string &name)
 {
-	UDWORD size;
-	char *data;
+	std::string stamp;
+	auto addFile = [&stamp](const std::string &fileName) {
+		const char *realDir = PHYSFS_getRealDir(fileName.c_str());
+		stamp += fileName + "|" + (realDir != nullptr ? realDir : "") + "|" + std::to_string(WZ_PHYSFS_getLastModTime(fileName.c_str())) + "\n";
+	};
+	addFile(name);
+	WZ_PHYSFS_enumerateFiles("diffs", [&](const char *i) -> bool {
+		std::string diff = std::string("diffs/") + i + "/" + name;
+		if (PHYSFS_exists(diff.c_str()))
+		{
+			addFile(diff);
+		}
+		return true; // continue
+	});
+	return stamp;
+}
 
+WzConfig::WzConfig(const WzString &name, WzConfig::warning warning, WzConfig::caching caching)
+: mArray(nlohmann::json::array())
+{
 	mFilename = name;
 	mStatus = true;
 	mWarning = warning;
@@ -95,13 +340,29 @@ WzConfig::WzConfig(const WzString &name, WzConfig::warning warning)
 			return;
 		}
 	}
-	if (!loadFile(name.toUtf8().c_str(), &data, &size))
+	std::string stamp;
+	if (caching == Cached)
+	{
+		ASSERT(warning != ReadAndWrite, "Only read only files can be cached: %s", name.toUtf8().c_str());
+		stamp = documentStamp(name.toUtf8());
+		auto it = cachedDocuments.find(name.toUtf8());
+		if (it != cachedDocuments.end() && it->second->stamp == stamp)
+		{
+			mCachedDocument = it->second;
+			mRoot = mCachedDocument->root;
+			pCurrentObj = &mRoot;
+			debug(LOG_SAVE, "Opening %s, cached", name.toUtf8().c_str());
+			return;
+		}
+	}
+	WzFileView file;
+	if (!file.open(name.toUtf8().c_str()))
 	{
 		debug(LOG_FATAL, "Could not open \"%s\"", name.toUtf8().c_str());
 	}
 
 	try {
-		mRoot = nlohmann::json::parse(data, data + size);
+		mRoot = parseJsonFile(file.data(), file.size());
 	}
 	catch (const std::exception &e) {
 		ASSERT(false, "JSON document from %s is invalid: %s", name.toUtf8().c_str(), e.what());
@@ -111,23 +372,22 @@ WzConfig::WzConfig(const WzString &name, WzConfig::warning warning)
 	}
 	pCurrentObj = &mRoot;
 	ASSERT(!mRoot.is_null(), "JSON document from %s is null", name.toUtf8().c_str());
-	ASSERT(mRoot.is_object(), "JSON document from %s is not an object. Read: \n%s", name.toUtf8().c_str(), data);
-	free(data);
+	ASSERT(mRoot.is_object(), "JSON document from %s is not an object", name.toUtf8().c_str());
+	file.close();
 	WZ_PHYSFS_enumerateFiles("diffs", [&](const char *i) -> bool {
 		std::string str(std::string("diffs/") + i + std::string("/") + name.toUtf8().c_str());
 		if (!PHYSFS_exists(str.c_str()))
 		{
 			return true; // continue;
 		}
-		UDWORD size = 0;
-		char *data = nullptr;
-		if (!loadFile(str.c_str(), &data, &size))
+		WzFileView diffFile;
+		if (!diffFile.open(str.c_str()))
 		{
 			debug(LOG_FATAL, "jsondiff file \"%s\" could not be opened!", name.toUtf8().c_str());
 		}
 		nlohmann::json tmpJson;
 		try {
-			tmpJson = nlohmann::json::parse(data, data + size);
+			tmpJson = nlohmann::json::parse(diffFile.data(), diffFile.data() + diffFile.size());
 		}
 		catch (const std::exception &e) {
 			ASSERT(false, "JSON diff from %s is invalid: %s", name.toUtf8().c_str(), e.what());
@@ -136,14 +396,20 @@ WzConfig::WzConfig(const WzString &name, WzConfig::warning warning)
 			debug(LOG_FATAL, "Unexpected exception parsing JSON diff from %s", name.toUtf8().c_str());
 		}
 		ASSERT(!tmpJson.is_null(), "JSON diff from %s is null", name.toUtf8().c_str());
-		ASSERT(tmpJson.is_object(), "JSON diff from %s is not an object. Read: \n%s", name.toUtf8().c_str(), data);
+		ASSERT(tmpJson.is_object(), "JSON diff from %s is not an object", name.toUtf8().c_str());
 		mRoot = jsonMerge(mRoot, tmpJson);
-		free(data);
 		debug(LOG_INFO, "jsondiff \"%s\" loaded and merged", str.c_str());
 		return true; // continue
 	});
 	debug(LOG_SAVE, "Opening %s", name.toUtf8().c_str());
 	pCurrentObj = &mRoot;
+	if (caching == Cached)
+	{
+		mCachedDocument = std::make_shared<WzConfigCachedDocument>();
+		mCachedDocument->stamp = std::move(stamp);
+		mCachedDocument->root = mRoot;
+		cachedDocuments[name.toUtf8()] = mCachedDocument;
+	}
 }
 
 bool WzConfig::isAtDocumentRoot() const
@@ -154,6 +420,14 @@ bool WzConfig::isAtDocumentRoot() const
 std::string WzConfig::compactStringRepresentation(const bool ensure_ascii) const
 {
 	// Use the most compact representation of the JSON
+	if (mCachedDocument != nullptr && !ensure_ascii)
+	{
+		if (mCachedDocument->compact.empty())
+		{
+			mCachedDocument->compact = mCachedDocument->root.dump(-1, ' ', false);
+		}
+		return mCachedDocument->compact;
+	}
 	return mRoot.dump(-1, ' ', ensure_ascii);
 }
 
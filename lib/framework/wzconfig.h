@@ -58,6 +58,8 @@ using json = nlohmann::json;
 #include <stdbool.h>
 #include <vector>
 #include <list>
+#include <memory>
+#include <functional>
 
 class json_variant {
 	// Wraps a json object and provides conversion methods that conform to older (QVariant) syntax and behavior
@@ -92,10 +94,15 @@ private:
 	nlohmann::json mObj;
 };
 
+struct WzConfigCachedDocument;
+
 class WzConfig
 {
 public:
 	enum warning { ReadAndWrite, ReadOnly, ReadOnlyAndRequired };
+	/// Cached keeps the parsed document (with its jsondiffs merged) in memory, and reuses it for as long as none of the
+	/// files it was made of changes. For game data which is loaded again on every game start, such as the stats.
+	enum caching { NotCached, Cached };
 
 private:
 	nlohmann::json mRoot = nlohmann::json::object();
@@ -108,9 +115,11 @@ private:
 	WzString mFilename;
 	bool mStatus;
 	warning mWarning;
+	bool mBinary = false;
+	std::shared_ptr<WzConfigCachedDocument> mCachedDocument;
 
 public:
-	WzConfig(const WzString &name, WzConfig::warning warning);
+	WzConfig(const WzString &name, WzConfig::warning warning, WzConfig::caching caching = NotCached);
 	~WzConfig();
 
 	Vector3f vector3f(const WzString &name);
@@ -149,6 +158,12 @@ public:
 		return mWarning == ReadAndWrite && mStatus;
 	}
 
+	/// Write the file in the binary format of saveJsonFile(), instead of as JSON.
+	void setBinary(bool binary)
+	{
+		mBinary = binary;
+	}
+
 	void setValue(const WzString &key, const nlohmann::json &value);
 	void set(const WzString &key, const nlohmann::json &value);
 
@@ -165,6 +180,20 @@ public:
 	std::string compactStringRepresentation(const bool ensure_ascii = false) const;
 };
 
+/// Writes a JSON document, either as indented JSON, or in a compact binary format (a "WZBJ" header and format version,
+/// followed by zlib compressed CBOR), which is much quicker to write and read. The binary data is compressed as it is
+/// encoded, straight into the file.
+bool saveJsonFile(const char *fileName, nlohmann::json root, bool binary);
+/// Until endDeferredSaveFiles(), saveJsonFile() (and so WzConfig) only keeps the documents, which endDeferredSaveFiles() then
+/// writes in a worker thread. Waits for the files of the last call to be written first. Once they are written, onWritten
+/// (if any) is called on the main thread, with whether all of them could be written.
+void beginDeferredSaveFiles();
+void endDeferredSaveFiles(const std::function<void (bool written)> &onWritten = nullptr);
+/// Waits until the files of the last endDeferredSaveFiles() are written. Call before reading or deleting save files.
+void waitForDeferredSaveFiles();
+/// Parses a document written by saveJsonFile(), in either format. Throws on errors, like nlohmann::json::parse().
+nlohmann::json parseJsonFile(const char *data, size_t size);
+
 // Enable JSON support for custom types
 
 // WzString
@@ -63,6 +63,18 @@ static uint16_t discreteChosenLatency = GAME_TICKS_PER_UPDATE;
 static uint16_t wantedLatency = GAME_TICKS_PER_UPDATE;
 static uint16_t wantedLatencies[MAX_PLAYERS];
 
+#define STATE_HASH_HISTORY 12  // Same as MAX_SYNC_HISTORY in lib/netplay/netplay.cpp, enough for the maximum latency.
+
+struct StateHashEntry
+{
+	uint32_t time;
+	GameStateHashes hashes;
+};
+static GameStateHashes currentStateHashes;                   ///< Hashes to send with the next GAME_GAME_TIME.
+static StateHashEntry stateHashHistory[STATE_HASH_HISTORY];  ///< Our own hashes, as sent with recent GAME_GAME_TIME messages.
+static unsigned stateHashNext = 0;
+static bool stateHashMismatchLogged[MAX_PLAYERS];             ///< Only log the first mismatch for each player, later ones are just fallout.
+
 static void updateLatency(void);
 
 static std::string listToString(char const *format, char const *separator, uint32_t const *begin, uint32_t const *end)
@@ -109,8 +121,17 @@ void gameTimeInit(void)
 	for (player = 0; player != MAX_PLAYERS; ++player)
 	{
 		wantedLatencies[player] = 0;
+		stateHashMismatchLogged[player] = false;
 	}
 
+	currentStateHashes.fill(0);
+	for (StateHashEntry &entry : stateHashHistory)
+	{
+		entry.time = 0;
+		entry.hashes.fill(0);
+	}
+	stateHashNext = 0;
+
 	// Don't let syncDebug from previous games cause a desynch dump at gameTime 102.
 	resetSyncDebug();
 }
@@ -354,6 +375,37 @@ static void updateLatency()
 	updateWantedTime = 0;
 }
 
+void setGameStateHashes(GameStateHashes const &hashes)
+{
+	currentStateHashes = hashes;
+}
+
+const char *gameStateHashName(unsigned type)
+{
+	static const char *names[GAME_STATE_HASH_COUNT] = {"positions", "body points", "orders", "power", "research"};
+	return type < GAME_STATE_HASH_COUNT ? names[type] : "unknown";
+}
+
+/// Returns the first part of the game state where hashes differ from ours at checkTime, or GAME_STATE_HASH_COUNT if none do, or we don't have our hashes from then.
+static unsigned firstGameStateMismatch(uint32_t checkTime, GameStateHashes const &hashes)
+{
+	for (StateHashEntry const &entry : stateHashHistory)
+	{
+		if (entry.time == checkTime)
+		{
+			for (unsigned type = 0; type < GAME_STATE_HASH_COUNT; ++type)
+			{
+				if (entry.hashes[type] != hashes[type])
+				{
+					return type;
+				}
+			}
+			break;
+		}
+	}
+	return GAME_STATE_HASH_COUNT;
+}
+
 void sendPlayerGameTime()
 {
 	unsigned player;
@@ -361,6 +413,10 @@ void sendPlayerGameTime()
 	uint32_t checkTime = gameTime;
 	GameCrcType checkCrc = nextDebugSync();
 
+	stateHashHistory[stateHashNext].time = checkTime;
+	stateHashHistory[stateHashNext].hashes = currentStateHashes;
+	stateHashNext = (stateHashNext + 1) % STATE_HASH_HISTORY;
+
 	for (player = 0; player < game.maxPlayers; ++player)
 	{
 		if (!myResponsibility(player))
@@ -373,6 +429,10 @@ void sendPlayerGameTime()
 		NETuint32_t(&checkTime);
 		NETuint16_t(&checkCrc);
 		NETuint16_t(&wantedLatency);
+		for (uint16_t &hash : currentStateHashes)
+		{
+			NETuint16_t(&hash);
+		}
 		NETend();
 	}
 }
@@ -382,12 +442,17 @@ void recvPlayerGameTime(NETQUEUE queue)
 	uint32_t latencyTicks = 0;
 	uint32_t checkTime = 0;
 	GameCrcType checkCrc = 0;
+	GameStateHashes stateHashes;
 
 	NETbeginDecode(queue, GAME_GAME_TIME);
 	NETuint32_t(&latencyTicks);
 	NETuint32_t(&checkTime);
 	NETuint16_t(&checkCrc);
 	NETuint16_t(&wantedLatencies[queue.index]);
+	for (uint16_t &hash : stateHashes)
+	{
+		NETuint16_t(&hash);
+	}
 	NETend();
 
 	syncDebug("GAME_GAME_TIME p%d;lat%u,ct%u,crc%04X,wlat%u", queue.index, latencyTicks, checkTime, checkCrc, wantedLatencies[queue.index]);
@@ -396,7 +461,13 @@ void recvPlayerGameTime(NETQUEUE queue)
 
 	gameQueueCheckTime[queue.index] = checkTime;
 	gameQueueCheckCrc[queue.index] = checkCrc;
-	if (!checkDebugSync(checkTime, checkCrc))
+	unsigned mismatch = firstGameStateMismatch(checkTime, stateHashes);
+	if (mismatch != GAME_STATE_HASH_COUNT && !stateHashMismatchLogged[queue.index])
+	{
+		debug(LOG_ERROR, "Synch error, player %u's %s hash differs from ours at gameTime %u.", queue.index, gameStateHashName(mismatch), checkTime);
+		stateHashMismatchLogged[queue.index] = true;
+	}
+	if (!checkDebugSync(checkTime, checkCrc) || mismatch != GAME_STATE_HASH_COUNT)
 	{
 		crcError = true;
 		if (NetPlay.players[queue.index].allocated)
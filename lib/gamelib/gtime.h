@@ -27,6 +27,8 @@
 #include "lib/framework/vector.h"
 #include "lib/framework/rational.h"
 
+#include <array>
+
 
 struct NETQUEUE;
 
@@ -189,6 +191,20 @@ static inline Vector3i gameTimeAdjustedAverage(Vector3i numerator, int denominat
 	return quantiseFraction(numerator, GAME_TICKS_PER_SEC * denominator, gameTime + deltaGameTime, gameTime);
 }
 
+/// Parts of the game state which are hashed separately and sent with GAME_GAME_TIME, so that a desynch can be traced to the first part that differs.
+enum GameStateHashType
+{
+	GAME_STATE_POSITION,      ///< Object positions and rotations.
+	GAME_STATE_BODY,          ///< Object body points and structure build points.
+	GAME_STATE_ORDER,         ///< Droid orders, actions and secondary orders.
+	GAME_STATE_POWER,         ///< Player power.
+	GAME_STATE_RESEARCH,      ///< Player research status and research facility subjects.
+	GAME_STATE_HASH_COUNT
+};
+typedef std::array<uint16_t, GAME_STATE_HASH_COUNT> GameStateHashes;
+
+void setGameStateHashes(GameStateHashes const &hashes);   ///< Sets the game state hashes sent with the next GAME_GAME_TIME message.
+const char *gameStateHashName(unsigned type);             ///< Returns the name of a GameStateHashType, for logging.
 void sendPlayerGameTime();                                ///< Sends a GAME_GAME_TIME message with gameTime plus latency to our game queues.
 void recvPlayerGameTime(NETQUEUE queue);                  ///< Processes a GAME_GAME_TIME message.
 bool checkPlayerGameTime(unsigned player);                ///< Checks that we are not waiting for a GAME_GAME_TIME message from this player. (player can be NET_ALL_PLAYERS.)
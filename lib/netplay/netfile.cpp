@@ -0,0 +1,71 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file netfile.cpp
+ *
+ * Where file transfers start, and the partial files which let interrupted downloads resume.
+ * Only needs PhysFS, so that it can be tested without a connection.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/framework/physfs_ext.h"
+
+#include "netplay.h"
+
+#include <algorithm>
+
+std::string NETpartialFilename(std::string const &filename)
+{
+	return filename + ".part";
+}
+
+PHYSFS_file *NETopenPartialFile(std::string const &filename, bool resume, uint32_t *resumePos)
+{
+	std::string partialFilename = NETpartialFilename(filename);
+	PHYSFS_file *fileHandle = nullptr;
+	*resumePos = 0;
+	if (resume && PHYSFS_exists(partialFilename.c_str()) && (fileHandle = PHYSFS_openRead(partialFilename.c_str())) != nullptr)
+	{
+		PHYSFS_sint64 partialSize = PHYSFS_fileLength(fileHandle);
+		PHYSFS_close(fileHandle);
+		*resumePos = static_cast<uint32_t>(std::max<PHYSFS_sint64>(std::min<PHYSFS_sint64>(partialSize, MAX_NET_TRANSFERRABLE_FILE_SIZE), 0));
+		fileHandle = *resumePos > 0 ? PHYSFS_openAppend(partialFilename.c_str()) : nullptr;
+	}
+	if (fileHandle == nullptr)
+	{
+		*resumePos = 0;
+		fileHandle = PHYSFS_openWrite(partialFilename.c_str());
+	}
+	if (fileHandle == nullptr)
+	{
+		debug(LOG_ERROR, "Failed to open %s for writing: %s", partialFilename.c_str(), WZ_PHYSFS_getLastError());
+	}
+	return fileHandle;
+}
+
+uint32_t NETseekFileStart(PHYSFS_file *fileHandle, uint32_t fileSize, uint32_t resumePos)
+{
+	if (resumePos > fileSize || !PHYSFS_seek(fileHandle, resumePos))
+	{
+		debug(LOG_INFO, "Can't resume at %u of %u bytes, sending the whole file.", resumePos, fileSize);
+		PHYSFS_seek(fileHandle, 0);
+		return 0;
+	}
+	return resumePos;
+}
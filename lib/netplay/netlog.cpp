@@ -22,6 +22,8 @@
 #include "lib/framework/frame.h"
 
 #include <time.h>
+#include <chrono>
+#include <algorithm>
 #include <physfs.h>
 #include "lib/framework/physfs_ext.h"
 #include "lib/framework/wztime.h"
@@ -36,28 +38,82 @@
 #define NUM_GAME_PACKETS 256
 
 static PHYSFS_file	*pFileHandle = nullptr;
-static uint32_t		packetcount[2][NUM_GAME_PACKETS];
-static uint32_t		packetsize[2][NUM_GAME_PACKETS];
+static NETMESSAGESTATS	messageStats[NUM_GAME_PACKETS];
+static char		statsFilename[256] = {'\0'};
+
+NetTimingHistogram::NetTimingHistogram()
+{
+	reset();
+}
+
+void NetTimingHistogram::reset()
+{
+	std::fill(buckets, buckets + NUM_BUCKETS, 0);
+	numValues = 0;
+	totalValue = 0;
+	maxValue = 0;
+}
+
+void NetTimingHistogram::add(uint32_t micros)
+{
+	unsigned bucket = 0;
+	for (uint32_t v = micros; v != 0; v >>= 1)
+	{
+		++bucket;
+	}
+	++buckets[bucket];
+	++numValues;
+	totalValue += micros;
+	maxValue = std::max(maxValue, micros);
+}
+
+uint32_t NetTimingHistogram::percentile(unsigned pct) const
+{
+	if (numValues == 0)
+	{
+		return 0;
+	}
+	uint64_t wanted = (numValues * std::min(pct, 100u) + 99) / 100;
+	uint64_t seen = 0;
+	for (unsigned bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+	{
+		seen += buckets[bucket];
+		if (seen >= std::max<uint64_t>(wanted, 1))
+		{
+			uint32_t upperBound = bucket == 0 ? 0 : bucket >= 32 ? UINT32_MAX : (1u << bucket) - 1;
+			return std::min(upperBound, maxValue);
+		}
+	}
+	return maxValue;
+}
+
+uint32_t NETlogMicrosSince(uint64_t startMicros)
+{
+	uint64_t elapsed = NETlogMicros() - startMicros;
+	return static_cast<uint32_t>(std::min<uint64_t>(elapsed, UINT32_MAX));
+}
+
+void NETresetMessageStats()
+{
+	for (unsigned i = 0; i < NUM_GAME_PACKETS; i++)
+	{
+		messageStats[i] = NETMESSAGESTATS();
+	}
+}
 
 bool NETstartLogging(void)
 {
 	time_t aclock;
 	char buf[256];
 	static char filename[256] = {'\0'};
-	int i;
 
-	for (i = 0; i < NUM_GAME_PACKETS; i++)
-	{
-		packetcount[0][i] = 0;
-		packetsize[0][i] = 0;
-		packetcount[1][i] = 0;
-		packetsize[1][i] = 0;
-	}
+	NETresetMessageStats();
 
 	time(&aclock);                   /* Get time in seconds */
 	auto newtime = getLocalTime(aclock);    /* Convert time to struct */
 
 	snprintf(filename, sizeof(filename), "logs/netplay-%04d%02d%02d_%02d%02d%02d.log", newtime.tm_year + 1900, newtime.tm_mon + 1, newtime.tm_mday, newtime.tm_hour, newtime.tm_min, newtime.tm_sec);
+	snprintf(statsFilename, sizeof(statsFilename), "logs/netstats-%04d%02d%02d_%02d%02d%02d.log", newtime.tm_year + 1900, newtime.tm_mon + 1, newtime.tm_mday, newtime.tm_hour, newtime.tm_min, newtime.tm_sec);
 	pFileHandle = PHYSFS_openWrite(filename);   // open the file
 	if (!pFileHandle)
 	{
@@ -75,7 +131,8 @@ bool NETstopLogging(void)
 	static const char dash_line[] = "-----------------------------------------------------------\n";
 	char buf[256];
 	int i;
-	UDWORD totalBytessent = 0, totalBytesrecv = 0, totalPacketsent = 0, totalPacketrecv = 0;
+	uint64_t totalBytessent = 0, totalBytesrecv = 0;
+	UDWORD totalPacketsent = 0, totalPacketrecv = 0;
 
 	if (!pFileHandle)
 	{
@@ -91,16 +148,16 @@ bool NETstopLogging(void)
 		}
 		else
 		{
-			snprintf(buf, sizeof(buf), "%-24s:\t received %u times, %u bytes; sent %u times, %u bytes\n", messageTypeToString(i),
-			         packetcount[1][i], packetsize[1][i], packetcount[0][i], packetsize[0][i]);
+			snprintf(buf, sizeof(buf), "%-24s:\t received %u times, %llu bytes; sent %u times, %llu bytes\n", messageTypeToString(i),
+			         messageStats[i].count[1], (unsigned long long)messageStats[i].bytes[1], messageStats[i].count[0], (unsigned long long)messageStats[i].bytes[0]);
 		}
 		WZ_PHYSFS_writeBytes(pFileHandle, buf, static_cast<PHYSFS_uint32>(strlen(buf)));
-		totalBytessent += packetsize[0][i];
-		totalBytesrecv += packetsize[1][i];
-		totalPacketsent += packetcount[0][i];
-		totalPacketrecv += packetcount[1][i];
+		totalBytessent += messageStats[i].bytes[0];
+		totalBytesrecv += messageStats[i].bytes[1];
+		totalPacketsent += messageStats[i].count[0];
+		totalPacketrecv += messageStats[i].count[1];
 	}
-	snprintf(buf, sizeof(buf), "== Total bytes sent %u, Total bytes received %u ==\n", totalBytessent, totalBytesrecv);
+	snprintf(buf, sizeof(buf), "== Total bytes sent %llu, Total bytes received %llu ==\n", (unsigned long long)totalBytessent, (unsigned long long)totalBytesrecv);
 	WZ_PHYSFS_writeBytes(pFileHandle, buf, static_cast<PHYSFS_uint32>(strlen(buf)));
 	snprintf(buf, sizeof(buf), "== Total packets sent %u, recv %u ==\n", totalPacketsent, totalPacketrecv);
 	WZ_PHYSFS_writeBytes(pFileHandle, buf, static_cast<PHYSFS_uint32>(strlen(buf)));
@@ -135,7 +192,7 @@ bool NETstopLogging(void)
 	}
 	pFileHandle = nullptr;
 
-	return true;
+	return NETwriteMessageStats(statsFilename);
 }
 
 /** log packet
@@ -146,8 +203,118 @@ bool NETstopLogging(void)
 void NETlogPacket(uint8_t type, uint32_t size, bool received)
 {
 	STATIC_ASSERT((1 << (8 * sizeof(type))) == NUM_GAME_PACKETS); // NUM_GAME_PACKETS must be larger than maximum possible type.
-	packetcount[received][type]++;
-	packetsize[received][type] += size;
+	messageStats[type].count[received]++;
+	messageStats[type].bytes[received] += size;
+}
+
+/** log a message written to a socket
+ *  \param type, uint8_t, the packet's type.
+ *  \param size, uint32_t, the number of bytes written, before compression.
+*/
+void NETlogPacketWire(uint8_t type, uint32_t size)
+{
+	messageStats[type].wireCount++;
+	messageStats[type].wireBytes += size;
+}
+
+void NETlogMessageTime(uint8_t type, NetMessageTiming timing, uint32_t micros)
+{
+	switch (timing)
+	{
+	case NetTimingEncode: messageStats[type].encodeTime.add(micros); break;
+	case NetTimingDecode: messageStats[type].decodeTime.add(micros); break;
+	case NetTimingQueue:  messageStats[type].queueTime.add(micros);  break;
+	}
+}
+
+const NETMESSAGESTATS &NETgetMessageStats(uint8_t type)
+{
+	return messageStats[type];
+}
+
+/// GAME_ messages only reach the sockets wrapped in NET_SHARE_GAME_QUEUE, so rank them by the bytes they were sent with instead.
+static uint64_t messageWeight(unsigned type)
+{
+	return type > GAME_MIN_TYPE && type < GAME_MAX_TYPE ? messageStats[type].bytes[0] : messageStats[type].wireBytes;
+}
+
+std::vector<uint8_t> NETgetTopMessageTypes(size_t count)
+{
+	std::vector<uint8_t> types;
+	for (unsigned i = 0; i < NUM_GAME_PACKETS; i++)
+	{
+		if (messageStats[i].count[0] != 0 || messageStats[i].count[1] != 0 || messageStats[i].wireCount != 0)
+		{
+			types.push_back(i);
+		}
+	}
+	std::stable_sort(types.begin(), types.end(), [](uint8_t a, uint8_t b) {
+		return messageWeight(a) > messageWeight(b);
+	});
+	if (types.size() > count)
+	{
+		types.resize(count);
+	}
+	return types;
+}
+
+static void writeHistogram(PHYSFS_file *fileHandle, const char *name, const NetTimingHistogram &histogram)
+{
+	char buf[256];
+	if (histogram.count() == 0)
+	{
+		return;
+	}
+	snprintf(buf, sizeof(buf), "\t%-8s us: n %llu, mean %llu, p50 %u, p90 %u, p99 %u, max %u\n", name,
+	         (unsigned long long)histogram.count(), (unsigned long long)(histogram.total() / histogram.count()),
+	         histogram.percentile(50), histogram.percentile(90), histogram.percentile(99), histogram.max());
+	WZ_PHYSFS_writeBytes(fileHandle, buf, static_cast<PHYSFS_uint32>(strlen(buf)));
+}
+
+/** Writes per-message-type statistics, most expensive message types first.
+ *  Socket compression works on the whole stream, so compressed sizes are estimated from the overall compression ratio.
+ *  GAME_ messages only reach the sockets inside NET_SHARE_GAME_QUEUE, so their socket bytes are estimated from its fan-out.
+ */
+bool NETwriteMessageStats(const char *filename)
+{
+	char buf[256];
+	PHYSFS_file *fileHandle = PHYSFS_openWrite(filename);
+	if (!fileHandle)
+	{
+		debug(LOG_ERROR, "Could not create net statistics %s: %s", filename, WZ_PHYSFS_getLastError());
+		return false;
+	}
+
+	size_t rawSent = NETgetStatistic(NetStatisticRawBytes, true, true);
+	size_t uncompressedSent = NETgetStatistic(NetStatisticUncompressedBytes, true, true);
+	double compressionRatio = uncompressedSent != 0 ? (double)rawSent / uncompressedSent : 1.;
+	const NETMESSAGESTATS &shareStats = messageStats[NET_SHARE_GAME_QUEUE];
+	double gameFanOut = shareStats.bytes[0] != 0 ? (double)shareStats.wireBytes / shareStats.bytes[0] : 0.;
+
+	snprintf(buf, sizeof(buf), "== Compression ratio %.3f, game message fan-out %.2f ==\n", compressionRatio, gameFanOut);
+	WZ_PHYSFS_writeBytes(fileHandle, buf, static_cast<PHYSFS_uint32>(strlen(buf)));
+	snprintf(buf, sizeof(buf), "%-24s %10s %12s %10s %12s %13s %13s\n", "type", "sent", "sent bytes", "recv", "recv bytes", "wire bytes", "compressed");
+	WZ_PHYSFS_writeBytes(fileHandle, buf, static_cast<PHYSFS_uint32>(strlen(buf)));
+	for (uint8_t type : NETgetTopMessageTypes(NUM_GAME_PACKETS))
+	{
+		const NETMESSAGESTATS &stats = messageStats[type];
+		bool isGameMessage = type > GAME_MIN_TYPE && type < GAME_MAX_TYPE;
+		double wireBytes = isGameMessage ? stats.bytes[0] * gameFanOut : (double)stats.wireBytes;
+		snprintf(buf, sizeof(buf), "%-24s %10u %12llu %10u %12llu %12llu%s %12llu~\n", messageTypeToString(type),
+		         stats.count[0], (unsigned long long)stats.bytes[0], stats.count[1], (unsigned long long)stats.bytes[1],
+		         (unsigned long long)wireBytes, isGameMessage ? "~" : " ", (unsigned long long)(wireBytes * compressionRatio));
+		WZ_PHYSFS_writeBytes(fileHandle, buf, static_cast<PHYSFS_uint32>(strlen(buf)));
+		writeHistogram(fileHandle, "encode", stats.encodeTime);
+		writeHistogram(fileHandle, "decode", stats.decodeTime);
+		writeHistogram(fileHandle, "queued", stats.queueTime);
+	}
+
+	if (!PHYSFS_close(fileHandle))
+	{
+		debug(LOG_ERROR, "Could not close net statistics %s: %s", filename, WZ_PHYSFS_getLastError());
+		return false;
+	}
+	return true;
 }
 
 bool NETlogEntry(const char *str, UDWORD a, UDWORD b)
@@ -24,9 +24,60 @@
 
 #include "netplay.h"
 
+#include <vector>
+#include <chrono>
+
+/// Log2-bucketed histogram of durations, in microseconds.
+class NetTimingHistogram
+{
+public:
+	NetTimingHistogram();
+	void add(uint32_t micros);
+	void reset();
+	uint32_t percentile(unsigned pct) const;   ///< Returns an upper bound of the given percentile, in microseconds.
+	uint32_t max() const { return maxValue; }
+	uint64_t count() const { return numValues; }
+	uint64_t total() const { return totalValue; }
+
+private:
+	enum { NUM_BUCKETS = 33 };                 ///< Bucket 0 holds 0, bucket n holds [2^(n-1), 2^n).
+	uint32_t buckets[NUM_BUCKETS];
+	uint64_t numValues;
+	uint64_t totalValue;
+	uint32_t maxValue;
+};
+
+/// Per-message-type telemetry, indexed by message type.
+struct NETMESSAGESTATS
+{
+	uint32_t count[2];                         ///< [received] Number of messages encoded or decoded.
+	uint64_t bytes[2];                         ///< [received] Message payload size, before compression.
+	uint32_t wireCount;                        ///< Number of times the message was written to a socket (a broadcast counts once per client).
+	uint64_t wireBytes;                        ///< Bytes written to sockets, before compression.
+	NetTimingHistogram encodeTime;             ///< Time between NETbeginEncode() and the message being queued.
+	NetTimingHistogram decodeTime;             ///< Time between NETbeginDecode() and NETend().
+	NetTimingHistogram queueTime;              ///< Time the message spent in its queue before being decoded.
+};
+
+enum NetMessageTiming {NetTimingEncode, NetTimingDecode, NetTimingQueue};
+
 bool NETstartLogging();
 bool NETstopLogging();
 WZ_DECL_NONNULL(1) bool NETlogEntry(const char *str, UDWORD a, UDWORD b);
 void NETlogPacket(uint8_t type, uint32_t size, bool received);
+void NETlogPacketWire(uint8_t type, uint32_t size);
+void NETlogMessageTime(uint8_t type, NetMessageTiming timing, uint32_t micros);
+/// Monotonic timestamp, in microseconds. Inline, so that netqueue.cpp does not need to link against the logging code.
+static inline uint64_t NETlogMicros()
+{
+	using microDuration = std::chrono::duration<uint64_t, std::micro>;
+	return std::chrono::duration_cast<microDuration>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+uint32_t NETlogMicrosSince(uint64_t startMicros);
+
+const NETMESSAGESTATS &NETgetMessageStats(uint8_t type);
+std::vector<uint8_t> NETgetTopMessageTypes(size_t count);   ///< Message types sorted by bytes written to sockets (or sent, for GAME_ messages).
+void NETresetMessageStats();
+WZ_DECL_NONNULL(1) bool NETwriteMessageStats(const char *filename);
 
 #endif // _netlog_h
@@ -1435,6 +1435,7 @@ bool NETsend(NETQUEUE queue, NetMessage const *message)
 					nStats.rawBytes.sent          += compressedRawLen;
 					nStats.uncompressedBytes.sent += rawLen;
 					nStats.packets.sent           += 1;
+					NETlogPacketWire(message->type, static_cast<uint32_t>(rawLen));
 				}
 				else if (result == SOCKET_ERROR)
 				{
@@ -1466,6 +1467,7 @@ bool NETsend(NETQUEUE queue, NetMessage const *message)
 				nStats.rawBytes.sent          += compressedRawLen;
 				nStats.uncompressedBytes.sent += rawLen;
 				nStats.packets.sent           += 1;
+				NETlogPacketWire(message->type, static_cast<uint32_t>(rawLen));
 			}
 			else if (result == SOCKET_ERROR)
 			{
@@ -1591,6 +1593,7 @@ static bool NETprocessSystemMessage(NETQUEUE playerQueue, uint8_t type)
 				      || message->type == NET_COLOURREQUEST
 				      || message->type == NET_POSITIONREQUEST
 				      || message->type == NET_FILE_CANCELLED
+				      || message->type == NET_FILE_ACK
 				      || message->type == NET_JOIN
 				      || message->type == NET_PLAYER_INFO) && receiver != NET_HOST_ONLY))
 				{
@@ -2038,48 +2041,99 @@ bool NETrecvGame(NETQUEUE *queue, uint8_t *type)
 
 // ////////////////////////////////////////////////////////////////////////
 // File Transfer programs.
-/** Send file. It returns % of file sent when 100 it's complete. Call until it returns 100.
-*  @TODO: more error checking (?) different file types (?)
-*          Maybe should close file handle, and seek each time?
+/** Send a file chunk, if fewer than FILE_TRANSFER_WINDOW_CHUNKS chunks are waiting to be acknowledged by the receiver.
+*  Call until it returns false, and then again next frame, until NETfileSent() returns true.
 *
-*  @NOTE: MAX_FILE_TRANSFER_PACKET is set to 2k per packet since 7*2 = 14K which is pretty
-*         much our limit.  Don't screw with that without having a bigger buffer!
-*         NET_BUFFER_SIZE is at 16k.  (also remember text chat, plus all the other cruff)
+*  The chunk size starts small, and grows while acknowledgements come back quickly, see NETrecvFileAck().
 */
-#define MAX_FILE_TRANSFER_PACKET 2048
-int NETsendFile(WZFile &file, unsigned player)
+#define FILE_TRANSFER_FAST_ACK 250   // Milliseconds. Grow the chunk size if a chunk is acknowledged faster than this,
+#define FILE_TRANSFER_SLOW_ACK 1000  // and shrink it if slower than this.
+bool NETsendFile(WZFile &file, unsigned player)
 {
-	ASSERT_OR_RETURN(100, NetPlay.isHost, "Trying to send a file and we are not the host!");
+	ASSERT_OR_RETURN(false, NetPlay.isHost, "Trying to send a file and we are not the host!");
 
-	uint8_t inBuff[MAX_FILE_TRANSFER_PACKET];
-	memset(inBuff, 0x0, sizeof(inBuff));
+	if (file.handle == nullptr || file.pos - file.ackedPos >= file.chunkSize * FILE_TRANSFER_WINDOW_CHUNKS)
+	{
+		return false;  // Already sent everything, or need to wait for the receiver to catch up.
+	}
+
+	std::vector<uint8_t> inBuff(std::min(file.chunkSize, file.size - file.pos));
 
 	// read some bytes.
-	uint32_t bytesToRead = WZ_PHYSFS_readBytes(file.handle, inBuff, MAX_FILE_TRANSFER_PACKET);
-	ASSERT_OR_RETURN(100, (int32_t)bytesToRead >= 0, "Error reading file.");
+	uint32_t bytesToRead = WZ_PHYSFS_readBytes(file.handle, inBuff.data(), static_cast<PHYSFS_uint32>(inBuff.size()));
+	ASSERT_OR_RETURN(false, (int32_t)bytesToRead >= 0, "Error reading file.");
 
 	NETbeginEncode(NETnetQueue(player), NET_FILE_PAYLOAD);
 	NETbin(file.hash.bytes, file.hash.Bytes);
 	NETuint32_t(&file.size);  // total bytes in this file. (we don't support 64bit yet)
 	NETuint32_t(&file.pos);  // start byte
 	NETuint32_t(&bytesToRead);  // bytes in this packet
-	NETbin(inBuff, bytesToRead);
+	NETbin(inBuff.data(), bytesToRead);
 	NETend();
 
 	file.pos += bytesToRead;  // update position!
-	if (file.pos == file.size)
+	if (file.timedSendTime == 0)
+	{
+		file.timedPos = file.pos;
+		file.timedSendTime = std::max(wzGetTicks(), 1);
+	}
+	if (file.pos == file.size || bytesToRead == 0)
 	{
 		PHYSFS_close(file.handle);
-		file.handle = nullptr;  // We are done sending to this client.
+		file.handle = nullptr;  // We are done reading, but wait for the client to acknowledge everything.
+	}
+
+	return true;
+}
+
+bool NETfileSent(WZFile const &file)
+{
+	return file.handle == nullptr && file.ackedPos >= file.pos;
+}
+
+void NETrecvFileAck(NETQUEUE queue)
+{
+	Sha256 hash;
+	hash.setZero();
+	uint32_t pos = 0;
+
+	NETbeginDecode(queue, NET_FILE_ACK);
+	NETbin(hash.bytes, hash.Bytes);
+	NETuint32_t(&pos);
+	NETend();
+
+	ASSERT_OR_RETURN(, NetPlay.isHost && queue.index < MAX_CONNECTED_PLAYERS, "Unexpected file acknowledgement.");
+
+	auto &files = NetPlay.players[queue.index].wzFiles;
+	auto file = std::find_if(files.begin(), files.end(), [&](WZFile const &file) { return file.hash == hash; });
+	if (file == files.end())
+	{
+		return;  // Cancelled already.
 	}
 
-	return (uint64_t)file.pos * 100 / file.size;
+	file->ackedPos = std::max(file->ackedPos, std::min(pos, file->pos));
+
+	if (file->timedSendTime != 0 && file->ackedPos >= file->timedPos)
+	{
+		uint32_t ackTime = wzGetTicks() - file->timedSendTime;
+		if (ackTime < FILE_TRANSFER_FAST_ACK)
+		{
+			file->chunkSize = std::min<uint32_t>(file->chunkSize * 2, MAX_FILE_TRANSFER_CHUNK);
+		}
+		else if (ackTime > FILE_TRANSFER_SLOW_ACK)
+		{
+			file->chunkSize = std::max<uint32_t>(file->chunkSize / 2, MIN_FILE_TRANSFER_CHUNK);
+		}
+		debug(LOG_NET, "File chunk acknowledged after %u ms, chunk size now %u", ackTime, file->chunkSize);
+		file->timedSendTime = 0;
+	}
 }
 
 bool validateReceivedFile(const WZFile& file)
 {
-	PHYSFS_file *fileHandle = PHYSFS_openRead(file.filename.c_str());
-	ASSERT_OR_RETURN(false, fileHandle != nullptr, "Could not open downloaded file %s for reading: %s", file.filename.c_str(), WZ_PHYSFS_getLastError());
+	std::string partialFilename = NETpartialFilename(file.filename);
+	PHYSFS_file *fileHandle = PHYSFS_openRead(partialFilename.c_str());
+	ASSERT_OR_RETURN(false, fileHandle != nullptr, "Could not open downloaded file %s for reading: %s", partialFilename.c_str(), WZ_PHYSFS_getLastError());
 
 	PHYSFS_sint64 actualFileSize64 = PHYSFS_fileLength(fileHandle);
 	if (actualFileSize64 < 0)
@@ -2199,6 +2253,26 @@ bool markAsDownloadedFile(const std::string &filename)
 	return false;
 }
 
+/// Moves a completely downloaded and validated file from NETpartialFilename(filename) to filename.
+static bool finishDownloadedFile(const std::string &filename)
+{
+	const char * current_writeDir = PHYSFS_getWriteDir();
+	ASSERT_OR_RETURN(false, current_writeDir != nullptr, "Failed to get PhysFS writeDir: %s", WZ_PHYSFS_getLastError());
+
+	if (PHYSFS_exists(filename.c_str()))
+	{
+		PHYSFS_delete(filename.c_str());  // Old incomplete or corrupt file, rename() won't replace it on all platforms.
+	}
+	std::string fullFilePath = std::string(current_writeDir) + PHYSFS_getDirSeparator() + filename;
+	std::string fullPartialFilePath = std::string(current_writeDir) + PHYSFS_getDirSeparator() + NETpartialFilename(filename);
+	if (rename(fullPartialFilePath.c_str(), fullFilePath.c_str()) != 0)
+	{
+		debug(LOG_ERROR, "Could not rename downloaded file to %s", fullFilePath.c_str());
+		return false;
+	}
+	return true;
+}
+
 // recv file. it returns % of the file so far recvd.
 int NETrecvFile(NETQUEUE queue)
 {
@@ -2207,8 +2281,7 @@ int NETrecvFile(NETQUEUE queue)
 	uint32_t size = 0;
 	uint32_t pos = 0;
 	uint32_t bytesToRead = 0;
-	uint8_t buf[MAX_FILE_TRANSFER_PACKET];
-	memset(buf, 0x0, sizeof(buf));
+	std::vector<uint8_t> buf;
 
 	//read incoming bytes.
 	NETbeginDecode(queue, NET_FILE_PAYLOAD);
@@ -2216,8 +2289,9 @@ int NETrecvFile(NETQUEUE queue)
 	NETuint32_t(&size);  // total bytes in this file. (we don't support 64bit yet)
 	NETuint32_t(&pos);  // start byte
 	NETuint32_t(&bytesToRead);  // bytes in this packet
-	ASSERT_OR_RETURN(100, bytesToRead <= sizeof(buf), "Bad value.");
-	NETbin(buf, bytesToRead);
+	ASSERT_OR_RETURN(100, bytesToRead <= MAX_FILE_TRANSFER_CHUNK, "Bad value.");
+	buf.resize(bytesToRead);
+	NETbin(buf.data(), bytesToRead);
 	NETend();
 
 	debug(LOG_NET, "New file position is %u", pos);
@@ -2244,17 +2318,20 @@ int NETrecvFile(NETQUEUE queue)
 			debug(LOG_ERROR, "Could not close file handle after trying to terminate download: %s", WZ_PHYSFS_getLastError());
 		}
 		file->handle = nullptr;
+		PHYSFS_delete(NETpartialFilename(file->filename).c_str());  // Don't try to resume from bad data.
 		sendCancelFileDownload(file->hash);
 		NetPlay.wzFiles.erase(file);
 	};
 
 	//sanity checks
+	bool firstChunk = false;
 	if (file->size != size)
 	{
 		if (file->size == 0)
 		{
 			// host does not send the file size until the first recvFile packet
 			file->size = size;
+			firstChunk = true;
 		}
 		else
 		{
@@ -2274,20 +2351,42 @@ int NETrecvFile(NETQUEUE queue)
 		return 100;
 	}
 
-	if (PHYSFS_tell(file->handle) != static_cast<PHYSFS_sint64>(pos))
+	if (firstChunk && pos == 0 && file->pos != 0)
+	{
+		// The host starts the first chunk where it actually sends from, which is the beginning if it couldn't resume where
+		// we asked it to. Start the partial file over, since we opened it for appending.
+		debug(LOG_INFO, "Host can't resume %s at %u, downloading the whole file", file->filename.c_str(), file->pos);
+		PHYSFS_close(file->handle);
+		file->handle = NETopenPartialFile(file->filename, false, &file->pos);
+		if (file->handle == nullptr)
+		{
+			sendCancelFileDownload(file->hash);
+			NetPlay.wzFiles.erase(file);
+			return 100;
+		}
+	}
+
+	if (file->pos != pos || bytesToRead > size - pos)
 	{
 		// actual position in file does not equal the expected position in the file (sent by the host)
-		debug(LOG_ERROR, "Invalid file position in downloaded file; (desired: %" PRIu32")", pos);
+		// (Compare with our own position, since PHYSFS_tell is not meaningful for files opened for appending, when resuming.)
+		debug(LOG_ERROR, "Invalid file position in downloaded file; (desired: %" PRIu32", have: %" PRIu32")", pos, file->pos);
 		terminateFileDownload(file); // 'file' is now an invalidated iterator.
 		return 100;
 	}
 
 	// Write packet to the file.
-	WZ_PHYSFS_writeBytes(file->handle, buf, bytesToRead);
+	WZ_PHYSFS_writeBytes(file->handle, buf.data(), bytesToRead);
 
 	uint32_t newPos = pos + bytesToRead;
 	file->pos = newPos;
 
+	// Let the host send more.
+	NETbeginEncode(NETnetQueue(NET_HOST_ONLY), NET_FILE_ACK);
+	NETbin(hash.bytes, hash.Bytes);
+	NETuint32_t(&newPos);
+	NETend();
+
 	if (newPos >= size)  // last packet
 	{
 		int noError = PHYSFS_close(file->handle);
@@ -2297,12 +2396,12 @@ int NETrecvFile(NETQUEUE queue)
 		}
 		file->handle = nullptr;
 
-		if(!validateReceivedFile(*file))
+		if (!validateReceivedFile(*file))
 		{
 			// Delete the (invalid) downloaded file
-			PHYSFS_delete(file->filename.c_str());
+			PHYSFS_delete(NETpartialFilename(file->filename).c_str());
 		}
-		else
+		else if (finishDownloadedFile(file->filename))
 		{
 			// Attach Quarantine / "downloaded" file attribute to file
 			markAsDownloadedFile(file->filename.c_str());
@@ -2315,7 +2414,7 @@ int NETrecvFile(NETQUEUE queue)
 	//return the percentage count
 	if (size)
 	{
-		return (newPos * 100) / size;
+		return static_cast<int>((uint64_t)newPos * 100 / size);
 	}
 	debug(LOG_ERROR, "Received 0 byte file from host?");
 	return 100;		// file is nullbyte, so we are done.
@@ -2323,14 +2422,16 @@ int NETrecvFile(NETQUEUE queue)
 
 unsigned NETgetDownloadProgress(unsigned player)
 {
-	std::vector<WZFile> const &files = player == selectedPlayer ?
+	bool ownDownload = player == selectedPlayer;
+	std::vector<WZFile> const &files = ownDownload ?
 		NetPlay.wzFiles :  // Check our own download progress.
 		NetPlay.players[player].wzFiles;  // Check their download progress (currently only works if we are the host).
 
 	uint32_t progress = 100;
 	for (WZFile const &file : files)
 	{
-		progress = std::min<uint32_t>(progress, (uint32_t)((uint64_t)file.pos * 100 / (uint64_t)std::max<uint32_t>(file.size, 1)));
+		uint32_t pos = ownDownload ? file.pos : file.ackedPos;
+		progress = std::min<uint32_t>(progress, (uint32_t)((uint64_t)pos * 100 / (uint64_t)std::max<uint32_t>(file.size, 1)));
 	}
 	return static_cast<unsigned>(progress);
 }
@@ -4258,6 +4359,7 @@ const char *messageTypeToString(unsigned messageType_)
 	case NET_DEBUG_SYNC:                return "NET_DEBUG_SYNC";
 	case NET_VOTE:                      return "NET_VOTE";
 	case NET_VOTE_REQUEST:              return "NET_VOTE_REQUEST";
+	case NET_FILE_ACK:                  return "NET_FILE_ACK";
 	case NET_MAX_TYPE:                  return "NET_MAX_TYPE";
 
 	// Game-state-related messages, must be processed by all clients at the same game time.
@@ -93,6 +93,7 @@ enum MESSAGE_TYPES
 	NET_DEBUG_SYNC,                 ///< Synch error messages, so people don't have to use pastebin.
 	NET_VOTE,                       ///< player vote
 	NET_VOTE_REQUEST,               ///< Setup a vote popup
+	NET_FILE_ACK,                   ///< Player has written a file up to the given position
 	NET_MAX_TYPE,                   ///< Maximum+1 valid NET_ type, *MUST* be last.
 
 	// Game-state-related messages, must be processed by all clients at the same game time.
@@ -130,8 +131,9 @@ enum MESSAGE_TYPES
 #define WZ_SERVER_KEEPALIVE  4
 
 // Constants
-// @NOTE / FIXME: We need a way to detect what should happen if the msg buffer exceeds this.
-#define MaxMsgSize		16384		// max size of a message in bytes.
+// Size of the buffers sockets are read into, in bytes. Not a limit on messages, which are length prefixed, and put together
+// again from as many reads as they take by NetQueue.
+#define MaxMsgSize		16384
 #define	StringSize		64			// size of strings used.
 #define MaxGames		11			// max number of concurrently playable games to allow.
 #define extra_string_size	159		// extra 199 char for future use
@@ -145,6 +147,13 @@ enum MESSAGE_TYPES
 
 #define MAX_NET_TRANSFERRABLE_FILE_SIZE	0x8000000
 
+// File transfer chunk sizes adapt between these, depending on how fast the receiver acknowledges them. A NET_FILE_PAYLOAD
+// message is one chunk plus a small header, so it can be bigger than MaxMsgSize, which only sizes the read buffers.
+// MAX_FILE_TRANSFER_CHUNK is the limit NETrecvFile() enforces.
+#define MIN_FILE_TRANSFER_CHUNK		2048
+#define MAX_FILE_TRANSFER_CHUNK		65536
+#define FILE_TRANSFER_WINDOW_CHUNKS	4			// Number of chunks which may be sent before being acknowledged.
+
 struct SESSIONDESC  //Available game storage... JUST FOR REFERENCE!
 {
 	int32_t dwSize;
@@ -208,13 +217,19 @@ struct SYNC_COUNTER
 struct WZFile
 {
 	//WZFile() : handle(nullptr), size(0), pos(0) { hash.setZero(); }
-	WZFile(PHYSFS_file *handle, const std::string &filename, Sha256 hash, uint32_t size = 0) : handle(handle), filename(filename), hash(hash), size(size), pos(0) {}
+	WZFile(PHYSFS_file *handle, const std::string &filename, Sha256 hash, uint32_t size = 0, uint32_t pos = 0) : handle(handle), filename(filename), hash(hash), size(size), pos(pos), ackedPos(pos), chunkSize(MIN_FILE_TRANSFER_CHUNK * 4), timedPos(0), timedSendTime(0) {}
 
 	PHYSFS_file *handle;
-	std::string filename;
+	std::string filename;  // When receiving, the data is written to filename + ".part" until complete, see NETpartialFilename().
 	Sha256 hash;
 	uint32_t size;
 	uint32_t pos;  // Current position, the range [0; currPos[ has been sent or received already.
+
+	// Only used when sending.
+	uint32_t ackedPos;       // The range [0; ackedPos[ has been written by the receiver.
+	uint32_t chunkSize;      // Current chunk size, between MIN_FILE_TRANSFER_CHUNK and MAX_FILE_TRANSFER_CHUNK.
+	uint32_t timedPos;       // End of the chunk being timed, to measure how long acknowledgements take.
+	uint32_t timedSendTime;  // When that chunk was sent (wzGetTicks()), or 0 if not timing any chunk.
 };
 
 enum class AIDifficulty : int8_t
@@ -319,8 +334,16 @@ WZ_DECL_NONNULL(1, 2) bool NETrecvNet(NETQUEUE *queue, uint8_t *type);        //
 WZ_DECL_NONNULL(1, 2) bool NETrecvGame(NETQUEUE *queue, uint8_t *type);       ///< recv a message from the game queues which is sceduled to execute by time, if possible.
 void NETflush();                                                              ///< Flushes any data stuck in compression buffers.
 
-int NETsendFile(WZFile &file, unsigned player);  ///< Send file chunk. Returns 100 when done.
-int NETrecvFile(NETQUEUE queue);                 ///< Receive file chunk. Returns 100 when done.
+bool NETsendFile(WZFile &file, unsigned player);  ///< Send file chunk, if the transfer window isn't full. Returns true if a chunk was sent.
+bool NETfileSent(WZFile const &file);             ///< Returns true when the whole file has been sent and acknowledged.
+int NETrecvFile(NETQUEUE queue);                  ///< Receive file chunk. Returns 100 when done.
+void NETrecvFileAck(NETQUEUE queue);              ///< Receive acknowledgement of file chunks, and adapt the chunk size.
+std::string NETpartialFilename(std::string const &filename);  ///< Where an incomplete download of filename is kept, so that it can be resumed.
+/// Opens the partial file of a download of filename for writing, at its end if resuming and there is one, else empty. Sets
+/// *resumePos to its size, which is where the host should start sending from.
+PHYSFS_file *NETopenPartialFile(std::string const &filename, bool resume, uint32_t *resumePos);
+/// Seeks a file about to be sent to where the receiver asked to resume, or to the beginning if it can't. Returns where it starts.
+uint32_t NETseekFileStart(PHYSFS_file *fileHandle, uint32_t fileSize, uint32_t resumePos);
 unsigned NETgetDownloadProgress(unsigned player);     ///< Returns 100 when done.
 
 int NETclose();					// close current game
@@ -23,6 +23,7 @@
  */
 #include "lib/framework/frame.h"
 #include "netqueue.h"
+#include "netlog.h"
 
 // See comments in netqueue.h.
 
@@ -140,6 +141,7 @@ void NetQueue::writeRawData(const uint8_t *netData, size_t netLen)
 	buffer.insert(buffer.end(), netData, netData + netLen);
 
 	// Extract the messages.
+	uint64_t now = NETlogMicros();
 	while (buffer.size() - used > 1)
 	{
 		uint8_t type = buffer[used];
@@ -161,6 +163,7 @@ void NetQueue::writeRawData(const uint8_t *netData, size_t netLen)
 
 		messages.push_front(NetMessage(type));
 		messages.front().data.assign(buffer.begin() + used + headerLen, buffer.begin() + used + headerLen + len);
+		messages.front().queuedTime = now;
 		used += headerLen + len;
 	}
 
@@ -213,6 +216,7 @@ void NetQueue::popMessageForNet()
 void NetQueue::pushMessage(const NetMessage &message)
 {
 	messages.push_front(message);
+	messages.front().queuedTime = NETlogMicros();
 }
 
 void NetQueue::setWillNeverGetMessages()
@@ -44,11 +44,12 @@
 class NetMessage
 {
 public:
-	NetMessage(uint8_t type_ = 0xFF) : type(type_) {}
+	NetMessage(uint8_t type_ = 0xFF) : type(type_), queuedTime(0) {}
 	uint8_t *rawDataDup() const;  ///< Returns data compatible with NetQueue::writeRawData(). Must be delete[]d.
 	size_t rawLen() const;        ///< Returns the length of the return value of rawDataDup().
 	uint8_t type;
 	std::vector<uint8_t> data;
+	uint64_t queuedTime;          ///< When the message was inserted into a NetQueue, see NETlogMicros(). Not sent over the network.
 };
 
 /// MessageWriter is used for serialising, using the same interface as MessageReader.
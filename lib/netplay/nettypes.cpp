@@ -62,6 +62,7 @@ static MessageReader reader;  ///< Used when deserialising a message.
 static NetMessage message;    ///< A message which is being serialised or deserialised.
 static NETQUEUE queueInfo;    ///< Indicates which queue is currently being (de)serialised.
 static PACKETDIR NetDir;      ///< Indicates whether a message is being serialised (PACKET_ENCODE) or deserialised (PACKET_DECODE), or not doing anything (PACKET_INVALID).
+static uint64_t messageBeginTime;  ///< When the current message started being (de)serialised, for NETlogMessageTime().
 
 static void NETsetPacketDir(PACKETDIR dir)
 {
@@ -457,6 +458,7 @@ void NETbeginEncode(NETQUEUE queue, uint8_t type)
 	queueInfo = queue;
 	message = type;
 	writer = MessageWriter(message);
+	messageBeginTime = NETlogMicros();
 }
 
 void NETbeginDecode(NETQUEUE queue, uint8_t type)
@@ -466,6 +468,11 @@ void NETbeginDecode(NETQUEUE queue, uint8_t type)
 	queueInfo = queue;
 	message = receiveQueue(queueInfo)->getMessage();
 	reader = MessageReader(message);
+	messageBeginTime = NETlogMicros();
+	if (message.queuedTime != 0)
+	{
+		NETlogMessageTime(message.type, NetTimingQueue, static_cast<uint32_t>(std::min<uint64_t>(messageBeginTime - message.queuedTime, UINT32_MAX)));
+	}
 
 	assert(type == message.type);
 }
@@ -483,6 +490,7 @@ bool NETend()
 		}
 		queue->pushMessage(message);
 		NETlogPacket(message.type, static_cast<uint32_t>(message.data.size()), false);
+		NETlogMessageTime(message.type, NetTimingEncode, NETlogMicrosSince(messageBeginTime));
 
 		if (queueInfo.queueType == QUEUE_GAME || queueInfo.queueType == QUEUE_GAME_FORCED)
 		{
@@ -542,6 +550,7 @@ bool NETend()
 	if (NETgetPacketDir() == PACKET_DECODE)
 	{
 		bool ret = reader.valid();
+		NETlogMessageTime(message.type, NetTimingDecode, NETlogMicrosSince(messageBeginTime));
 
 		// We have ended the deserialisation, so mark the direction invalid
 		NETsetPacketDir(PACKET_INVALID);
@@ -499,6 +499,11 @@ void wzYieldCurrentThread()
 	SDL_Delay(40);
 }
 
+unsigned wzGetCPUCount()
+{
+	return static_cast<unsigned>(std::max(SDL_GetCPUCount(), 1));
+}
+
 WZ_MUTEX *wzMutexCreate()
 {
 	return (WZ_MUTEX *)SDL_CreateMutex();
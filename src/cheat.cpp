@@ -107,6 +107,11 @@ bool _attemptCheatCode(const char *cheat_name)
 		kf_ToggleUnitCount();
 		return true;
 	}
+	if (!strcasecmp("netstats", cheat_name))
+	{
+		kf_NetStats();
+		return true;
+	}
 
 	if (strcmp(cheat_name, "cheat on") == 0 || strcmp(cheat_name, "debug") == 0)
 	{
@@ -38,6 +38,7 @@
 #include "main.h"
 #include "modding.h"
 #include "multiplay.h"
+#include "scriptprofiler.h"
 #include "version.h"
 #include "warzoneconfig.h"
 #include "wrappers.h"
@@ -257,6 +258,7 @@ typedef enum
 	CLI_CONTINUE,
 	CLI_AUTOHOST,
 	CLI_AUTORATING,
+	CLI_PROFILESCRIPTS,
 } CLI_OPTIONS;
 
 static const struct poptOption *getOptionsTable()
@@ -312,6 +314,7 @@ static const struct poptOption *getOptionsTable()
 		{ "continue", POPT_ARG_NONE, CLI_CONTINUE,   N_("Continue the last saved game"), nullptr },
 		{ "autohost", POPT_ARG_STRING, CLI_AUTOHOST,   N_("Start host game with given settings file"), N_("autohost") },
 		{ "autorating", POPT_ARG_STRING, CLI_AUTORATING,   N_("Query ratings from given server url (containing \"{HASH}\"), when hosting"), N_("autorating") },
+		{ "profile-scripts", POPT_ARG_NONE, CLI_PROFILESCRIPTS, N_("Profile scripts, and write the results to the script logs and a flame graph stack file"), nullptr },
 		// Terminating entry
 		{ nullptr, 0, 0,              nullptr,                                    nullptr },
 	};
@@ -711,6 +714,10 @@ bool ParseCommandLine(int argc, const char * const *argv)
 			wz_autogame = true;
 			break;
 
+		case CLI_PROFILESCRIPTS:
+			scriptProfilerSetEnabled(true);
+			break;
+
 		case CLI_SAVEANDQUIT:
 			token = poptGetOptArg(poptCon);
 			if (token == nullptr || !strchr(token, '/'))
@@ -257,6 +257,11 @@ bool loadConfig()
 			debug(LOG_WARNING, "Unsupported / invalid jsbackend value: %s; defaulting to: %s", ini.value("js_backend").toString().toUtf8().constData(), to_string(js_backend).c_str());
 		}
 	}
+	war_setConcurrentScripts(ini.value("concurrentscripts", false).toBool());
+	war_setScriptMemoryLimit(ini.value("scriptMemoryLimit", 0).toInt());
+	war_setScriptGCThreshold(ini.value("scriptGCThreshold", 0).toInt());
+	war_setScriptGCBudget(ini.value("scriptGCBudget", 0).toInt());
+	war_setBinarySaves(ini.value("binarySaves", true).toBool());
 	BlueprintTrackAnimationSpeed = ini.value("BlueprintTrackAnimationSpeed", 20).toInt();
 	ActivityManager::instance().endLoadingSettings();
 	return true;
@@ -353,6 +358,11 @@ bool saveConfig()
 	ini.setValue("favoriteStructs", getFavoriteStructs().toUtf8().c_str());
 	ini.setValue("gfxbackend", to_string(war_getGfxBackend()).c_str());
 	ini.setValue("jsbackend", to_string(war_getJSBackend()).c_str());
+	ini.setValue("concurrentscripts", war_getConcurrentScripts());
+	ini.setValue("scriptMemoryLimit", war_getScriptMemoryLimit());
+	ini.setValue("scriptGCThreshold", war_getScriptGCThreshold());
+	ini.setValue("scriptGCBudget", war_getScriptGCBudget());
+	ini.setValue("binarySaves", war_getBinarySaves());
 	ini.setValue("BlueprintTrackAnimationSpeed", BlueprintTrackAnimationSpeed);
 	ini.sync();
 	return true;
@@ -115,6 +115,10 @@ static void calcDataHash(const uint8_t *pBuffer, uint32_t size, uint32_t index)
 
 static void calcDataHash(const WzConfig &ini, uint32_t index)
 {
+	if (!bMultiPlayer)
+	{
+		return;
+	}
 	std::string jsonDump = ini.compactStringRepresentation();
 	calcDataHash(reinterpret_cast<const uint8_t *>(jsonDump.data()), jsonDump.size(), index);
 }
@@ -144,7 +148,7 @@ void dataClearSaveFlag()
 /* Load the body stats */
 static bool bufferSBODYLoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_SBODY);
 
 	if (!loadBodyStats(ini) || !allocComponentList(COMP_BODY, numBodyStats))
@@ -166,7 +170,7 @@ static void dataReleaseStats(WZ_DECL_UNUSED void *pData)
 /* Load the weapon stats */
 static bool bufferSWEAPONLoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_SWEAPON);
 
 	if (!loadWeaponStats(ini)
@@ -183,7 +187,7 @@ static bool bufferSWEAPONLoad(const char *fileName, void **ppData)
 /* Load the constructor stats */
 static bool bufferSCONSTRLoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_SCONSTR);
 
 	if (!loadConstructStats(ini)
@@ -200,7 +204,7 @@ static bool bufferSCONSTRLoad(const char *fileName, void **ppData)
 /* Load the ECM stats */
 static bool bufferSECMLoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_SECM);
 
 	if (!loadECMStats(ini)
@@ -217,7 +221,7 @@ static bool bufferSECMLoad(const char *fileName, void **ppData)
 /* Load the Propulsion stats */
 static bool bufferSPROPLoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_SPROP);
 
 	if (!loadPropulsionStats(ini) || !allocComponentList(COMP_PROPULSION, numPropulsionStats))
@@ -232,7 +236,7 @@ static bool bufferSPROPLoad(const char *fileName, void **ppData)
 
 static bool bufferSSENSORLoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_SSENSOR);
 
 	if (!loadSensorStats(ini)
@@ -249,7 +253,7 @@ static bool bufferSSENSORLoad(const char *fileName, void **ppData)
 /* Load the Repair stats */
 static bool bufferSREPAIRLoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_SREPAIR);
 
 	if (!loadRepairStats(ini) || !allocComponentList(COMP_REPAIRUNIT, numRepairStats))
@@ -265,7 +269,7 @@ static bool bufferSREPAIRLoad(const char *fileName, void **ppData)
 /* Load the Brain stats */
 static bool bufferSBRAINLoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_SBRAIN);
 
 	if (!loadBrainStats(ini) || !allocComponentList(COMP_BRAIN, numBrainStats))
@@ -280,7 +284,7 @@ static bool bufferSBRAINLoad(const char *fileName, void **ppData)
 /* Load the PropulsionType stats */
 static bool bufferSPROPTYPESLoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_SPROPTY);
 
 	if (!loadPropulsionTypes(ini))
@@ -309,7 +313,7 @@ static bool bufferSPROPSNDLoad(const char *fileName, void **ppData)
 /* Load the STERRTABLE stats */
 static bool bufferSTERRTABLELoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_STERRT);
 
 	if (!loadTerrainTable(ini))
@@ -333,7 +337,7 @@ static bool bufferSBPIMDLoad(const char *fileName, void **ppData)
 /* Load the Weapon Effect modifier stats */
 static bool bufferSWEAPMODLoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_SWEAPMOD);
 
 	if (!loadWeaponModifiers(ini))
@@ -370,7 +374,7 @@ static void dataSTEMPLRelease(WZ_DECL_UNUSED void *pData)
 /* Load the Structure stats */
 static bool bufferSSTRUCTLoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_SSTRUCT);
 
 	if (!loadStructureStats(ini))
@@ -398,7 +402,7 @@ static void dataSSTRUCTRelease(WZ_DECL_UNUSED void *pData)
 /* Load the Structure strength modifier stats */
 static bool bufferSSTRMODLoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_SSTRMOD);
 
 	if (!loadStructureStrengthModifiers(ini))
@@ -414,7 +418,7 @@ static bool bufferSSTRMODLoad(const char *fileName, void **ppData)
 /* Load the Feature stats */
 static bool bufferSFEATLoad(const char *fileName, void **ppData)
 {
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_SFEAT);
 
 	if (!loadFeatureStats(ini))
@@ -449,7 +453,7 @@ static bool bufferRESCHLoad(const char *fileName, void **ppData)
 		dataRESCHRelease(nullptr);
 	}
 
-	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired, WzConfig::Cached);
 	calcDataHash(ini, DATA_RESCH);
 
 	if (!loadResearch(ini))
@@ -1658,6 +1658,7 @@ so can be called in levLoadData when starting a game from a load save game*/
 // -----------------------------------------------------------------------------------------
 bool loadGameInit(const char *fileName)
 {
+	waitForDeferredSaveFiles();
 	if (!gameLoad(fileName))
 	{
 		debug(LOG_ERROR, "Corrupted / unsupported savegame file %s, Unable to load!", fileName);
@@ -1837,6 +1838,8 @@ bool loadGame(const char *pGameToLoad, bool keepObjects, bool freeMem, bool User
 	UWORD           missionScrollMinX = 0, missionScrollMinY = 0,
 	                missionScrollMaxX = 0, missionScrollMaxY = 0;
 
+	waitForDeferredSaveFiles();  // An autosave might still be writing the files.
+
 	/* Stop the game clock */
 	gameTimeStop();
 
@@ -2657,6 +2660,7 @@ bool saveGame(const char *aFileName, GAME_TYPE saveType)
 	DROID			*psDroid, *psNext;
 	char			CurrentFileName[PATH_MAX] = {'\0'};
 
+	waitForDeferredSaveFiles();
 	triggerEvent(TRIGGER_GAME_SAVING);
 
 	ASSERT_OR_RETURN(false, aFileName && strlen(aFileName) > 4, "Bad savegame filename");
@@ -4963,10 +4967,7 @@ static bool writeDroidFile(const char *pFileName, DROID **ppsCurrentDroidLists)
 		}
 	}
 
-	std::ostringstream stream;
-	stream << mRoot.dump(4) << std::endl;
-	std::string jsonString = stream.str();
-	saveFile(pFileName, jsonString.c_str(), jsonString.size());
+	saveJsonFile(pFileName, std::move(mRoot), war_getBinarySaves());
 	debug(LOG_SAVE, "%s %s", "Saving", pFileName);
 
 	return true;
@@ -5509,6 +5510,7 @@ Writes the linked list of structure for each player to a file
 bool writeStructFile(const char *pFileName)
 {
 	WzConfig ini(WzString::fromUtf8(pFileName), WzConfig::ReadAndWrite);
+	ini.setBinary(war_getBinarySaves());
 	int counter = 0;
 
 	for (int player = 0; player < MAX_PLAYERS; player++)
@@ -5969,6 +5971,7 @@ Writes the linked list of features to a file
 bool writeFeatureFile(const char *pFileName)
 {
 	WzConfig ini(WzString::fromUtf8(pFileName), WzConfig::ReadAndWrite);
+	ini.setBinary(war_getBinarySaves());
 	int counter = 0;
 
 	for (FEATURE *psCurr = apsFeatureLists[0]; psCurr != nullptr; psCurr = psCurr->psNext)
@@ -6044,6 +6047,7 @@ bool loadSaveTemplate(const char *pFileName)
 bool writeTemplateFile(const char *pFileName)
 {
 	WzConfig ini(pFileName, WzConfig::ReadAndWrite);
+	ini.setBinary(war_getBinarySaves());
 
 	auto writeTemplate = [&](DROID_TEMPLATE *psCurr) {
 		saveTemplateCommon(ini, psCurr);
@@ -6217,6 +6221,7 @@ bool loadSaveCompList(const char *pFileName)
 static bool writeCompListFile(const char *pFileName)
 {
 	WzConfig ini(WzString::fromUtf8(pFileName), WzConfig::ReadAndWrite);
+	ini.setBinary(war_getBinarySaves());
 
 	// Save each type of struct type
 	for (int player = 0; player < MAX_PLAYERS; player++)
@@ -6339,6 +6344,7 @@ static bool loadSaveStructTypeList(const char *pFileName)
 static bool writeStructTypeListFile(const char *pFileName)
 {
 	WzConfig ini(pFileName, WzConfig::ReadAndWrite);
+	ini.setBinary(war_getBinarySaves());
 
 	// Save each type of struct type
 	for (int player = 0; player < MAX_PLAYERS; player++)
@@ -6423,6 +6429,7 @@ bool loadSaveResearch(const char *pFileName)
 static bool writeResearchFile(char *pFileName)
 {
 	WzConfig ini(WzString::fromUtf8(pFileName), WzConfig::ReadAndWrite);
+	ini.setBinary(war_getBinarySaves());
 
 	for (size_t i = 0; i < asResearch.size(); ++i)
 	{
@@ -6589,6 +6596,7 @@ bool loadSaveMessage(const char* pFileName, LEVEL_TYPE levelType)
 static bool writeMessageFile(const char *pFileName)
 {
 	WzConfig ini(pFileName, WzConfig::ReadAndWrite);
+	ini.setBinary(war_getBinarySaves());
 	int numMessages = 0;
 
 	// save each type of research
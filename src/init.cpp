@@ -31,6 +31,7 @@
 #include "lib/framework/file.h"
 #include "lib/framework/physfs_ext.h"
 #include "lib/framework/wzapp.h"
+#include "lib/framework/wzconfig.h"
 #include "lib/ivis_opengl/piemode.h"
 #include "lib/ivis_opengl/piestate.h"
 #include "lib/ivis_opengl/screen.h"
@@ -94,6 +95,8 @@
 #include "activity.h"
 
 #include <algorithm>
+#include <map>
+#include <set>
 
 static void initMiscVars();
 
@@ -133,8 +136,7 @@ static bool InitialiseGlobals()
 
 bool loadLevFile(const char *filename, searchPathMode datadir, bool ignoreWrf, char const *realFileName)
 {
-	char *pBuffer;
-	UDWORD size;
+	WzFileView file;
 
 	if (realFileName == nullptr)
 	{
@@ -145,18 +147,16 @@ bool loadLevFile(const char *filename, searchPathMode datadir, bool ignoreWrf, c
 		debug(LOG_WZ, "Loading lev file: \"%s\" from \"%s\"\n", filename, realFileName);
 	}
 
-	if (!PHYSFS_exists(filename) || !loadFile(filename, &pBuffer, &size))
+	if (!PHYSFS_exists(filename) || !file.open(filename))
 	{
 		debug(LOG_ERROR, "File not found: %s\n", filename);
 		return false; // only in NDEBUG case
 	}
-	if (!levParse(pBuffer, size, datadir, ignoreWrf, realFileName))
+	if (!levParse(file.data(), file.size(), datadir, ignoreWrf, realFileName))
 	{
 		debug(LOG_ERROR, "Parse error in %s\n", filename);
-		free(pBuffer);
 		return false;
 	}
-	free(pBuffer);
 
 	return true;
 }
@@ -238,6 +238,83 @@ void registerSearchPath(const char path[], unsigned int priority)
 }
 
 
+struct SearchPathMount
+{
+	std::string path;   ///< Platform-dependent notation.
+	bool mounted;       ///< False if PhysFS couldn't mount it, for example because it doesn't exist.
+};
+static std::vector<SearchPathMount> searchPathMounts;  ///< What rebuildSearchPath() mounted, in search order.
+
+/*!
+ * Changes the mounts made by rebuildSearchPath() to the given list, in search order.
+ *
+ * Mounting an archive means reading its whole directory, so rather than taking the old search path down and putting the
+ * new one up, the longest run of mounts which the old and new search paths have in common stays mounted, which is usually
+ * all of the base data, and only the mounts before and after it are changed.
+ */
+static void applySearchPath(std::vector<std::string> const &paths)
+{
+	std::set<std::string> ourMounts;
+	for (auto const &mount : searchPathMounts)
+	{
+		if (mount.mounted)
+		{
+			ourMounts.insert(mount.path);
+		}
+	}
+	bool othersMounted = false;
+	char **searchPath = PHYSFS_getSearchPath();
+	for (char **i = searchPath; *i != nullptr; i++)
+	{
+		othersMounted = othersMounted || (ourMounts.count(*i) == 0 && strcmp(*i, PHYSFS_getWriteDir()) != 0);
+	}
+	PHYSFS_freeList(searchPath);
+
+	// Whatever else is mounted (such as a campaign mod) must end up before the new mounts, so in that case nothing can stay.
+	size_t keepOld = 0, keepNew = 0, keepLength = 0;
+	for (size_t i = 0; i < searchPathMounts.size() && !othersMounted; ++i)
+	{
+		for (size_t j = 0; j < paths.size(); ++j)
+		{
+			size_t length = 0;
+			while (i + length < searchPathMounts.size() && j + length < paths.size() && searchPathMounts[i + length].path == paths[j + length])
+			{
+				++length;
+			}
+			if (length > keepLength)
+			{
+				keepOld = i;
+				keepNew = j;
+				keepLength = length;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < searchPathMounts.size(); ++i)
+	{
+		if (searchPathMounts[i].mounted && (i < keepOld || i >= keepOld + keepLength))
+		{
+#ifdef DEBUG
+			debug(LOG_WZ, "Removing [%s] from search path", searchPathMounts[i].path.c_str());
+#endif // DEBUG
+			WZ_PHYSFS_unmount(searchPathMounts[i].path.c_str());
+		}
+	}
+
+	std::vector<SearchPathMount> mounts(paths.size());
+	std::copy(searchPathMounts.begin() + keepOld, searchPathMounts.begin() + keepOld + keepLength, mounts.begin() + keepNew);
+	for (size_t j = keepNew; j-- > 0;)
+	{
+		mounts[j] = {paths[j], PHYSFS_mount(paths[j].c_str(), NULL, PHYSFS_PREPEND) != 0};
+	}
+	for (size_t j = keepNew + keepLength; j < paths.size(); ++j)
+	{
+		mounts[j] = {paths[j], PHYSFS_mount(paths[j].c_str(), NULL, PHYSFS_APPEND) != 0};
+	}
+	debug(LOG_WZ, "Search path: kept %zu of %zu mounts", keepLength, paths.size());
+	searchPathMounts = std::move(mounts);
+}
+
 /*!
  * \brief Rebuilds the PHYSFS searchPath with mode specific subdirs
  *
@@ -249,16 +326,11 @@ bool rebuildSearchPath(searchPathMode mode, bool force, const char *current_map)
 	static searchPathMode current_mode = mod_clean;
 	static std::string current_current_map;
 	wzSearchPath *curSearchPath = searchPathRegistry;
-	char tmpstr[PATH_MAX] = "\0";
+	std::vector<std::string> paths;
 
 	if (mode != current_mode || (current_map != nullptr ? current_map : "") != current_current_map || force ||
 	    (use_override_mods && override_mod_list != getModList()))
 	{
-		if (mode != mod_clean)
-		{
-			rebuildSearchPath(mod_clean, false);
-		}
-
 		current_mode = mode;
 		current_current_map = current_map != nullptr ? current_map : "";
 
@@ -267,53 +339,18 @@ bool rebuildSearchPath(searchPathMode mode, bool force, const char *current_map)
 		{
 			curSearchPath = curSearchPath->lowerPriority;
 		}
+		wzSearchPath *lowestSearchPath = curSearchPath;
+
+		auto addSubdirs = [&paths](const char *basedir, const char *subdir, std::vector<std::string> const *checkList, bool addToModList) {
+			std::vector<std::string> subdirs = findSubdirs(basedir, subdir, checkList, addToModList);
+			paths.insert(paths.end(), subdirs.begin(), subdirs.end());
+		};
 
 		switch (mode)
 		{
 		case mod_clean:
 			debug(LOG_WZ, "Cleaning up");
 			clearLoadedMods();
-
-			while (curSearchPath)
-			{
-#ifdef DEBUG
-				debug(LOG_WZ, "Removing [%s] from search path", curSearchPath->path);
-#endif // DEBUG
-				// Remove maps and mods
-				removeSubdirs(curSearchPath->path, "maps");
-				removeSubdirs(curSearchPath->path, "mods/music");
-				removeSubdirs(curSearchPath->path, "mods/global");
-				removeSubdirs(curSearchPath->path, "mods");
-				removeSubdirs(curSearchPath->path, "mods/autoload");
-				removeSubdirs(curSearchPath->path, "mods/campaign");
-				removeSubdirs(curSearchPath->path, "mods/multiplay");
-				removeSubdirs(curSearchPath->path, "mods/downloads");
-
-				// Remove multiplay patches
-				sstrcpy(tmpstr, curSearchPath->path);
-				sstrcat(tmpstr, "mp");
-				WZ_PHYSFS_unmount(tmpstr);
-				sstrcpy(tmpstr, curSearchPath->path);
-				sstrcat(tmpstr, "mp.wz");
-				WZ_PHYSFS_unmount(tmpstr);
-
-				// Remove plain dir
-				WZ_PHYSFS_unmount(curSearchPath->path);
-
-				// Remove base files
-				sstrcpy(tmpstr, curSearchPath->path);
-				sstrcat(tmpstr, "base");
-				WZ_PHYSFS_unmount(tmpstr);
-				sstrcpy(tmpstr, curSearchPath->path);
-				sstrcat(tmpstr, "base.wz");
-				WZ_PHYSFS_unmount(tmpstr);
-
-				// remove video search path as well
-				sstrcpy(tmpstr, curSearchPath->path);
-				sstrcat(tmpstr, "sequences.wz");
-				WZ_PHYSFS_unmount(tmpstr);
-				curSearchPath = curSearchPath->higherPriority;
-			}
 			break;
 		case mod_campaign:
 			debug(LOG_WZ, "*** Switching to campaign mods ***");
@@ -322,46 +359,27 @@ bool rebuildSearchPath(searchPathMode mode, bool force, const char *current_map)
 			while (curSearchPath)
 			{
 				// make sure videos override included files
-				sstrcpy(tmpstr, curSearchPath->path);
-				sstrcat(tmpstr, "sequences.wz");
-				PHYSFS_mount(tmpstr, NULL, PHYSFS_APPEND);
+				paths.push_back(std::string(curSearchPath->path) + "sequences.wz");
 				curSearchPath = curSearchPath->higherPriority;
 			}
-			curSearchPath = searchPathRegistry;
-			while (curSearchPath->lowerPriority)
-			{
-				curSearchPath = curSearchPath->lowerPriority;
-			}
-			while (curSearchPath)
+			for (curSearchPath = lowestSearchPath; curSearchPath; curSearchPath = curSearchPath->higherPriority)
 			{
 #ifdef DEBUG
 				debug(LOG_WZ, "Adding [%s] to search path", curSearchPath->path);
 #endif // DEBUG
 				// Add global and campaign mods
-				PHYSFS_mount(curSearchPath->path, NULL, PHYSFS_APPEND);
-
-				addSubdirs(curSearchPath->path, "mods/music", PHYSFS_APPEND, nullptr, false);
-				addSubdirs(curSearchPath->path, "mods/global", PHYSFS_APPEND, use_override_mods ? &override_mods : &global_mods, true);
-				addSubdirs(curSearchPath->path, "mods", PHYSFS_APPEND, use_override_mods ? &override_mods : &global_mods, true);
-				addSubdirs(curSearchPath->path, "mods/autoload", PHYSFS_APPEND, use_override_mods ? &override_mods : nullptr, true);
-				addSubdirs(curSearchPath->path, "mods/campaign", PHYSFS_APPEND, use_override_mods ? &override_mods : &campaign_mods, true);
-				if (!WZ_PHYSFS_unmount(curSearchPath->path))
-				{
-					debug(LOG_WZ, "* Failed to remove path %s again", curSearchPath->path);
-				}
+				addSubdirs(curSearchPath->path, "mods/music", nullptr, false);
+				addSubdirs(curSearchPath->path, "mods/global", use_override_mods ? &override_mods : &global_mods, true);
+				addSubdirs(curSearchPath->path, "mods", use_override_mods ? &override_mods : &global_mods, true);
+				addSubdirs(curSearchPath->path, "mods/autoload", use_override_mods ? &override_mods : nullptr, true);
+				addSubdirs(curSearchPath->path, "mods/campaign", use_override_mods ? &override_mods : &campaign_mods, true);
 
 				// Add plain dir
-				PHYSFS_mount(curSearchPath->path, NULL, PHYSFS_APPEND);
+				paths.push_back(curSearchPath->path);
 
 				// Add base files
-				sstrcpy(tmpstr, curSearchPath->path);
-				sstrcat(tmpstr, "base");
-				PHYSFS_mount(tmpstr, NULL, PHYSFS_APPEND);
-				sstrcpy(tmpstr, curSearchPath->path);
-				sstrcat(tmpstr, "base.wz");
-				PHYSFS_mount(tmpstr, NULL, PHYSFS_APPEND);
-
-				curSearchPath = curSearchPath->higherPriority;
+				paths.push_back(std::string(curSearchPath->path) + "base");
+				paths.push_back(std::string(curSearchPath->path) + "base.wz");
 			}
 			break;
 		case mod_multiplay:
@@ -371,9 +389,7 @@ bool rebuildSearchPath(searchPathMode mode, bool force, const char *current_map)
 			while (curSearchPath)
 			{
 				// make sure videos override included files
-				sstrcpy(tmpstr, curSearchPath->path);
-				sstrcat(tmpstr, "sequences.wz");
-				PHYSFS_mount(tmpstr, NULL, PHYSFS_APPEND);
+				paths.push_back(std::string(curSearchPath->path) + "sequences.wz");
 				curSearchPath = curSearchPath->higherPriority;
 			}
 			// Add the selected map first, for mapmod support
@@ -381,29 +397,23 @@ bool rebuildSearchPath(searchPathMode mode, bool force, const char *current_map)
 			{
 				WzString realPathAndDir = WzString::fromUtf8(PHYSFS_getRealDir(current_map)) + current_map;
 				realPathAndDir.replace("/", PHYSFS_getDirSeparator()); // Windows fix
-				PHYSFS_mount(realPathAndDir.toUtf8().c_str(), NULL, PHYSFS_APPEND);
+				paths.push_back(realPathAndDir.toUtf8());
 			}
-			curSearchPath = searchPathRegistry;
-			while (curSearchPath->lowerPriority)
-			{
-				curSearchPath = curSearchPath->lowerPriority;
-			}
-			while (curSearchPath)
+			for (curSearchPath = lowestSearchPath; curSearchPath; curSearchPath = curSearchPath->higherPriority)
 			{
 #ifdef DEBUG
 				debug(LOG_WZ, "Adding [%s] to search path", curSearchPath->path);
 #endif // DEBUG
 				// Add global and multiplay mods
-				PHYSFS_mount(curSearchPath->path, NULL, PHYSFS_APPEND);
-				addSubdirs(curSearchPath->path, "mods/music", PHYSFS_APPEND, nullptr, false);
+				addSubdirs(curSearchPath->path, "mods/music", nullptr, false);
 
 				// Only load if we are host or singleplayer (Initial mod load relies on this, too)
 				if (ingame.side == InGameSide::HOST_OR_SINGLEPLAYER || !NetPlay.bComms)
 				{
-					addSubdirs(curSearchPath->path, "mods/global", PHYSFS_APPEND, use_override_mods ? &override_mods : &global_mods, true);
-					addSubdirs(curSearchPath->path, "mods", PHYSFS_APPEND, use_override_mods ? &override_mods : &global_mods, true);
-					addSubdirs(curSearchPath->path, "mods/autoload", PHYSFS_APPEND, use_override_mods ? &override_mods : nullptr, true);
-					addSubdirs(curSearchPath->path, "mods/multiplay", PHYSFS_APPEND, use_override_mods ? &override_mods : &multiplay_mods, true);
+					addSubdirs(curSearchPath->path, "mods/global", use_override_mods ? &override_mods : &global_mods, true);
+					addSubdirs(curSearchPath->path, "mods", use_override_mods ? &override_mods : &global_mods, true);
+					addSubdirs(curSearchPath->path, "mods/autoload", use_override_mods ? &override_mods : nullptr, true);
+					addSubdirs(curSearchPath->path, "mods/multiplay", use_override_mods ? &override_mods : &multiplay_mods, true);
 				}
 				else
 				{
@@ -411,37 +421,27 @@ bool rebuildSearchPath(searchPathMode mode, bool force, const char *current_map)
 					for (Sha256 &hash : game.modHashes)
 					{
 						hashList = {hash.toString()};
-						addSubdirs(curSearchPath->path, "mods/downloads", PHYSFS_APPEND, &hashList, true);
+						addSubdirs(curSearchPath->path, "mods/downloads", &hashList, true);
 					}
 				}
-				WZ_PHYSFS_unmount(curSearchPath->path);
 
 				// Add multiplay patches
-				sstrcpy(tmpstr, curSearchPath->path);
-				sstrcat(tmpstr, "mp");
-				PHYSFS_mount(tmpstr, NULL, PHYSFS_APPEND);
-				sstrcpy(tmpstr, curSearchPath->path);
-				sstrcat(tmpstr, "mp.wz");
-				PHYSFS_mount(tmpstr, NULL, PHYSFS_APPEND);
+				paths.push_back(std::string(curSearchPath->path) + "mp");
+				paths.push_back(std::string(curSearchPath->path) + "mp.wz");
 
 				// Add plain dir
-				PHYSFS_mount(curSearchPath->path, NULL, PHYSFS_APPEND);
+				paths.push_back(curSearchPath->path);
 
 				// Add base files
-				sstrcpy(tmpstr, curSearchPath->path);
-				sstrcat(tmpstr, "base");
-				PHYSFS_mount(tmpstr, NULL, PHYSFS_APPEND);
-				sstrcpy(tmpstr, curSearchPath->path);
-				sstrcat(tmpstr, "base.wz");
-				PHYSFS_mount(tmpstr, NULL, PHYSFS_APPEND);
-
-				curSearchPath = curSearchPath->higherPriority;
+				paths.push_back(std::string(curSearchPath->path) + "base");
+				paths.push_back(std::string(curSearchPath->path) + "base.wz");
 			}
 			break;
 		default:
 			debug(LOG_ERROR, "Can't switch to unknown mods %i", mode);
 			return false;
 		}
+		applySearchPath(paths);
 		if (use_override_mods && mode != mod_clean)
 		{
 			if (getModList() != override_mod_list)
@@ -479,11 +479,147 @@ public:
 	std::string platformDependent;
 };
 typedef std::vector<MapFileListPath> MapFileList;
+
+#define MAP_INDEX_FILE "cache/mapindex.bin"
+#define MAP_INDEX_VERSION 1
+static const char mapIndexMagic[CACHE_FILE_MAGIC_SIZE] = {'W', 'Z', 'M', 'A', 'P', 'I', '0', '2'};
+
+/// What listMapFiles() and buildMapList() found out about a map archive the last time it changed, so that they don't have to mount it again.
+struct MapIndexEntry
+{
+	int64_t size = -1;
+	int64_t modTime = -1;
+	bool checked = false;   ///< Whether listMapFiles() has checked the archive.
+	bool isMapPack = false;
+	bool scanned = false;   ///< Whether buildMapList() has read the rest.
+	bool isMapMod = false;
+	bool isRandom = false;
+	Sha256 hash;
+	std::vector<std::pair<std::string, std::string>> levFiles;  ///< Names and contents of the .lev files in the archive.
+};
+
+static std::map<std::string, MapIndexEntry> mapIndex;  ///< By platform independent archive name.
+static bool mapIndexLoaded = false;
+static bool mapIndexChanged = false;
+
+static void loadMapIndex()
+{
+	mapIndexLoaded = true;
+	std::vector<uint8_t> data;
+	if (!loadCacheFile(MAP_INDEX_FILE, mapIndexMagic, data))
+	{
+		return;
+	}
+	try
+	{
+		nlohmann::json index = nlohmann::json::from_cbor(data);
+		if (index.value("version", 0) == MAP_INDEX_VERSION)
+		{
+			for (auto const &archive : index.at("archives").items())
+			{
+				nlohmann::json const &value = archive.value();
+				MapIndexEntry entry;
+				entry.size = value.at("size").get<int64_t>();
+				entry.modTime = value.at("modTime").get<int64_t>();
+				entry.checked = true;
+				entry.isMapPack = value.at("isMapPack").get<bool>();
+				entry.scanned = value.contains("hash");
+				if (entry.scanned)
+				{
+					entry.isMapMod = value.at("isMapMod").get<bool>();
+					entry.isRandom = value.at("isRandom").get<bool>();
+					entry.hash.fromString(value.at("hash").get<std::string>());
+					for (auto const &levFile : value.at("levFiles").items())
+					{
+						entry.levFiles.emplace_back(levFile.key(), levFile.value().get<std::string>());
+					}
+				}
+				mapIndex[archive.key()] = std::move(entry);
+			}
+		}
+	}
+	catch (const std::exception &e)
+	{
+		debug(LOG_WARNING, "Ignoring damaged map index %s: %s", MAP_INDEX_FILE, e.what());
+		mapIndex.clear();
+	}
+	debug(LOG_WZ, "Map index has %zu archives", mapIndex.size());
+}
+
+static void saveMapIndex()
+{
+	if (!mapIndexChanged)
+	{
+		return;
+	}
+	mapIndexChanged = false;
+	nlohmann::json archives = nlohmann::json::object();
+	for (auto const &archive : mapIndex)
+	{
+		MapIndexEntry const &entry = archive.second;
+		if (!entry.checked)
+		{
+			continue;
+		}
+		nlohmann::json value = nlohmann::json::object();
+		value["size"] = entry.size;
+		value["modTime"] = entry.modTime;
+		value["isMapPack"] = entry.isMapPack;
+		if (entry.scanned)
+		{
+			value["isMapMod"] = entry.isMapMod;
+			value["isRandom"] = entry.isRandom;
+			value["hash"] = entry.hash.toString();
+			nlohmann::json levFiles = nlohmann::json::object();
+			for (auto const &levFile : entry.levFiles)
+			{
+				levFiles[levFile.first] = levFile.second;
+			}
+			value["levFiles"] = std::move(levFiles);
+		}
+		archives[archive.first] = std::move(value);
+	}
+	nlohmann::json index = nlohmann::json::object();
+	index["version"] = MAP_INDEX_VERSION;
+	index["archives"] = std::move(archives);
+	std::vector<uint8_t> data;
+	try
+	{
+		// CBOR keeps the .lev files exactly as they are. Those of community maps aren't always UTF-8, which dump() throws on.
+		data = nlohmann::json::to_cbor(index);
+	}
+	catch (const nlohmann::json::exception &e)
+	{
+		debug(LOG_WARNING, "Not writing map index %s: %s", MAP_INDEX_FILE, e.what());
+		return;
+	}
+	saveCacheFile(MAP_INDEX_FILE, mapIndexMagic, data.data(), data.size());
+}
+
+/// Size and modification time of the archive, to tell whether it changed since it was indexed.
+static bool getMapArchiveStamp(const char *fileName, int64_t &size, int64_t &modTime)
+{
+	PHYSFS_file *fileHandle = PHYSFS_openRead(fileName);
+	if (fileHandle == nullptr)
+	{
+		return false;
+	}
+	size = PHYSFS_fileLength(fileHandle);
+	PHYSFS_close(fileHandle);
+	modTime = WZ_PHYSFS_getLastModTime(fileName);
+	return true;
+}
+
 static MapFileList listMapFiles()
 {
 	MapFileList ret, filtered;
 	std::vector<std::string> oldSearchPath;
 
+	if (!mapIndexLoaded)
+	{
+		loadMapIndex();
+	}
+
 	WZ_PHYSFS_enumerateFiles("maps", [&](const char *i) -> bool {
 		std::string wzfile = i;
 		if (i[0] == '.' || wzfile.substr(wzfile.find_last_of('.') + 1) != "wz")
@@ -497,19 +633,53 @@ static MapFileList listMapFiles()
 		return true; // continue
 	});
 
-	// save our current search path(s)
-	debug(LOG_WZ, "Map search paths:");
-	char **searchPath = PHYSFS_getSearchPath();
-	for (char **i = searchPath; *i != nullptr; i++)
+	// Only archives which are new or changed since they were indexed need to be mounted.
+	std::map<std::string, MapIndexEntry> oldIndex;
+	std::swap(oldIndex, mapIndex);
+	std::vector<bool> needsCheck;
+	size_t checkCount = 0;
+	for (const auto &realFileName : ret)
 	{
-		debug(LOG_WZ, "    [%s]", *i);
-		oldSearchPath.push_back(*i);
-		WZ_PHYSFS_unmount(*i);
+		MapIndexEntry entry;
+		getMapArchiveStamp(realFileName.platformIndependent.c_str(), entry.size, entry.modTime);
+		auto it = oldIndex.find(realFileName.platformIndependent);
+		if (it != oldIndex.end() && it->second.checked && it->second.size == entry.size && it->second.modTime == entry.modTime)
+		{
+			entry = std::move(it->second);
+		}
+		needsCheck.push_back(!entry.checked);
+		checkCount += !entry.checked;
+		mapIndex[realFileName.platformIndependent] = std::move(entry);
 	}
-	PHYSFS_freeList(searchPath);
+	mapIndexChanged = mapIndexChanged || checkCount > 0 || oldIndex.size() + checkCount != mapIndex.size();
+	debug(LOG_WZ, "%zu of %zu map archives changed since they were indexed", checkCount, ret.size());
 
-	for (const auto &realFileName : ret)
+	if (checkCount > 0)
+	{
+		// save our current search path(s)
+		debug(LOG_WZ, "Map search paths:");
+		char **searchPath = PHYSFS_getSearchPath();
+		for (char **i = searchPath; *i != nullptr; i++)
+		{
+			debug(LOG_WZ, "    [%s]", *i);
+			oldSearchPath.push_back(*i);
+			WZ_PHYSFS_unmount(*i);
+		}
+		PHYSFS_freeList(searchPath);
+	}
+
+	for (size_t n = 0; n < ret.size(); ++n)
 	{
+		const auto &realFileName = ret[n];
+		MapIndexEntry &entry = mapIndex[realFileName.platformIndependent];
+		if (!needsCheck[n])
+		{
+			if (!entry.isMapPack)
+			{
+				filtered.push_back(realFileName);
+			}
+			continue;
+		}
 		std::string realFilePathAndName = PHYSFS_getWriteDir() + realFileName.platformDependent;
 		if (PHYSFS_mount(realFilePathAndName.c_str(), NULL, PHYSFS_APPEND))
 		{
@@ -532,6 +702,8 @@ static MapFileList listMapFiles()
 				}
 				return true; // continue
 			});
+			entry.checked = true;
+			entry.isMapPack = unsafe >= 2;
 			if (unsafe < 2)
 			{
 				filtered.push_back(realFileName);
@@ -544,13 +716,16 @@ static MapFileList listMapFiles()
 		}
 	}
 
-	// restore our search path(s) again
-	for (const auto &restorePaths : oldSearchPath)
+	if (checkCount > 0)
 	{
-		PHYSFS_mount(restorePaths.c_str(), NULL, PHYSFS_APPEND);
+		// restore our search path(s) again
+		for (const auto &restorePaths : oldSearchPath)
+		{
+			PHYSFS_mount(restorePaths.c_str(), NULL, PHYSFS_APPEND);
+		}
+		debug(LOG_WZ, "Search paths restored");
+		printSearchPath();
 	}
-	debug(LOG_WZ, "Search paths restored");
-	printSearchPath();
 
 	return filtered;
 }
@@ -658,6 +833,52 @@ static std::pair<bool, bool> CheckInMap(const char *archive, const char *mountpo
 	return {mapmod, isRandom};
 }
 
+static void parseMapLevFile(const std::string &fileName, const std::string &contents, const char *realFileName)
+{
+	debug(LOG_WZ, "Loading lev file: \"%s\" from \"%s\"\n", fileName.c_str(), realFileName);
+	if (!levParse(contents.data(), contents.size(), mod_multiplay, true, realFileName))
+	{
+		debug(LOG_ERROR, "Parse error in %s\n", fileName.c_str());
+	}
+}
+
+/// Reads what buildMapList() needs from a map archive which isn't in the map index yet.
+static void scanMapArchive(const MapFileListPath &realFileName, const std::string &realFilePathAndName, MapIndexEntry &entry)
+{
+	PHYSFS_mount(realFilePathAndName.c_str(), NULL, PHYSFS_APPEND);
+
+	entry.levFiles.clear();
+	WZ_PHYSFS_enumerateFiles("", [&](const char *file) -> bool {
+		size_t len = strlen(file);
+		// Do not add addon.lev again, and add support for X player maps using a new name to prevent conflicts.
+		if ((len > 10 && !strcasecmp(file + (len - 10), ".addon.lev")) || (len > 13 && !strcasecmp(file + (len - 13), ".xplayers.lev")))
+		{
+			const char *realDir = PHYSFS_getRealDir(file);
+			char *pBuffer;
+			UDWORD size;
+			if (realDir != nullptr && realFilePathAndName == realDir && loadFile(file, &pBuffer, &size))
+			{
+				entry.levFiles.emplace_back(file, std::string(pBuffer, size));
+				free(pBuffer);
+			}
+		}
+		return true; // continue
+	});
+
+	if (WZ_PHYSFS_unmount(realFilePathAndName.c_str()) == 0)
+	{
+		debug(LOG_ERROR, "Could not unmount %s, %s", realFilePathAndName.c_str(), WZ_PHYSFS_getLastError());
+	}
+
+	auto chk = CheckInMap(realFilePathAndName.c_str(), "WZMap", "WZMap");
+	auto chk2 = CheckInMap(realFilePathAndName.c_str(), "WZMap", "WZMap/multiplay");
+	entry.isMapMod = chk.first || chk2.first;
+	entry.isRandom = chk.second || chk2.second;
+	entry.hash = findHashOfFile(realFileName.platformIndependent.c_str());
+	entry.scanned = true;
+	mapIndexChanged = true;
+}
+
 bool buildMapList()
 {
 	if (!loadLevFile("gamedesc.lev", mod_campaign, false, nullptr))
@@ -670,43 +891,31 @@ bool buildMapList()
 	for (auto &realFileName : realFileNames)
 	{
 		struct WZmaps CurrentMap;
-		const char * pRealDirStr = PHYSFS_getRealDir(realFileName.platformIndependent.c_str());
-		if (!pRealDirStr)
+		MapIndexEntry &entry = mapIndex[realFileName.platformIndependent];
+		if (!entry.scanned)
 		{
-			debug(LOG_ERROR, "Failed to find realdir for: %s", realFileName.platformIndependent.c_str());
-			continue; // skip
-		}
-		std::string realFilePathAndName = pRealDirStr + realFileName.platformDependent;
-
-		PHYSFS_mount(realFilePathAndName.c_str(), NULL, PHYSFS_APPEND);
-
-		WZ_PHYSFS_enumerateFiles("", [&](const char *file) -> bool {
-			size_t len = strlen(file);
-			if (len > 10 && !strcasecmp(file + (len - 10), ".addon.lev"))  // Do not add addon.lev again
-			{
-				loadLevFile(file, mod_multiplay, true, realFileName.platformIndependent.c_str());
-			}
-			// add support for X player maps using a new name to prevent conflicts.
-			if (len > 13 && !strcasecmp(file + (len - 13), ".xplayers.lev"))
+			const char * pRealDirStr = PHYSFS_getRealDir(realFileName.platformIndependent.c_str());
+			if (!pRealDirStr)
 			{
-				loadLevFile(file, mod_multiplay, true, realFileName.platformIndependent.c_str());
+				debug(LOG_ERROR, "Failed to find realdir for: %s", realFileName.platformIndependent.c_str());
+				continue; // skip
 			}
-			return true; // continue
-		});
+			std::string realFilePathAndName = pRealDirStr + realFileName.platformDependent;
+			scanMapArchive(realFileName, realFilePathAndName, entry);
+		}
 
-		if (WZ_PHYSFS_unmount(realFilePathAndName.c_str()) == 0)
+		for (auto const &levFile : entry.levFiles)
 		{
-			debug(LOG_ERROR, "Could not unmount %s, %s", realFilePathAndName.c_str(), WZ_PHYSFS_getLastError());
+			parseMapLevFile(levFile.first, levFile.second, realFileName.platformIndependent.c_str());
 		}
-
-		auto chk = CheckInMap(realFilePathAndName.c_str(), "WZMap", "WZMap");
-		auto chk2 = CheckInMap(realFilePathAndName.c_str(), "WZMap", "WZMap/multiplay");
+		levSetFileHash(realFileName.platformIndependent.c_str(), entry.hash);
 
 		CurrentMap.MapName = realFileName.platformIndependent;
-		CurrentMap.isMapMod = chk.first || chk2.first;
-		CurrentMap.isRandom = chk.second || chk2.second;
+		CurrentMap.isMapMod = entry.isMapMod;
+		CurrentMap.isRandom = entry.isRandom;
 		WZ_Maps.push_back(CurrentMap);
 	}
+	saveMapIndex();
 
 	return true;
 }
@@ -771,6 +980,7 @@ bool systemInitialise(float horizScaleFactor, float vertScaleFactor)
 //
 void systemShutdown()
 {
+	waitForDeferredSaveFiles();
 	pie_ShutdownRadar();
 	clearLoadedMods();
 	flushConsoleMessages();
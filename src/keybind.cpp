@@ -53,6 +53,7 @@
 
 #include "cheat.h"
 #include "lib/netplay/netplay.h"
+#include "lib/netplay/netlog.h"
 #include "multiplay.h"
 #include "multimenu.h"
 #include "atmos.h"
@@ -657,6 +658,22 @@ void	kf_FrameRate()
 	CONPRINTF("Built: %s %s", getCompileDate(), __TIME__);
 }
 
+/* Writes out the network message types using the most bandwidth, and dumps all per-message statistics */
+void kf_NetStats()
+{
+	for (uint8_t type : NETgetTopMessageTypes(5))
+	{
+		const NETMESSAGESTATS &stats = NETgetMessageStats(type);
+		CONPRINTF("%s: sent %u (%llu bytes, %llu on wire), recv %u (%llu bytes), decode p99 %uus, queued p99 %uus",
+		          messageTypeToString(type), stats.count[0], (unsigned long long)stats.bytes[0], (unsigned long long)stats.wireBytes,
+		          stats.count[1], (unsigned long long)stats.bytes[1], stats.decodeTime.percentile(99), stats.queueTime.percentile(99));
+	}
+	if (NETwriteMessageStats("logs/netstats.log"))
+	{
+		CONPRINTF("%s", "Network message statistics written to logs/netstats.log");
+	}
+}
+
 // --------------------------------------------------------------------------
 
 // display the total number of objects in the world
@@ -43,6 +43,7 @@ void kf_ToggleUnitCount();		// Display units built / lost / produced counter
 void kf_ToggleSamples();		// Displays # of sound samples in Queue/list.
 void kf_ToggleOrders();		//displays unit's Order/action state.
 void kf_FrameRate();
+void kf_NetStats();
 void kf_ShowNumObjects();
 void kf_ToggleRadar();
 void kf_TogglePower();
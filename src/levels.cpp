@@ -26,6 +26,8 @@
 
 #include <ctype.h>
 #include <string.h>
+#include <string>
+#include <unordered_map>
 
 #include "lib/framework/frame.h"
 #include "lib/framework/frameresource.h"
@@ -66,6 +68,8 @@ static	char	currentLevelName[32] = { "main" };
 
 // the current level descriptions
 LEVEL_LIST psLevels;
+// the levels of each map or mod archive, for levSetFileHash()
+static std::unordered_multimap<std::string, LEVEL_DATASET *> levelsByRealFileName;
 
 // the currently loaded data set
 static LEVEL_DATASET	*psBaseData = nullptr;
@@ -98,6 +102,7 @@ enum LEVELPARSER_STATE
 bool levInitialise()
 {
 	psLevels.clear();
+	levelsByRealFileName.clear();
 	psBaseData = nullptr;
 	psCurrLevel = nullptr;
 
@@ -127,6 +132,7 @@ void levShutDown()
 		free(toDelete);
 	}
 	psLevels.clear();
+	levelsByRealFileName.clear();
 }
 
 // error report function for the level parser
@@ -171,6 +177,15 @@ Sha256 levGetFileHash(LEVEL_DATASET *level)
 	return level->realFileHash;
 }
 
+void levSetFileHash(char const *realFileName, Sha256 const &hash)
+{
+	auto range = levelsByRealFileName.equal_range(realFileName);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		it->second->realFileHash = hash;
+	}
+}
+
 Sha256 levGetMapNameHash(char const *mapName)
 {
 	LEVEL_DATASET *level = levFindDataSet(mapName, nullptr);
@@ -232,6 +247,10 @@ bool levParse(const char *buffer, size_t size, searchPathMode datadir, bool igno
 				psDataSet->realFileName = realFileName != nullptr ? strdup(realFileName) : nullptr;
 				psDataSet->realFileHash.setZero();  // The hash is only calculated on demand; for example, if the map name matches.
 				psLevels.push_back(psDataSet);
+				if (realFileName != nullptr)
+				{
+					levelsByRealFileName.emplace(realFileName, psDataSet);
+				}
 				currData = 0;
 
 				// set the dataset type
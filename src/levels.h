@@ -93,6 +93,8 @@ LEVEL_DATASET *levFindDataSet(char const *name, Sha256 const *hash = nullptr);
 
 Sha256 levGetFileHash(LEVEL_DATASET *level);
 Sha256 levGetMapNameHash(char const *name);
+/// Sets the hash of all levels in the given file, when it is already known, so that levGetFileHash() doesn't have to read the file.
+void levSetFileHash(char const *realFileName, Sha256 const &hash);
 
 // free the currently loaded dataset
 bool levReleaseAll();
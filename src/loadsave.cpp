@@ -34,6 +34,7 @@
 #include "lib/framework/input.h"
 #include "lib/framework/stdio_ext.h"
 #include "lib/framework/wztime.h"
+#include "lib/framework/wzconfig.h"
 #include "lib/widget/button.h"
 #include "lib/widget/editbox.h"
 #include "lib/widget/widget.h"
@@ -161,6 +162,8 @@ bool addLoadSave(LOADSAVE_MODE savemode, const char *title)
 	char NewSaveGamePath[PATH_MAX] = {'\0'};
 	bLoadSaveMode = savemode;
 	savedTitle = title;
+
+	waitForDeferredSaveFiles();  // So that the last autosave is listed in full.
 	UDWORD			slotCount;
 
 	// Static as these are assigned to the widget buttons by reference
@@ -448,6 +451,7 @@ bool closeLoadSave()
 void deleteSaveGame(char *saveGameName)
 {
 	ASSERT(strlen(saveGameName) < MAX_STR_LENGTH, "deleteSaveGame; save game name too long");
+	waitForDeferredSaveFiles();
 
 	PHYSFS_delete(saveGameName);
 	saveGameName[strlen(saveGameName) - 4] = '\0'; // strip extension
@@ -915,13 +919,28 @@ bool autoSave()
 	std::string withoutTechlevel = mapNameWithoutTechlevel(getLevelName());
 	char savefile[PATH_MAX];
 	snprintf(savefile, sizeof(savefile), "%s/%s_%s.gam", dir, withoutTechlevel.c_str(), savedate);
-	if (saveGame(savefile, GTYPE_SAVE_MIDMISSION))
+	// saveGame() only takes a snapshot of the game, while the files are encoded and written in the background.
+	// Whether the files could be written is only known once they are, so the player is told then.
+	beginDeferredSaveFiles();
+	bool saved = saveGame(savefile, GTYPE_SAVE_MIDMISSION);
+	if (saved)
 	{
-		console("AutoSave %s", savefile);
+		std::string savefileName = savefile;
+		endDeferredSaveFiles([savefileName](bool written) {
+			if (written)
+			{
+				console("AutoSave %s", savefileName.c_str());
+			}
+			else
+			{
+				console("AutoSave %s failed", savefileName.c_str());
+			}
+		});
 		return true;
 	}
 	else
 	{
+		endDeferredSaveFiles();
 		console("AutoSave %s failed", savefile);
 		return false;
 	}
@@ -82,6 +82,7 @@
 #include "qtscript.h"
 #include "version.h"
 #include "notifications.h"
+#include "statehash.h"
 
 #include "warzoneconfig.h"
 
@@ -525,6 +526,7 @@ static void gameStateUpdate()
 	// Actually send pending droid orders.
 	sendQueuedDroidInfo();
 
+	updateGameStateHashes();
 	sendPlayerGameTime();
 	NETflush();  // Make sure the game time tick message is really sent over the network.
 
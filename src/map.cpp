@@ -128,6 +128,7 @@ static char *Tile_names = nullptr;
 #define ROCKIE 3
 
 static int *map;			// 3D array pointer that holds the texturetype
+static int numGroundTiles = 0;	// number of entries in map
 static bool *mapDecals;           // array that tells us what tile is a decal
 #define MAX_TERRAIN_TILES 0x0200  // max that we support (for now), see TILE_NUMMASK
 
@@ -404,6 +405,7 @@ static void SetGroundForTile(const char *filename, const char *nametype)
 	pFileData = strchr(pFileData, '\n') + 1;
 
 	map = (int *)malloc(sizeof(int) * numlines * 2 * 2);	// this is a 3D array map[numlines][2][2]
+	numGroundTiles = numlines;
 
 	for (i = 0; i < numlines; i++)
 	{
@@ -732,7 +734,7 @@ static void generateRiverbed()
 
 }
 
-static bool afterMapLoad();
+static bool afterMapLoad(bool useCache);
 
 /* Initialise the map structure */
 bool mapLoad(char const *filename, bool preview)
@@ -861,7 +863,7 @@ bool mapLoad(char const *filename, bool preview)
 		}
 	}
 
-	if (!afterMapLoad())
+	if (!afterMapLoad(true))
 	{
 		goto failure;
 	}
@@ -937,12 +939,121 @@ bool mapLoadFromScriptData(ScriptMapData const &data, bool preview)
 
 	// Skip gateways, not adding any.
 
-	return afterMapLoad();
+	// Generated maps are usually different every time, so not worth caching.
+	return afterMapLoad(false);
 }
 
-static bool afterMapLoad()
+#define MAP_CACHE_DIR "cache/maps"
+static const char mapCacheMagic[CACHE_FILE_MAGIC_SIZE] = {'W', 'Z', 'M', 'A', 'P', 'C', '0', '1'};
+
+/// What afterMapLoad() works out for each tile, which only depends on the map and the tileset.
+struct MapCacheTile
+{
+	uint8_t ground;
+	uint8_t decal;
+	int32_t height;              ///< With the riverbed.
+	uint16_t limitedContinent;
+	uint16_t hoverContinent;
+};
+
+/// Hash of everything afterMapLoad() works from, naming its cache file.
+static Sha256 mapCacheKey()
 {
-	if (!mapSetGroundTypes())
+	std::vector<uint8_t> data;
+	auto add = [&data](const void *bytes, size_t size) {
+		data.insert(data.end(), static_cast<const uint8_t *>(bytes), static_cast<const uint8_t *>(bytes) + size);
+	};
+	add(mapCacheMagic, sizeof(mapCacheMagic));
+	add(&mapWidth, sizeof(mapWidth));
+	add(&mapHeight, sizeof(mapHeight));
+	add(tilesetDir, strlen(tilesetDir) + 1);
+	add(terrainTypes, sizeof(terrainTypes));
+	add(map, sizeof(*map) * numGroundTiles * 2 * 2);
+	add(mapDecals, sizeof(*mapDecals) * MAX_TERRAIN_TILES);
+	data.reserve(data.size() + static_cast<size_t>(mapWidth) * mapHeight * (sizeof(uint16_t) + sizeof(int32_t)));
+	for (int i = 0; i < mapWidth * mapHeight; ++i)
+	{
+		add(&psMapTiles[i].texture, sizeof(psMapTiles[i].texture));
+		add(&psMapTiles[i].height, sizeof(psMapTiles[i].height));
+	}
+	return sha256Sum(data.data(), data.size());
+}
+
+static std::string mapCacheFile(const Sha256 &key)
+{
+	return MAP_CACHE_DIR "/" + key.toString() + ".bin";
+}
+
+/// The cache file holds the MapCacheTile of each tile.
+static bool readMapCacheFile(const Sha256 &key, std::vector<MapCacheTile> &tiles)
+{
+	std::vector<uint8_t> data;
+	if (!loadCacheFile(mapCacheFile(key).c_str(), mapCacheMagic, data) || data.size() != static_cast<size_t>(mapWidth) * mapHeight * sizeof(MapCacheTile))
+	{
+		return false;
+	}
+	tiles.resize(static_cast<size_t>(mapWidth) * mapHeight);
+	memcpy(tiles.data(), data.data(), data.size());
+	// Don't index with anything that wasn't worked out from this map. The riverbed only lowers water tiles, by less than
+	// WATER_MAX_DEPTH. Continents are only compared with each other, so any value will do.
+	for (size_t i = 0; i < tiles.size(); ++i)
+	{
+		MapCacheTile const &tile = tiles[i];
+		if (tile.ground >= numGroundTypes || tile.decal > 1 || tile.height > psMapTiles[i].height || tile.height < psMapTiles[i].height - WATER_MAX_DEPTH)
+		{
+			debug(LOG_WARNING, "Ignoring map cache file %s, tile %zu is not from this map", mapCacheFile(key).c_str(), i);
+			tiles.clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+static void writeMapCacheFile(const Sha256 &key)
+{
+	std::vector<MapCacheTile> tiles(static_cast<size_t>(mapWidth) * mapHeight);
+	for (size_t i = 0; i < tiles.size(); ++i)
+	{
+		memset(&tiles[i], 0, sizeof(tiles[i]));  // No uninitialised padding in the file.
+		tiles[i].ground = psMapTiles[i].ground;
+		tiles[i].decal = TILE_HAS_DECAL(&psMapTiles[i]) ? 1 : 0;
+		tiles[i].height = psMapTiles[i].height;
+		tiles[i].limitedContinent = psMapTiles[i].limitedContinent;
+		tiles[i].hoverContinent = psMapTiles[i].hoverContinent;
+	}
+	saveCacheFile(mapCacheFile(key).c_str(), mapCacheMagic, tiles.data(), tiles.size() * sizeof(MapCacheTile));
+}
+
+static bool afterMapLoad(bool useCache)
+{
+	// Ground types, riverbeds and continents take a while on big maps, and only depend on the map and tileset, so they are
+	// kept in a cache file, for playing the same map again.
+	Sha256 cacheKey;
+	std::vector<MapCacheTile> cachedTiles;
+	bool cached = false;
+	if (useCache)
+	{
+		cacheKey = mapCacheKey();
+		cached = readMapCacheFile(cacheKey, cachedTiles);
+		debug(LOG_MAP, "Map cache %s: %s", cacheKey.toString().c_str(), cached ? "found" : "not found");
+	}
+
+	if (cached)
+	{
+		for (size_t i = 0; i < cachedTiles.size(); ++i)
+		{
+			psMapTiles[i].ground = cachedTiles[i].ground;
+			if (cachedTiles[i].decal)
+			{
+				SET_TILE_DECAL(&psMapTiles[i]);
+			}
+			else
+			{
+				CLEAR_TILE_DECAL(&psMapTiles[i]);
+			}
+		}
+	}
+	else if (!mapSetGroundTypes())
 	{
 		return false;
 	}
@@ -955,7 +1066,17 @@ static bool afterMapLoad()
 			mapTile(x, y)->waterLevel = mapTile(x, y)->height - world_coord(1) / 3;
 		}
 	}
-	generateRiverbed();
+	if (cached)
+	{
+		for (size_t i = 0; i < cachedTiles.size(); ++i)
+		{
+			psMapTiles[i].height = cachedTiles[i].height;
+		}
+	}
+	else
+	{
+		generateRiverbed();
+	}
 
 	/* set up the scroll mins and maxs - set values to valid ones for any new map */
 	scrollMinX = scrollMinY = 0;
@@ -1003,8 +1124,23 @@ static bool afterMapLoad()
 		}
 	}
 
-	/* Set continents. This should ideally be done in advance by the map editor. */
-	mapFloodFillContinents();
+	if (cached)
+	{
+		for (size_t i = 0; i < cachedTiles.size(); ++i)
+		{
+			psMapTiles[i].limitedContinent = cachedTiles[i].limitedContinent;
+			psMapTiles[i].hoverContinent = cachedTiles[i].hoverContinent;
+		}
+	}
+	else
+	{
+		/* Set continents. This should ideally be done in advance by the map editor. */
+		mapFloodFillContinents();
+		if (useCache)
+		{
+			writeMapCacheFile(cacheKey);
+		}
+	}
 
 	return true;
 }
@@ -1142,6 +1278,7 @@ bool mapShutdown()
 	}
 
 	map = nullptr;
+	numGroundTiles = 0;
 	floodbucket = nullptr;
 	psGroundTypes = nullptr;
 	mapDecals = nullptr;
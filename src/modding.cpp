@@ -103,27 +103,31 @@ static WzString convertToPlatformDependentPath(const char *platformIndependentPa
 	return path;
 }
 
+#define SUBDIR_PROBE_MOUNTPOINT "wzsubdirprobe"
+
 /*!
- * Tries to mount a list of directories, found in /basedir/subdir/<list>.
+ * Lists the directories and archives found in /basedir/subdir/<list>, for mounting.
  * \param basedir Base directory (in platform-dependent notation)
  * \param subdir A subdirectory of basedir (in platform-independent notation - i.e. with "/" as the path separator)
- * \param appendToPath Whether to append or prepend
  * \param checkList List of directories to check. NULL means any.
+ * \return The paths to mount, in platform-dependent notation
  */
-void addSubdirs(const char *basedir, const char *subdir, const bool appendToPath, std::vector<std::string> const *checkList, bool addToModList)
+std::vector<std::string> findSubdirs(const char *basedir, const char *subdir, std::vector<std::string> const *checkList, bool addToModList)
 {
+	std::vector<std::string> subdirs;
 	const WzString subdir_platformDependent = convertToPlatformDependentPath(subdir);
-	WZ_PHYSFS_enumerateFiles(subdir, [&](const char *i) -> bool {
+	std::string dir = astringf("%s%s", basedir, subdir_platformDependent.toUtf8().c_str());
+	// Mount basedir/subdir on its own, so that only its own entries are found, whatever else is on the search path.
+	if (!PHYSFS_mount(dir.c_str(), SUBDIR_PROBE_MOUNTPOINT, PHYSFS_APPEND))
+	{
+		return subdirs;  // No such directory.
+	}
+	WZ_PHYSFS_enumerateFiles(SUBDIR_PROBE_MOUNTPOINT, [&](const char *i) -> bool {
 #ifdef DEBUG
 		debug(LOG_NEVER, "Examining subdir: [%s]", i);
 #endif // DEBUG
 		if (i[0] != '.' && (!checkList || std::find(checkList->begin(), checkList->end(), i) != checkList->end()))
 		{
-			char tmpstr[PATH_MAX];
-			snprintf(tmpstr, sizeof(tmpstr), "%s%s%s%s", basedir, subdir_platformDependent.toUtf8().c_str(), PHYSFS_getDirSeparator(), i);
-#ifdef DEBUG
-			debug(LOG_NEVER, "Adding [%s] to search path", tmpstr);
-#endif // DEBUG
 			if (addToModList)
 			{
 				std::string filename = astringf("%s/%s", subdir, i); // platform-independent notation
@@ -132,34 +136,12 @@ void addSubdirs(const char *basedir, const char *subdir, const bool appendToPath
 				snprintf(buf, sizeof(buf), "mod: %s", i);
 				addDumpInfo(buf);
 			}
-			PHYSFS_mount(tmpstr, NULL, appendToPath); // platform-dependent notation
-		}
-		return true; // continue
-	});
-}
-
-void removeSubdirs(const char *basedir, const char *subdir)
-{
-	ASSERT(basedir, "basedir is null");
-	ASSERT(subdir, "subdir is null");
-	const WzString subdir_platformDependent = convertToPlatformDependentPath(subdir);
-	char tmpstr[PATH_MAX];
-	WZ_PHYSFS_enumerateFiles(subdir, [&](const char *i) -> bool {
-#ifdef DEBUG
-		debug(LOG_NEVER, "Examining subdir: [%s]", i);
-#endif // DEBUG
-		snprintf(tmpstr, sizeof(tmpstr), "%s%s%s%s", basedir, subdir_platformDependent.toUtf8().c_str(), PHYSFS_getDirSeparator(), i);
-#ifdef DEBUG
-		debug(LOG_NEVER, "Removing [%s] from search path", tmpstr);
-#endif // DEBUG
-		if (!WZ_PHYSFS_unmount(tmpstr)) // platform-dependent notation
-		{
-#ifdef DEBUG	// spams a ton!
-			debug(LOG_NEVER, "Couldn't remove %s from search path because %s", tmpstr, WZ_PHYSFS_getLastError());
-#endif // DEBUG
+			subdirs.push_back(dir + PHYSFS_getDirSeparator() + i);
 		}
 		return true; // continue
 	});
+	WZ_PHYSFS_unmount(dir.c_str());
+	return subdirs;
 }
 
 void printSearchPath()
@@ -189,7 +171,7 @@ void clearOverrideMods()
 
 static void addLoadedMod(std::string modname, std::string filename)
 {
-	// Note, findHashOfFile won't work right now, since the search paths aren't set up until after all calls to addSubdirs, see rebuildSearchPath in init.cpp.
+	// Note, findHashOfFile won't work right now, since the search paths aren't set up until after all calls to findSubdirs, see rebuildSearchPath in init.cpp.
 	loaded_mods.push_back({std::move(modname), std::move(filename)});
 }
 
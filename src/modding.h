@@ -27,8 +27,7 @@
 #include <vector>
 
 
-void addSubdirs(const char *basedir, const char *subdir, const bool appendToPath, std::vector<std::string> const *checkList, bool addToModList);
-void removeSubdirs(const char *basedir, const char *subdir);
+std::vector<std::string> findSubdirs(const char *basedir, const char *subdir, std::vector<std::string> const *checkList, bool addToModList);
 void printSearchPath();
 
 void setOverrideMods(char *modlist);
@@ -2792,7 +2792,7 @@ static void stopJoining(std::shared_ptr<WzTitleUI> parent)
 		// if we were in a midle of transferring a file, then close the file handle
 		for (auto const &file : NetPlay.wzFiles)
 		{
-			debug(LOG_NET, "closing aborted file");		// no need to delete it, we do size check on (map) file
+			debug(LOG_NET, "closing aborted file");		// no need to delete it, it stays incomplete, and will be resumed next time
 			PHYSFS_close(file.handle);
 		}
 		NetPlay.wzFiles.clear();
@@ -3884,10 +3884,22 @@ void WzMultiplayerOptionsTitleUI::frontendMultiMessages(bool running)
 
 				debug(LOG_WARNING, "Received file cancel request from player %u, they weren't expecting the file.", queue.index);
 				auto &wzFiles = NetPlay.players[queue.index].wzFiles;
+				for (auto const &file : wzFiles)
+				{
+					if (file.hash == hash && file.handle != nullptr)
+					{
+						PHYSFS_close(file.handle);
+					}
+				}
 				wzFiles.erase(std::remove_if(wzFiles.begin(), wzFiles.end(), [&](WZFile const &file) { return file.hash == hash; }), wzFiles.end());
 			}
 			break;
 
+		case NET_FILE_ACK:
+			ASSERT_HOST_ONLY(break);
+			NETrecvFileAck(queue);
+			break;
+
 		case NET_OPTIONS:					// incoming options file.
 			recvOptions(queue);
 			ingame.localOptionsReceived = true;
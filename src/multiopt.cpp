@@ -235,18 +235,25 @@ void recvOptions(NETQUEUE queue)
 			return false;  // Have the file already.
 		}
 
-		PHYSFS_file *pFileHandle = PHYSFS_openWrite(filename);
+		// Resume an earlier, interrupted download of the same file, if there is one. Files are named by their hash, so
+		// the partial file is known to belong to this download. If its data is bad, the hash check at the end will catch it.
+		uint32_t resumePos = 0;
+		PHYSFS_file *pFileHandle = NETopenPartialFile(filename, true, &resumePos);
 		if (pFileHandle == nullptr)
 		{
-			debug(LOG_ERROR, "Failed to open %s for writing: %s", filename, WZ_PHYSFS_getLastError());
 			return false;
 		}
+		if (resumePos > 0)
+		{
+			debug(LOG_INFO, "Resuming download of %s at %u bytes", filename, resumePos);
+		}
 
-		NetPlay.wzFiles.emplace_back(pFileHandle, filename, hash);
+		NetPlay.wzFiles.emplace_back(pFileHandle, filename, hash, 0, resumePos);
 
 		// Request the map/mod from the host
 		NETbeginEncode(NETnetQueue(NET_HOST_ONLY), NET_FILE_REQUESTED);
 		NETbin(hash.bytes, hash.Bytes);
+		NETuint32_t(&resumePos);
 		NETend();
 
 		haveData = false;
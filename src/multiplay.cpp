@@ -1346,8 +1346,10 @@ bool recvMapFileRequested(NETQUEUE queue)
 
 	Sha256 hash;
 	hash.setZero();
+	uint32_t resumePos = 0;
 	NETbeginDecode(queue, NET_FILE_REQUESTED);
 	NETbin(hash.bytes, hash.Bytes);
+	NETuint32_t(&resumePos);  // Size of the incomplete file the player already has, if any.
 	NETend();
 
 	auto &files = NetPlay.players[player].wzFiles;
@@ -1400,53 +1402,54 @@ bool recvMapFileRequested(NETQUEUE queue)
 	uint32_t fileSize_u32 = (uint32_t)fileSize_64;
 	ASSERT_OR_RETURN(false, fileSize_u32 <= MAX_NET_TRANSFERRABLE_FILE_SIZE, "Filesize is too large; (size: %" PRIu32")", fileSize_u32);
 
+	// The first chunk tells the client where we actually start, so it can start its partial file over if we don't resume.
+	resumePos = NETseekFileStart(pFileHandle, fileSize_u32, resumePos);
+
 	// Schedule file to be sent.
-	debug(LOG_INFO, "File is valid, sending [directory: %s] %s to client %u", WZ_PHYSFS_getRealDir_String(filename.c_str()).c_str(), filename.c_str(), player);
-	files.emplace_back(pFileHandle, filename, hash, fileSize_u32);
+	debug(LOG_INFO, "File is valid, sending [directory: %s] %s to client %u, starting at %u", WZ_PHYSFS_getRealDir_String(filename.c_str()).c_str(), filename.c_str(), player, resumePos);
+	files.emplace_back(pFileHandle, filename, hash, fileSize_u32, resumePos);
 
 	return true;
 }
 
 // Continue sending maps and mods.
+// All files requested by a player are sent at once, each limited by its own transfer window, see NETsendFile().
 void sendMap()
 {
 	// maximum "budget" in time per call to sendMap
 	// (at 60fps, total frame budget is ~16ms - allocate 4ms max for each call to sendMap)
 	const uint64_t maxMicroSecondsPerSendMapCall = (4 * 1000);
 
-	// calculate the time budget per file
-	uint64_t totalFilesToSend = 0;
-	for (int i = 0; i < MAX_PLAYERS; ++i)
+	using microDuration = std::chrono::duration<uint64_t, std::micro>;
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	// Round-robin over all files of all players, one chunk each, until every window is full or we run out of time.
+	bool sentAny = true;
+	while (sentAny && std::chrono::duration_cast<microDuration>(std::chrono::high_resolution_clock::now() - startTime).count() < maxMicroSecondsPerSendMapCall)
 	{
-		totalFilesToSend += NetPlay.players[i].wzFiles.size();
+		sentAny = false;
+		for (int i = 0; i < MAX_PLAYERS; ++i)
+		{
+			for (auto &file : NetPlay.players[i].wzFiles)
+			{
+				sentAny = NETsendFile(file, i) || sentAny;
+			}
+		}
 	}
-	const uint64_t maxMicroSecondsPerFile = maxMicroSecondsPerSendMapCall / std::max((uint64_t)1, totalFilesToSend);
-
-	using microDuration = std::chrono::duration<uint64_t, std::micro>;
-	auto file_startTime = std::chrono::high_resolution_clock::now();
-	microDuration file_currentDuration;
 
 	for (int i = 0; i < MAX_PLAYERS; ++i)
 	{
 		auto &files = NetPlay.players[i].wzFiles;
-		for (auto &file : files)
+		for (auto const &file : files)
 		{
-			int done = 0;
-			file_startTime = std::chrono::high_resolution_clock::now();
-			do
-			{
-				done = NETsendFile(file, i);
-				file_currentDuration = std::chrono::duration_cast<microDuration>(std::chrono::high_resolution_clock::now() - file_startTime);
-			}
-			while (done < 100 && (file_currentDuration.count() < maxMicroSecondsPerFile));
-			if (done == 100)
+			if (NETfileSent(file))
 			{
 				netPlayersUpdated = true;  // Remove download icon from player.
 				addConsoleMessage(_("FILE SENT!"), DEFAULT_JUSTIFY, SYSTEM_MESSAGE);
 				debug(LOG_INFO, "=== File has been sent to player %d ===", i);
 			}
 		}
-		files.erase(std::remove_if(files.begin(), files.end(), [](WZFile const &file) { return file.handle == nullptr; }), files.end());
+		files.erase(std::remove_if(files.begin(), files.end(), NETfileSent), files.end());
 	}
 }
 
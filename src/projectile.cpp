@@ -1440,26 +1440,6 @@ bool proj_Direct(const WEAPON_STATS *psStats)
 	return false; // just to satisfy compiler
 }
 
-/***************************************************************************/
-
-// return the maximum range for a weapon
-int proj_GetLongRange(const WEAPON_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].maxRange;
-}
-
-// return the minimum range for a weapon
-int proj_GetMinRange(const WEAPON_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].minRange;
-}
-
-// return the short range for a weapon
-int proj_GetShortRange(const WEAPON_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].shortRange;
-}
-
 /***************************************************************************/
 ObjectShape establishTargetShape(BASE_OBJECT *psTarget)
 {
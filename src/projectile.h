@@ -22,6 +22,7 @@
 #define __INCLUDED_SRC_PROJECTILE_H__
 
 #include "projectiledef.h"
+#include "statsdef.h"
 #include "weapondef.h"
 #include <glm/fwd.hpp>
 
@@ -73,13 +74,22 @@ bool proj_SendProjectileAngled(WEAPON *psWeap, SIMPLE_OBJECT *psAttacker, int pl
 bool proj_Direct(const WEAPON_STATS *psStats);
 
 /** Return the maximum range for a weapon. */
-int proj_GetLongRange(const WEAPON_STATS *psStats, int player);
+static inline int proj_GetLongRange(const WEAPON_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].maxRange;
+}
 
 /** Return the minimum range for a weapon. */
-int proj_GetMinRange(const WEAPON_STATS *psStats, int player);
+static inline int proj_GetMinRange(const WEAPON_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].minRange;
+}
 
 /** Return the short range for a weapon. */
-int proj_GetShortRange(const WEAPON_STATS *psStats, int player);
+static inline int proj_GetShortRange(const WEAPON_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].shortRange;
+}
 
 UDWORD calcDamage(UDWORD baseDamage, WEAPON_EFFECT weaponEffect, BASE_OBJECT *psTarget);
 bool gfxVisible(PROJECTILE *psObj);
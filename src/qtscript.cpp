@@ -64,6 +64,7 @@
 #include "qtscript.h"
 
 #include "lib/framework/file.h"
+#include "lib/framework/math_ext.h"
 #include "lib/gamelib/gtime.h"
 #include "lib/netplay/netplay.h"
 #include "multiplay.h"
@@ -78,6 +79,7 @@
 #include "game.h"
 #include "warzoneconfig.h"
 
+#include <atomic>
 #include <set>
 #include <memory>
 #include <utility>
@@ -203,6 +205,7 @@ void scripting_engine::timerNode::swap(timerNode& _rhs)
 	std::swap(player, _rhs.player);
 	std::swap(calls, _rhs.calls);
 	std::swap(type, _rhs.type);
+	std::swap(order, _rhs.order);
 }
 
 scripting_engine::area_by_values_or_area_label_lookup::area_by_values_or_area_label_lookup() { }
@@ -238,6 +241,19 @@ uniqueTimerID scripting_engine::setTimer(wzapi::scripting_instance *caller, cons
 	}
 	node->type = type;
 	node->timerID = newTimerID;
+	if (type == TIMER_REPEAT && caller->isAIScript())
+	{
+		// AIs tend to set up the same timers at the same time, so spread timers of different players over the ticks of the period,
+		// rather than having them all run on the same tick. This only depends on the player, so is the same for everyone. Global
+		// scripts run for selectedPlayer, which differs between clients, so aren't offset.
+		int periodUpdates = milliseconds / GAME_TICKS_PER_UPDATE;
+		if (periodUpdates > 1)
+		{
+			node->frameTime += std::max(player, 0) % periodUpdates * GAME_TICKS_PER_UPDATE;
+		}
+	}
+	node->order = nextTimerOrder++;
+	scheduleTimer(node);
 	auto inserted_iter = timers.emplace(timers.end(), std::move(node));
 	timerIDMap[newTimerID] = inserted_iter;
 	return newTimerID;
@@ -247,10 +263,34 @@ uniqueTimerID scripting_engine::setTimer(wzapi::scripting_instance *caller, cons
 void scripting_engine::addTimerNode(std::shared_ptr<scripting_engine::timerNode>&& node)
 {
 	ASSERT(timerIDMap.count(node->timerID) == 0, "Duplicate timerID found: %s", WzString::number(node->timerID).toUtf8().c_str());
+	node->order = nextTimerOrder++;
+	if (node->type == TIMER_ONESHOT_DONE)
+	{
+		finishedOneShotTimers.push_back(node->timerID);
+	}
+	else
+	{
+		scheduleTimer(node);
+	}
 	auto inserted_iter = timers.emplace(timers.end(), std::move(node));
 	timerIDMap[(*inserted_iter)->timerID] = inserted_iter;
 }
 
+void scripting_engine::scheduleTimer(const std::shared_ptr<timerNode>& node)
+{
+	// Removed timers leave their entries behind, so drop those once they are most of the queue.
+	if (timerQueue.size() > 2 * timers.size() + 64)
+	{
+		timerQueue.erase(std::remove_if(timerQueue.begin(), timerQueue.end(), [](const timerQueueEntry &entry) {
+			std::shared_ptr<timerNode> queued = entry.node.lock();
+			return !queued || queued->type == TIMER_REMOVED || queued->frameTime != entry.frameTime;
+		}), timerQueue.end());
+		std::make_heap(timerQueue.begin(), timerQueue.end(), std::greater<timerQueueEntry>());
+	}
+	timerQueue.push_back(timerQueueEntry{node->frameTime, node->order, node});
+	std::push_heap(timerQueue.begin(), timerQueue.end(), std::greater<timerQueueEntry>());
+}
+
 /// Scripting engine (what others call the scripting context, but QtScript's nomenclature is different).
 static std::vector<wzapi::scripting_instance *> scripts;
 
@@ -384,6 +424,7 @@ void scriptRemoveObject(const BASE_OBJECT *psObj)
 		return (node.baseobj == psObj->id);
 	});
 	scripting_engine::instance().groupRemoveObject(psObj);
+	snapshotQuickJSObject(psObj);
 }
 
 // do not want to call this 'init', since scripts are often loaded before we get here
@@ -416,6 +457,7 @@ bool shutdownScripts()
 
 bool scripting_engine::shutdownScripts()
 {
+	stopScriptWorkers();
 	scriptsReady = false;
 	jsDebugShutdown();
 	globalDialog = false;
@@ -426,13 +468,14 @@ bool scripting_engine::shutdownScripts()
 		MONITOR *monitor = monitors.at(instance);
 		WzString scriptName = WzString::fromUtf8(instance->scriptName());
 		instance->dumpScriptLog("=== PERFORMANCE DATA ===\n");
-		instance->dumpScriptLog("    calls | avg (usec) | worst (usec) | worst call at | >=limit | >=limit/2 | function\n");
+		instance->dumpScriptLog("    calls | total (msec) | avg (usec) | worst (usec) | worst call at | >=limit | >=limit/2 | function\n");
 		for (MONITOR::const_iterator iter = monitor->begin(); iter != monitor->end(); ++iter)
 		{
 			const std::string &function = iter->first;
 			MONITOR_BIN m = iter->second;
 			std::ostringstream info;
 			info << std::right << std::setw(9) << m.calls << " | ";
+			info << std::right << std::setw(12) << (m.time / 1000) << " | ";
 			info << std::right << std::setw(10) << (m.time / m.calls) << " | ";
 			info << std::right << std::setw(12) << m.worst << " | ";
 			info << std::right << std::setw(13) << m.worstGameTime << " | ";
@@ -443,11 +486,19 @@ bool scripting_engine::shutdownScripts()
 		}
 		monitor->clear();
 		delete monitor;
+		if (scriptProfilerEnabled())
+		{
+			scriptProfilerReport(instance);
+		}
 		unregisterFunctions(instance);
 	}
+	scriptProfilerWriteStacks();
 	timers.clear();
 	lastTimerID = 0;
 	timerIDMap.clear();
+	timerQueue.clear();
+	nextTimerOrder = 0;
+	finishedOneShotTimers.clear();
 	monitors.clear();
 	for (auto& script : scripts)
 	{
@@ -462,6 +513,31 @@ bool updateScripts()
 	return scripting_engine::instance().updateScripts();
 }
 
+/// With a "scriptGCBudget", instances collect their garbage here, once the timers have run, instead of whenever they allocate.
+static void collectScriptGarbage()
+{
+	static size_t nextInstance = 0;
+	const int budget = war_getScriptGCBudget();
+	if (budget <= 0)
+	{
+		return;
+	}
+	auto begin = std::chrono::steady_clock::now();
+	// Take turns, so that an instance with a big heap doesn't keep the others from ever collecting.
+	for (size_t checked = 0; checked < scripts.size(); ++checked)
+	{
+		wzapi::scripting_instance *instance = scripts[nextInstance++ % scripts.size()];
+		if (instance->needsGarbageCollection())
+		{
+			instance->collectGarbage();
+			if (std::chrono::steady_clock::now() - begin >= std::chrono::microseconds(budget))
+			{
+				break;
+			}
+		}
+	}
+}
+
 bool scripting_engine::updateScripts()
 {
 	// Call delayed triggers here
@@ -480,27 +556,68 @@ bool scripting_engine::updateScripts()
 		instance->updateGameTime(gameTime);
 	}
 	// Weed out dead timers
-	removeTimersIf([](const timerNode& node)
+	for (uniqueTimerID timerID : finishedOneShotTimers)
 	{
-		return (node.type == TIMER_ONESHOT_DONE);
-	});
+		auto it = timerIDMap.find(timerID);
+		if (it != timerIDMap.end() && (*it->second)->type == TIMER_ONESHOT_DONE)
+		{
+			removeTimer(timerID);
+		}
+	}
+	finishedOneShotTimers.clear();
 	// Check for timers, and run them if applicable.
-	// TODO - load balancing
 	std::vector<std::shared_ptr<timerNode>> runlist; // make a new list here, since we might trample all over the timer list during execution
-	for (auto &node : timers)
+	while (!timerQueue.empty() && timerQueue.front().frameTime <= (int)gameTime)
 	{
-		if (node->frameTime <= gameTime)
+		timerQueueEntry entry = timerQueue.front();
+		std::pop_heap(timerQueue.begin(), timerQueue.end(), std::greater<timerQueueEntry>());
+		timerQueue.pop_back();
+		std::shared_ptr<timerNode> node = entry.node.lock();
+		if (!node || node->type == TIMER_REMOVED || node->frameTime != entry.frameTime)
 		{
-			node->frameTime = node->ms + gameTime;	// update for next invokation
-			if (node->type == TIMER_ONESHOT_READY)
-			{
-				node->type = TIMER_ONESHOT_DONE; // unless there is none
-			}
-			node->calls++;
-			runlist.push_back(node);
+			continue;  // Stale entry.
 		}
+		runlist.push_back(node);
+	}
+	// Run in the order the timers were added, regardless of how overdue they are.
+	std::sort(runlist.begin(), runlist.end(), [](const std::shared_ptr<timerNode> &a, const std::shared_ptr<timerNode> &b) { return a->order < b->order; });
+	for (auto &node : runlist)
+	{
+		node->frameTime = node->ms + gameTime;	// update for next invokation
+		if (node->type == TIMER_ONESHOT_READY)
+		{
+			node->type = TIMER_ONESHOT_DONE; // unless there is none
+			finishedOneShotTimers.push_back(node->timerID);
+		}
+		else
+		{
+			scheduleTimer(node);
+		}
+		node->calls++;
 	}
 
+	if (war_getConcurrentScripts())
+	{
+		runTimersConcurrently(runlist);
+	}
+	else
+	{
+		runTimers(runlist);
+	}
+
+	collectScriptGarbage();
+
+	if (globalDialog && doUpdateModels)
+	{
+		updateGlobalModels();
+		doUpdateModels = false;
+	}
+
+	return true;
+}
+
+void scripting_engine::runTimers(const std::vector<std::shared_ptr<timerNode>> &runlist)
+{
 	for (auto &node : runlist)
 	{
 		// IMPORTANT: A queued function can delete a timer that is in the runlist!
@@ -511,14 +628,169 @@ bool scripting_engine::updateScripts()
 		}
 		node->function(node->timerID, IdToObject(node->baseobjtype, node->baseobj, node->player), node->additionalTimerFuncParam.get());
 	}
+}
 
-	if (globalDialog && doUpdateModels)
+/// Runs the timers of the AI instances which support it on worker threads, concurrently, after running the timers of
+/// the other instances as usual. The concurrent instances queue their changes to the game state, which are then
+/// made in player order, so the outcome doesn't depend on which instance finished first. Calls which can't be queued
+/// fail instead, see wzapi::scripting_instance::setMayRunConcurrently().
+void scripting_engine::runTimersConcurrently(const std::vector<std::shared_ptr<timerNode>> &runlist)
+{
+	struct InstanceTimers
 	{
-		updateGlobalModels();
-		doUpdateModels = false;
+		wzapi::scripting_instance *instance;
+		std::vector<std::shared_ptr<timerNode>> timers;
+	};
+	std::vector<InstanceTimers> concurrentTimers;
+	std::vector<std::shared_ptr<timerNode>> mainThreadTimers;
+	for (auto &node : runlist)
+	{
+		if (!node->instance->supportsConcurrentExecution() || !node->instance->mayRunConcurrently())
+		{
+			mainThreadTimers.push_back(node);
+			continue;
+		}
+		auto it = std::find_if(concurrentTimers.begin(), concurrentTimers.end(), [&node](InstanceTimers const &t) { return t.instance == node->instance; });
+		if (it == concurrentTimers.end())
+		{
+			concurrentTimers.push_back(InstanceTimers{node->instance, {}});
+			it = concurrentTimers.end() - 1;
+		}
+		it->timers.push_back(node);
+	}
+	if (concurrentTimers.size() < 2)
+	{
+		runTimers(runlist);  // Nothing to gain.
+		return;
 	}
+	runTimers(mainThreadTimers);
+	std::stable_sort(concurrentTimers.begin(), concurrentTimers.end(), [](InstanceTimers const &a, InstanceTimers const &b) { return a.instance->player() < b.instance->player(); });
 
-	return true;
+	for (auto &t : concurrentTimers)
+	{
+		t.instance->setRunningConcurrently(true);
+	}
+	std::atomic<size_t> next(0);
+	scriptWork = [this, &concurrentTimers, &next]() {
+		size_t i;
+		while ((i = next++) < concurrentTimers.size())
+		{
+			GameStateLock lock(concurrentTimers[i].instance);
+			concurrentTimers[i].instance->beginConcurrentExecution();
+			runTimers(concurrentTimers[i].timers);
+		}
+	};
+	size_t numWorkers = std::min<size_t>(concurrentTimers.size(), wzGetCPUCount()) - 1;
+	startScriptWorkers(numWorkers);
+	for (size_t i = 0; i < numWorkers; ++i)
+	{
+		wzSemaphorePost(scriptWorkSemaphore);
+	}
+	scriptWork();  // The main thread would only be waiting otherwise.
+	for (size_t i = 0; i < numWorkers; ++i)
+	{
+		wzSemaphoreWait(scriptWorkDoneSemaphore);
+	}
+	scriptWork = nullptr;
+
+	for (auto &t : concurrentTimers)
+	{
+		t.instance->setRunningConcurrently(false);
+	}
+	for (auto &t : concurrentTimers)
+	{
+		t.instance->endConcurrentExecution();
+	}
+}
+
+// This function runs in a separate thread!
+int scripting_engine::scriptWorkerThreadFunc(void *data)
+{
+	scripting_engine *engine = static_cast<scripting_engine *>(data);
+	while (true)
+	{
+		wzSemaphoreWait(engine->scriptWorkSemaphore);  // Go to sleep until needed.
+		if (!engine->scriptWork)
+		{
+			return 0;
+		}
+		engine->scriptWork();
+		wzSemaphorePost(engine->scriptWorkDoneSemaphore);
+	}
+}
+
+void scripting_engine::startScriptWorkers(size_t count)
+{
+	if (!scriptWorkSemaphore)
+	{
+		scriptWorkSemaphore = wzSemaphoreCreate(0);
+		scriptWorkDoneSemaphore = wzSemaphoreCreate(0);
+	}
+	while (scriptWorkers.size() < count)
+	{
+		WZ_THREAD *thread = wzThreadCreate(scriptWorkerThreadFunc, this);
+		wzThreadStart(thread);
+		scriptWorkers.push_back(thread);
+	}
+}
+
+void scripting_engine::stopScriptWorkers()
+{
+	scriptWork = nullptr;
+	for (size_t i = 0; i < scriptWorkers.size(); ++i)
+	{
+		wzSemaphorePost(scriptWorkSemaphore);
+	}
+	for (auto *thread : scriptWorkers)
+	{
+		wzThreadJoin(thread);
+	}
+	scriptWorkers.clear();
+	if (scriptWorkSemaphore)
+	{
+		wzSemaphoreDestroy(scriptWorkSemaphore);
+		wzSemaphoreDestroy(scriptWorkDoneSemaphore);
+		scriptWorkSemaphore = nullptr;
+		scriptWorkDoneSemaphore = nullptr;
+	}
+}
+
+scripting_engine::GameStateLock::GameStateLock(wzapi::scripting_instance *instance_)
+	: instance(instance_->isRunningConcurrently() && !instance_->holdsGameStateLock() ? instance_ : nullptr)
+{
+	if (instance)
+	{
+		scripting_engine::instance().gameStateMutex.lock();
+		instance->setHoldsGameStateLock(true);
+	}
+}
+
+scripting_engine::GameStateLock::~GameStateLock()
+{
+	if (instance)
+	{
+		instance->setHoldsGameStateLock(false);
+		scripting_engine::instance().gameStateMutex.unlock();
+	}
+}
+
+scripting_engine::GameStateUnlock::GameStateUnlock(wzapi::scripting_instance *instance_)
+	: instance(instance_->holdsGameStateLock() ? instance_ : nullptr)
+{
+	if (instance)
+	{
+		instance->setHoldsGameStateLock(false);
+		scripting_engine::instance().gameStateMutex.unlock();
+	}
+}
+
+scripting_engine::GameStateUnlock::~GameStateUnlock()
+{
+	if (instance)
+	{
+		scripting_engine::instance().gameStateMutex.lock();
+		instance->setHoldsGameStateLock(true);
+	}
 }
 
 uint32_t ScriptMapData::crcSumStructures(uint32_t crc) const
@@ -611,6 +883,10 @@ wzapi::scripting_instance* scripting_engine::loadPlayerScript(const WzString& pa
 		return nullptr;
 	}
 
+	pNewInstance->setIsAIScript(difficulty != AIDifficulty::DISABLED);
+	// Scripts which run on every client, including the scavengers', must run their timers in the same order everywhere.
+	pNewInstance->setMayRunConcurrently(game.type == LEVEL_TYPE::SKIRMISH && difficulty != AIDifficulty::DISABLED && player != scavengerPlayer());
+
 	// Create group map
 	GROUPMAP *psMap = new GROUPMAP;
 	auto insert_result = groups.insert(ENGINEMAP::value_type(pNewInstance, psMap));
@@ -746,7 +1022,7 @@ bool saveScriptStates(const char *filename)
 
 bool scripting_engine::saveScriptStates(const char *filename)
 {
-	WzConfig ini(filename, WzConfig::ReadAndWrite);
+	nlohmann::json states = nlohmann::json::object();
 	for (int i = 0; i < scripts.size(); ++i)
 	{
 		wzapi::scripting_instance* instance = scripts.at(i);
@@ -756,14 +1032,14 @@ bool scripting_engine::saveScriptStates(const char *filename)
 		// 'scriptName' and 'me' should be saved implicitly by the backend's saveScriptGlobals
 		ASSERT(globalsResult.contains("me"), "Missing required global \"me\"");
 		ASSERT(globalsResult.contains("scriptName"), "Missing required global \"scriptName\"");
-		ini.setValue("globals_" + WzString::number(i), globalsResult);
+		states["globals_" + std::to_string(i)] = std::move(globalsResult);
 
 		// we have to save 'scriptName' and 'me' explicitly
 		nlohmann::json groupsResult = nlohmann::json::object();
 		saveGroups(groupsResult, instance);
 		groupsResult["me"] = instance->player();
 		groupsResult["scriptName"] = instance->scriptName();
-		ini.setValue("groups_" + WzString::number(i), groupsResult);
+		states["groups_" + std::to_string(i)] = std::move(groupsResult);
 	}
 	size_t timerIdx = 0;
 	for (const auto& node : timers)
@@ -785,10 +1061,12 @@ bool scripting_engine::saveScriptStates(const char *filename)
 		nodeInfo["calls"] = node->calls;
 		nodeInfo["type"] = (int)node->type;
 
-		ini.setValue("triggers_" + WzString::number(timerIdx), nodeInfo);
+		states["triggers_" + std::to_string(timerIdx)] = std::move(nodeInfo);
 		++timerIdx;
 	}
-	return true;
+
+	// In the same format as the other save files. Autosaves encode and write it in a worker thread, see beginDeferredSaveFiles().
+	return saveJsonFile(filename, std::move(states), war_getBinarySaves());
 }
 
 wzapi::scripting_instance* scripting_engine::findInstanceForPlayer(int match, const WzString& _scriptName)
@@ -816,65 +1094,87 @@ bool loadScriptStates(const char *filename)
 bool scripting_engine::loadScriptStates(const char *filename)
 {
 	uniqueTimerID maxRestoredTimerID = 0;
-	WzConfig ini(filename, WzConfig::ReadOnly);
-	std::vector<WzString> list = ini.childGroups();
+	char *data = nullptr;
+	UDWORD size = 0;
+	if (!PHYSFS_exists(filename) || !loadFile(filename, &data, &size))
+	{
+		debug(LOG_SAVE, "No script states in %s", filename);
+		return false;
+	}
+	nlohmann::json states;
+	try
+	{
+		states = parseJsonFile(data, size);
+	}
+	catch (const std::exception &e)
+	{
+		ASSERT(false, "Script states in %s are invalid: %s", filename, e.what());
+	}
+	free(data);
+	ASSERT_OR_RETURN(false, states.is_object(), "Script states in %s are not an object", filename);
 	debug(LOG_SAVE, "Loading script states for %zu script contexts", scripts.size());
-	for (size_t i = 0; i < list.size(); ++i)
+	size_t i = 0;
+	for (auto it = states.begin(); it != states.end(); ++it, ++i)
 	{
-		ini.beginGroup(list[i]);
-		int player = ini.value("me").toInt();
-		WzString scriptName = ini.value("scriptName").toWzString();
+		WzString key = WzString::fromUtf8(it.key());
+		nlohmann::json &group = it.value();
+		if (!group.is_object())
+		{
+			continue;
+		}
+		int player = json_getValue(group, "me").toInt();
+		WzString scriptName = json_getValue(group, "scriptName").toWzString();
 		wzapi::scripting_instance* instance = findInstanceForPlayer(player, scriptName);
-		if (instance && list[i].startsWith("triggers_"))
+		if (instance && key.startsWith("triggers_"))
 		{
 			std::shared_ptr<timerNode> node = std::make_shared<timerNode>();
-			if (ini.contains("timerID"))
+			if (group.contains("timerID"))
 			{
-				node->timerID = ini.value("timerID").toInt();
+				node->timerID = json_getValue(group, "timerID").toInt();
 			}
 			else
 			{
 				// backwards-compat with old saves
 				node->timerID = getNextAvailableTimerID();
 			}
-			if (ini.contains("timerName"))
+			if (group.contains("timerName"))
 			{
-				node->timerName = ini.value("timerName").toWzString().toStdString();
+				node->timerName = json_getValue(group, "timerName").toWzString().toStdString();
 			}
 			else
 			{
 				// backwards-compat with old saves
-				node->timerName = ini.value("function").toWzString().toStdString();
+				node->timerName = json_getValue(group, "function").toWzString().toStdString();
 			}
 			node->instance = instance;
 			debug(LOG_SAVE, "Registering trigger %zu for player %d, script %s",
 			      i, player, scriptName.toUtf8().c_str());
-			node->baseobj = ini.value("baseobj", -1).toInt();
-			node->baseobjtype = (OBJECT_TYPE)ini.value("objectType", (int)OBJ_NUM_TYPES).toInt();
-			node->frameTime = ini.value("frame").toInt();
-			node->ms = ini.value("ms").toInt();
+			node->baseobj = json_getValue(group, "baseobj", -1).toInt();
+			node->baseobjtype = (OBJECT_TYPE)json_getValue(group, "objectType", (int)OBJ_NUM_TYPES).toInt();
+			node->frameTime = json_getValue(group, "frame").toInt();
+			node->ms = json_getValue(group, "ms").toInt();
 			node->player = player;
-			node->calls = ini.value("calls").toInt();
-			node->type = (timerType)ini.value("type", TIMER_REPEAT).toInt();
+			node->calls = json_getValue(group, "calls").toInt();
+			node->type = (timerType)json_getValue(group, "type", TIMER_REPEAT).toInt();
 
 			std::tuple<TimerFunc, std::unique_ptr<timerAdditionalData>> restoredTimerInfo;
 			try
 			{
-				if (ini.contains("functionRestoreInfo"))
+				if (group.contains("functionRestoreInfo"))
 				{
-					restoredTimerInfo = instance->restoreTimerFunction(ini.value("functionRestoreInfo").jsonValue());
+					restoredTimerInfo = instance->restoreTimerFunction(group["functionRestoreInfo"]);
 				}
 				else
 				{
 					// backwards-compat with old saves
 					// construct a JS-compatible functionRestoreInfo using the "function" key, which should be set in an older save
 					nlohmann::json backwardsCompatJSFunctionRestoreInfo = nlohmann::json::object();
-					if (!ini.contains("function"))
+					if (!group.contains("function"))
 					{
-						ASSERT(false, "Invalid trigger in save (%s) - missing new functionRestoreInfo block, and old function parameter", list[i].toUtf8().c_str());
+						ASSERT(false, "Invalid trigger in save (%s) - missing new functionRestoreInfo block, and old function parameter", key.toUtf8().c_str());
 						continue;
 					}
-					backwardsCompatJSFunctionRestoreInfo["function"] = ini.value("function").jsonValue();
+					backwardsCompatJSFunctionRestoreInfo["function"] = group["function"];
 					restoredTimerInfo = instance->restoreTimerFunction(backwardsCompatJSFunctionRestoreInfo);
 				}
 			}
@@ -891,9 +1191,9 @@ bool scripting_engine::loadScriptStates(const char *filename)
 
 			addTimerNode(std::move(node));
 		}
-		else if (instance && list[i].startsWith("globals_"))
+		else if (instance && key.startsWith("globals_"))
 		{
-			nlohmann::json result = ini.currentJsonValue();
+			nlohmann::json &result = group;
 			debug(LOG_SAVE, "Loading script globals for player %d, script %s -- found %zu values",
 				  instance->player(), instance->scriptName().c_str(), result.size());
 			// filter out "scriptName" and "me" variables
@@ -901,14 +1201,13 @@ bool scripting_engine::loadScriptStates(const char *filename)
 			result.erase("scriptName");
 			instance->loadScriptGlobals(result);
 		}
-		else if (instance && list[i].startsWith("groups_"))
+		else if (instance && key.startsWith("groups_"))
 		{
-			std::vector<WzString> keys = ini.childKeys();
-			for (size_t j = 0; j < keys.size(); ++j)
+			for (auto const &value : group.items())
 			{
-				std::vector<WzString> values = ini.value(keys.at(j)).toWzStringList();
+				std::vector<WzString> values = json_variant(value.value()).toWzStringList();
 				bool ok = false; // check if number
-				int droidId = keys.at(j).toInt(&ok);
+				int droidId = WzString::fromUtf8(value.key()).toInt(&ok);
 				for (size_t k = 0; ok && k < values.size(); k++)
 				{
 					int groupId = values.at(k).toInt();
@@ -916,7 +1215,7 @@ bool scripting_engine::loadScriptStates(const char *filename)
 				}
 			}
 			bool bHasLastNewGroupId = false;
-			int lastNewGroupId = ini.value("lastNewGroupId").toInt(&bHasLastNewGroupId);
+			int lastNewGroupId = json_getValue(group, "lastNewGroupId").toInt(&bHasLastNewGroupId);
 			if (bHasLastNewGroupId)
 			{
 				GROUPMAP *psMap = getGroupMap(instance);
@@ -930,10 +1229,9 @@ bool scripting_engine::loadScriptStates(const char *filename)
 		{
 			if (instance)
 			{
-				debug(LOG_WARNING, "Encountered unexpected group '%s' in loadScriptStates", list[i].toUtf8().c_str());
+				debug(LOG_WARNING, "Encountered unexpected group '%s' in loadScriptStates", key.toUtf8().c_str());
 			}
 		}
-		ini.endGroup();
 	}
 	lastTimerID = maxRestoredTimerID;
 	return true;
@@ -975,6 +1273,11 @@ void scripting_engine::updateGlobalModels()
 			QStandardItemList list = addModelItem(it.key(), it.value());
 			m->appendRow(list);
 		}
+		json memoryUsage = instance->debugGetMemoryUsage();
+		if (!memoryUsage.empty())
+		{
+			m->appendRow(addModelItem("(memory)", memoryUsage));
+		}
 	}
 	QStandardItemModel *m = triggerModel;
 	m->setRowCount(0);
@@ -1788,7 +2091,7 @@ static QPointer<QStandardItemModel> labelModel; // TODO: Move this into scriptin
 
 scripting_engine& scripting_engine::instance()
 {
-	static scripting_engine engine = scripting_engine();
+	static scripting_engine engine;
 	return engine;
 }
 
@@ -1975,6 +2278,49 @@ void scripting_engine::showLabel(const std::string &key, bool clear_old, bool ju
 	}
 }
 
+std::shared_ptr<const scripting_engine::LabelIndex> scripting_engine::getLabelIndex()
+{
+	const int width = (mapWidth + LabelIndex::BUCKET_TILES - 1) / LabelIndex::BUCKET_TILES;
+	const int height = (mapHeight + LabelIndex::BUCKET_TILES - 1) / LabelIndex::BUCKET_TILES;
+	if (labelIndex && labelIndex->width == width && labelIndex->height == height)
+	{
+		return labelIndex;
+	}
+	auto bucket = [](int worldCoord, int size) {
+		return clip(map_coord(worldCoord) / LabelIndex::BUCKET_TILES, 0, size - 1);
+	};
+	auto index = std::make_shared<LabelIndex>();
+	index->width = width;
+	index->height = height;
+	index->areaLabels.resize(width * height);
+	for (auto const &it : labels)
+	{
+		const LABEL &l = it.second;
+		if ((l.type == SCRIPT_AREA || l.type == SCRIPT_RADIUS) && width > 0 && height > 0)
+		{
+			Vector2i min = l.type == SCRIPT_AREA ? l.p1 : l.p1 - Vector2i(l.p2.x, l.p2.x);
+			Vector2i max = l.type == SCRIPT_AREA ? l.p2 : l.p1 + Vector2i(l.p2.x, l.p2.x);
+			for (int y = bucket(min.y, height); y <= bucket(max.y, height); ++y)
+			{
+				for (int x = bucket(min.x, width); x <= bucket(max.x, width); ++x)
+				{
+					index->areaLabels[x + y * width].push_back(it.first);
+				}
+			}
+		}
+		if (l.type == SCRIPT_GROUP)
+		{
+			index->groupLabels[l.id].push_back(it.first);
+		}
+		else
+		{
+			index->objectLabels[l.id].push_back(it.first);
+		}
+	}
+	labelIndex = std::move(index);
+	return labelIndex;
+}
+
 // The bool return value is true when an object callback needs to be called.
 // The int return value holds group id when a group callback needs to be called, 0 otherwise.
 std::pair<bool, int> scripting_engine::seenLabelCheck(wzapi::scripting_instance *instance, const BASE_OBJECT *seen, const BASE_OBJECT *viewer)
@@ -1983,28 +2329,29 @@ std::pair<bool, int> scripting_engine::seenLabelCheck(wzapi::scripting_instance
 	ASSERT_OR_RETURN(std::make_pair(false, 0), psMap != nullptr, "Non-existent groupmap for engine");
 	auto seenObjIt = psMap->map().find(seen);
 	int groupId = (seenObjIt != psMap->map().end()) ? seenObjIt->second : 0;
-	bool foundObj = false, foundGroup = false;
-	for (auto &it : labels)
-	{
-		LABEL &l = it.second;
-		if (l.triggered != 0 || !(l.subscriber == ALL_PLAYERS || l.subscriber == viewer->player))
+	std::shared_ptr<const LabelIndex> index = getLabelIndex();
+	auto checkLabels = [&](std::unordered_map<int, std::vector<std::string>> const &labelsById, int id) {
+		auto labelNames = labelsById.find(id);
+		if (labelNames == labelsById.end())
 		{
-			continue;
+			return false;
 		}
-
-		// Don't let a seen game object ID which matches a group label ID to prematurely
-		// trigger a group label.
-		if (l.type != SCRIPT_GROUP && l.id == seen->id)
+		bool found = false;
+		for (auto const &name : labelNames->second)
 		{
-			l.triggered = viewer->id; // record who made the discovery
-			foundObj = true;
-		}
-		else if (l.type == SCRIPT_GROUP && l.id == groupId)
-		{
-			l.triggered = viewer->id; // record who made the discovery
-			foundGroup = true;
+			LABEL &l = labels.at(name);
+			if (l.triggered == 0 && (l.subscriber == ALL_PLAYERS || l.subscriber == viewer->player))
+			{
+				l.triggered = viewer->id; // record who made the discovery
+				found = true;
+			}
 		}
-	}
+		return found;
+	};
+	// Don't let a seen game object ID which matches a group label ID to prematurely
+	// trigger a group label.
+	bool foundObj = checkLabels(index->objectLabels, seen->id);
+	bool foundGroup = checkLabels(index->groupLabels, groupId);
 	if (foundObj || foundGroup)
 	{
 		updateLabelModel();
@@ -2017,8 +2364,21 @@ bool scripting_engine::areaLabelCheck(DROID *psDroid)
 	int x = psDroid->pos.x;
 	int y = psDroid->pos.y;
 	bool activated = false;
-	for (LABELMAP::iterator i = labels.begin(); i != labels.end(); i++)
+	// Keep the index alive, the area events may add or remove labels.
+	std::shared_ptr<const LabelIndex> index = getLabelIndex();
+	if (index->areaLabels.empty())
 	{
+		return false;
+	}
+	int bucketX = clip(map_coord(x) / LabelIndex::BUCKET_TILES, 0, index->width - 1);
+	int bucketY = clip(map_coord(y) / LabelIndex::BUCKET_TILES, 0, index->height - 1);
+	for (auto const &name : index->areaLabels[bucketX + bucketY * index->width])
+	{
+		LABELMAP::iterator i = labels.find(name);
+		if (i == labels.end())
+		{
+			continue;  // Removed by an earlier area event.
+		}
 		LABEL &l = i->second;
 		if (l.triggered == 0 && (l.subscriber == ALL_PLAYERS || l.subscriber == psDroid->player)
 		    && ((l.type == SCRIPT_AREA && l.p1.x < x && l.p1.y < y && l.p2.x > x && l.p2.y > y)
@@ -2123,6 +2483,7 @@ bool scripting_engine::loadLabels(const char *filename)
 	}
 	WzConfig ini(filename, WzConfig::ReadOnly);
 	labels.clear();
+	labelsChanged();
 	std::vector<WzString> list = ini.childGroups();
 	debug(LOG_SAVE, "Loading %zu labels...", list.size());
 	for (int i = 0; i < list.size(); ++i)
@@ -2497,6 +2858,7 @@ wzapi::no_return_value scripting_engine::addLabel(WZAPI_PARAMS(generic_script_ob
 	}
 
 	labels[label] = value;
+	scripting_engine::instance().labelsChanged();
 	scripting_engine::instance().updateLabelModel();
 	return {};
 }
@@ -2510,6 +2872,7 @@ int scripting_engine::removeLabel(WZAPI_PARAMS(std::string label))
 {
 	LABELMAP& labels = scripting_engine::instance().labels;
 	int result = labels.erase(label);
+	scripting_engine::instance().labelsChanged();
 	scripting_engine::instance().updateLabelModel();
 	return result;
 }
@@ -2817,6 +3180,7 @@ bool scripting_engine::unregisterFunctions(wzapi::scripting_instance *instance)
 	}
 	ASSERT(num == 1, "Number of engines removed from group map is %d!", num);
 	labels.clear();
+	labelsChanged();
 	labelModel = nullptr;
 	return true;
 }
@@ -21,10 +21,13 @@
 #define __INCLUDED_QTSCRIPT_H__
 
 #include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
 #include "lib/netplay/netplay.h"
 #include "random.h"
 #include "wzapi.h"
+#include "scriptprofiler.h"
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <unordered_set>
 #include <unordered_map>
@@ -305,6 +308,7 @@ public:
 		int player;
 		int calls;
 		timerType type;
+		uint64_t order = 0;     ///< Timers due on the same tick run in the order they were added.
 		timerNode() : instance(nullptr), baseobjtype(OBJ_NUM_TYPES), additionalTimerFuncParam(nullptr) {}
 		timerNode(wzapi::scripting_instance* caller, const TimerFunc& func, const std::string& timerName, int plr, int frame, std::unique_ptr<timerAdditionalData> additionalParam = nullptr);
 		~timerNode();
@@ -327,15 +331,44 @@ private:
 	typedef std::map<std::string, LABEL> LABELMAP;
 	LABELMAP labels;
 
+	/// Finds the labels which areaLabelCheck() and seenLabelCheck() have to look at, so they don't go through every label
+	/// on each droid move and sighting. Only covers where the labels are, so it is rebuilt when labels are added or removed,
+	/// but not when they are triggered or reset.
+	struct LabelIndex
+	{
+		static const int BUCKET_TILES = 8;                                  ///< Size of the area buckets, in tiles.
+		int width = 0, height = 0;                                          ///< Map size the buckets were made for, in buckets.
+		std::vector<std::vector<std::string>> areaLabels;                   ///< Area and radius labels overlapping each bucket, in label order.
+		std::unordered_map<int, std::vector<std::string>> objectLabels;     ///< Labels other than group labels, by id.
+		std::unordered_map<int, std::vector<std::string>> groupLabels;      ///< Group labels, by group id.
+	};
+	std::shared_ptr<const LabelIndex> labelIndex;  ///< Null until needed after labels were added or removed.
+	std::shared_ptr<const LabelIndex> getLabelIndex();
+	void labelsChanged() { labelIndex.reset(); }
+
 	typedef std::map<wzapi::scripting_instance *, GROUPMAP *> ENGINEMAP;
 	ENGINEMAP groups;
 
-	/// List of timer events for scripts. Before running them, we sort the list then run as many as we have time for.
-	/// In this way, we implement load balancing of events and keep frame rates tidy for users. Since scripts run on the
-	/// host, we do not need to worry about each peer simulating the world differently.
+	/// List of timer events for scripts, in the order they were added. Saved games and the debugger use this list,
+	/// updateScripts() finds the timers which are due using timerQueue.
 	std::list<std::shared_ptr<timerNode>> timers;
 	uniqueTimerID lastTimerID = 0;
 	std::unordered_map<uniqueTimerID, std::list<std::shared_ptr<timerNode>>::iterator> timerIDMap; // a map from uniqueTimerID -> entry in the timers list
+
+	struct timerQueueEntry
+	{
+		int frameTime;
+		uint64_t order;
+		std::weak_ptr<timerNode> node;
+		bool operator >(const timerQueueEntry &rhs) const
+		{
+			return frameTime != rhs.frameTime ? frameTime > rhs.frameTime : order > rhs.order;
+		}
+	};
+	/// Min-heap of when the timers are next due. Entries of removed or rescheduled timers are skipped when they come up, instead of being searched for.
+	std::vector<timerQueueEntry> timerQueue;
+	uint64_t nextTimerOrder = 0;
+	std::vector<uniqueTimerID> finishedOneShotTimers;  ///< One-shot timers which ran on the last tick, to remove on the next.
 private:
 	scripting_engine() { }
 public:
@@ -398,16 +431,65 @@ public:
 	}
 	
 	bool removeTimer(uniqueTimerID timerID);
+private:
+	void runTimers(const std::vector<std::shared_ptr<timerNode>> &runlist);
+	void runTimersConcurrently(const std::vector<std::shared_ptr<timerNode>> &runlist);
+	/// Starts more worker threads for runTimersConcurrently(), if there are fewer than count.
+	void startScriptWorkers(size_t count);
+	void stopScriptWorkers();
+	static int scriptWorkerThreadFunc(void *data);
+	std::vector<WZ_THREAD *> scriptWorkers;           ///< Kept until shutdownScripts(), rather than started every tick.
+	WZ_SEMAPHORE *scriptWorkSemaphore = nullptr;      ///< Posted once for each worker which should run scriptWork.
+	WZ_SEMAPHORE *scriptWorkDoneSemaphore = nullptr;  ///< Posted by each worker when done with scriptWork.
+	std::function<void ()> scriptWork;                ///< Empty to stop the workers.
+
+// MARK: CONCURRENT EXECUTION
+public:
+	/// While the timers of AI scripts run concurrently (see runTimersConcurrently()), the instances take turns to
+	/// touch the game state, and only run script code concurrently. Takes the game state lock for the instance,
+	/// unless it's not running concurrently, or already holds the lock.
+	class GameStateLock
+	{
+	public:
+		explicit GameStateLock(wzapi::scripting_instance *instance);
+		~GameStateLock();
+	private:
+		GameStateLock(const GameStateLock&) = delete;
+		GameStateLock& operator=(const GameStateLock&) = delete;
+		wzapi::scripting_instance *instance;  ///< Only set if this took the lock.
+	};
+	/// Releases the game state lock for the instance while it runs script code, if it holds the lock.
+	class GameStateUnlock
+	{
+	public:
+		explicit GameStateUnlock(wzapi::scripting_instance *instance);
+		~GameStateUnlock();
+	private:
+		GameStateUnlock(const GameStateUnlock&) = delete;
+		GameStateUnlock& operator=(const GameStateUnlock&) = delete;
+		wzapi::scripting_instance *instance;  ///< Only set if this released the lock.
+	};
+private:
+	wz::mutex gameStateMutex;
 public:
 	// Monitoring performance of function calls
 	template<typename Func>
 	void executeWithPerformanceMonitoring(wzapi::scripting_instance *instance, const std::string &function, Func f)
 	{
 		using microDuration = std::chrono::duration<uint64_t, std::micro>;
+		bool profiling = scriptProfilerEnabled();
+		if (profiling)
+		{
+			scriptProfilerBeginCall(instance, function);
+		}
 		auto time_begin = std::chrono::steady_clock::now();
 		f(); // execute provided Func f
 		auto duration_microsec = std::chrono::duration_cast<microDuration>(std::chrono::steady_clock::now() - time_begin);
 		int ticks = duration_microsec.count();
+		if (profiling)
+		{
+			scriptProfilerEndCall(instance);
+		}
 		logFunctionPerformance(instance, function, ticks);
 	}
 private:
@@ -415,6 +497,7 @@ private:
 	uniqueTimerID getNextAvailableTimerID();
 	// internal-only function that adds a Timer node (used for restoring saved games)
 	void addTimerNode(std::shared_ptr<timerNode>&& node);
+	void scheduleTimer(const std::shared_ptr<timerNode>& node);
 
 // MARK: triggering events (from wz game code)
 public:
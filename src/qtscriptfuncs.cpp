@@ -1565,6 +1565,46 @@ static QScriptValue callFunction(QScriptEngine *engine, const QString &function,
 			}
 		};
 
+		template<>
+		struct unbox<wzapi::object_or_position_list>
+		{
+			wzapi::object_or_position_list operator()(size_t& idx, QScriptContext *context, QScriptEngine *engine, const char *function)
+			{
+				if (context->argumentCount() <= idx)
+					return {};
+				QScriptValue list = context->argument(idx++);
+				UNBOX_SCRIPT_ASSERT(context, list.isArray(), "Expected an array of game objects or positions");
+				wzapi::object_or_position_list result;
+				int length = list.isArray() ? list.property("length").toInt32() : 0;
+				result.entries.reserve(length);
+				for (int k = 0; k < length; k++)
+				{
+					QScriptValue item = list.property(k);
+					QScriptValue typeVal = item.property("type");
+					int type = typeVal.isNumber() ? typeVal.toInt32() : -1;
+					wzapi::object_or_position_list::entry entry;
+					if (type == OBJ_DROID || type == OBJ_STRUCTURE || type == OBJ_FEATURE)
+					{
+						int oid = item.property("id").toInt32();
+						int oplayer = item.property("player").toInt32();
+						entry.psObj = IdToObject((OBJECT_TYPE)type, oid, oplayer);
+						UNBOX_SCRIPT_ASSERT(context, entry.psObj, "No such object id %d belonging to player %d", oid, oplayer);
+						if (entry.psObj == nullptr)
+						{
+							return {};
+						}
+						entry.pos = entry.psObj->pos.xy();
+					}
+					else
+					{
+						entry.pos = Vector2i(world_coord(item.property("x").toInt32()), world_coord(item.property("y").toInt32()));  // As enumRange() does.
+					}
+					result.entries.push_back(entry);
+				}
+				return result;
+			}
+		};
+
 		template<typename T>
 		QScriptValue box(T a, QScriptEngine*)
 		{
@@ -2878,6 +2918,9 @@ IMPL_JS_FUNC(getScrollLimits, wzapi::getScrollLimits)
 IMPL_JS_FUNC(loadLevel, wzapi::loadLevel)
 IMPL_JS_FUNC(autoSave, wzapi::autoSave)
 IMPL_JS_FUNC(enumRange, wzapi::enumRange)
+IMPL_JS_FUNC(enumRangeNearest, wzapi::enumRangeNearest)
+IMPL_JS_FUNC(countRange, wzapi::countRange)
+IMPL_JS_FUNC(threatRange, wzapi::threatRange)
 IMPL_JS_FUNC(enumArea, scripting_engine::enumAreaJS)
 IMPL_JS_FUNC(addBeacon, wzapi::addBeacon)
 
@@ -3077,6 +3120,9 @@ bool qtscript_scripting_instance::registerFunctions(const QString& scriptName)
 	JS_REGISTER_FUNC(enumSelected); // WZAPI
 	JS_REGISTER_FUNC(enumResearch); // WZAPI
 	JS_REGISTER_FUNC(enumRange); // WZAPI
+	JS_REGISTER_FUNC(enumRangeNearest); // WZAPI
+	JS_REGISTER_FUNC(countRange); // WZAPI
+	JS_REGISTER_FUNC(threatRange); // WZAPI
 	JS_REGISTER_FUNC(enumArea); // scripting_engine
 	JS_REGISTER_FUNC(getResearch); // WZAPI
 	JS_REGISTER_FUNC(pursueResearch); // WZAPI
@@ -38,6 +38,8 @@
 #include "lib/framework/wzapp.h"
 #include "lib/framework/wzconfig.h"
 #include "lib/framework/fixedpoint.h"
+#include "lib/framework/crc.h"
+#include "lib/framework/physfs_ext.h"
 #include "lib/sound/audio.h"
 #include "lib/sound/cdaudio.h"
 #include "lib/netplay/netplay.h"
@@ -83,6 +85,9 @@
 #include "advvis.h"
 #include "loadsave.h"
 #include "wzapi.h"
+#include "version.h"
+#include "scriptprofiler.h"
+#include "warzoneconfig.h"
 
 
 #include <unordered_set>
@@ -145,6 +150,43 @@ bool QuickJS_EnumerateObjectProperties(JSContext *ctx, JSValue obj, const std::f
 class quickjs_scripting_instance;
 static std::map<JSContext*, quickjs_scripting_instance *> engineToInstanceMap;
 
+/// Game object properties which are only worked out if the script reads them, see convObj().
+enum LazyObjectProperty
+{
+	LAZY_ARMOUR,
+	LAZY_THERMAL,
+	LAZY_NAME,
+	LAZY_RANGE,
+	LAZY_COST,
+	LAZY_HAS_INDIRECT,
+	LAZY_CAN_HIT_AIR,
+	LAZY_CAN_HIT_GROUND,
+	LAZY_IS_RADAR_DETECTOR,
+	LAZY_IS_CB,
+	LAZY_IS_SENSOR,
+	LAZY_IS_VTOL,
+	LAZY_BODY_SIZE,
+	LAZY_BODY,
+	LAZY_PROPULSION,
+	LAZY_ARMED,
+	LAZY_CARGO_CAPACITY,
+	LAZY_CARGO_LEFT,
+	LAZY_CARGO_COUNT,
+	LAZY_CARGO_SIZE,
+	LAZY_MODULES,
+	LAZY_WEAPONS,
+	LAZY_PROPERTY_COUNT
+};
+
+static const char *const lazyPropertyNames[LAZY_PROPERTY_COUNT] =
+{
+	"armour", "thermal", "name", "range", "cost", "hasIndirect", "canHitAir", "canHitGround", "isRadarDetector", "isCB", "isSensor", "isVTOL",
+	"bodySize", "body", "propulsion", "armed", "cargoCapacity", "cargoLeft", "cargoCount", "cargoSize", "modules", "weapons"
+};
+
+struct LazyGameObject;
+static void initLazyObjectClass(JSContext *ctx);
+
 class quickjs_scripting_instance : public wzapi::scripting_instance
 {
 public:
@@ -156,14 +198,40 @@ public:
 		global_obj = JS_GetGlobalObject(ctx);
 
 		engineToInstanceMap.insert(std::pair<JSContext*, quickjs_scripting_instance*>(ctx, this));
+
+		initLazyObjectClass(ctx);
+		for (int i = 0; i < LAZY_PROPERTY_COUNT; ++i)
+		{
+			lazyPropertyAtoms[i] = JS_NewAtom(ctx, lazyPropertyNames[i]);
+		}
+
+		if (scriptProfilerEnabled())
+		{
+			JS_SetInterruptHandler(rt, profilerInterruptHandler, this);
+		}
+		configureMemory();
 	}
 	virtual ~quickjs_scripting_instance()
 	{
 		engineToInstanceMap.erase(ctx);
+		eventDispatchTable.clear();
+		for (auto &call : deferredCalls)
+		{
+			std::for_each(call.args.begin(), call.args.end(), [this](JSValue &val) { JS_FreeValue(ctx, val); });
+		}
+		for (auto &it : profilerFrameIds)
+		{
+			JS_FreeAtom(ctx, std::get<0>(it.first));
+			JS_FreeAtom(ctx, std::get<1>(it.first));
+		}
 
 		JS_FreeValue(ctx, global_obj);
-		JS_FreeContext(ctx);
+		JS_FreeContext(ctx);  // Finalizes the remaining lazy objects, which still need pendingLazyObjects.
 		ctx = nullptr;
+		for (JSAtom atom : lazyPropertyAtoms)
+		{
+			JS_FreeAtomRT(rt, atom);
+		}
 		JS_FreeRuntime(rt);
 		rt = nullptr;
 	}
@@ -216,6 +284,17 @@ public:
 
 	void doNotSaveGlobal(const std::string &global);
 
+	/// Reads the remaining lazy properties of the game objects handed to the script, so the script objects stop depending on them.
+	/// If psObj is given, only objects converted from psObj are snapshotted.
+	void snapshotLazyObjects(const BASE_OBJECT *psObj = nullptr);
+
+public:
+	JSAtom lazyPropertyAtoms[LAZY_PROPERTY_COUNT];
+	std::vector<LazyGameObject *> pendingLazyObjects;  ///< Lazy objects which still point at their game object.
+	int lazyScopeDepth = 0;                            ///< Number of nested LazyObjectScopes.
+	bool globalsChanged = true;                        ///< Whether script code may have run since savedGlobals was saved.
+	nlohmann::json savedGlobals;                       ///< The globals saved by the last saveScriptGlobals().
+
 private:
 	JSRuntime *rt;
     JSContext *ctx;
@@ -230,6 +309,67 @@ public: // temporary
 	std::vector<std::string> eventNamespaces;
 	JSValue Get_Global_Obj() const { return global_obj; }
 
+	/// Names of the script functions to call for an event, with their atoms. The namespaced variants come first.
+	struct EventHandlers
+	{
+		explicit EventHandlers(JSRuntime *rt) : rt(rt) {}
+		~EventHandlers()
+		{
+			for (JSAtom atom : atoms)
+			{
+				JS_FreeAtomRT(rt, atom);
+			}
+		}
+		JSRuntime *rt;
+		std::vector<std::string> names;
+		std::vector<JSAtom> atoms;
+	};
+	std::shared_ptr<const EventHandlers> eventHandlers(const std::string &function);
+	/// Whether the script defines a function for the event, in any namespace.
+	bool handlesEvent(const std::string &function);
+	void addEventNamespace(const std::string &prefix);
+
+public:
+	// concurrent execution
+	bool supportsConcurrentExecution() const override { return true; }
+	void beginConcurrentExecution() override;
+	void endConcurrentExecution() override;
+	/// Queues a call of an API function which changes the game state, until endConcurrentExecution().
+	void deferCall(JSCFunction *function, int argc, JSValueConst *argv);
+
+public:
+	// memory management
+	bool needsGarbageCollection() const override;
+	void collectGarbage() override;
+	nlohmann::json debugGetMemoryUsage() override;
+
+private:
+	/// Applies the memory limit and garbage collection options.
+	void configureMemory();
+	size_t minGCThreshold = 256 * 1024;  ///< QuickJS's default, unless configured.
+	size_t gcThreshold = 0;              ///< Heap size above which needsGarbageCollection(), if collecting between ticks.
+	uint64_t gcCount = 0;                ///< Collections by collectGarbage().
+	uint64_t gcTime = 0;                 ///< Microseconds spent in collectGarbage().
+
+private:
+	struct DeferredCall
+	{
+		JSCFunction *function;
+		std::vector<JSValue> args;
+	};
+	std::vector<DeferredCall> deferredCalls;  ///< In the order the script made them.
+
+private:
+	static int profilerInterruptHandler(JSRuntime *rt, void *opaque);
+	unsigned profilerFrame(JSDebuggerStackFrame const &frame);
+	void nameProfilerFrames() override;
+	/// Profiler frame ids by function name, file name and line, see profilerInterruptHandler().
+	std::map<std::tuple<JSAtom, JSAtom, int>, unsigned> profilerFrameIds;
+
+	/// Event dispatch table, so that triggering an event does not build and look up the function names every time.
+	/// Entries only hold the names, whether the functions are defined is checked on every call, since scripts can define them at any time.
+	std::unordered_map<std::string, std::shared_ptr<const EventHandlers>> eventDispatchTable;
+
 public:
 	// MARK: General events
 
@@ -703,6 +843,489 @@ static int QuickJS_DefinePropertyValue(JSContext *ctx, JSValueConst this_obj, co
 	return ret;
 }
 
+// MARK: Script bytecode cache
+
+// Every player's AI compiles the same scripts and includes at every game start, so compiled scripts are kept,
+// in memory for the rest of the run and in the write directory for later runs. They are found by a hash of
+// the game version, the script path (which ends up in the bytecode, for backtraces) and the script itself.
+
+#define SCRIPT_BYTECODE_CACHE_DIR "cache/scripts"
+
+static const char scriptBytecodeMagic[CACHE_FILE_MAGIC_SIZE] = {'W', 'Z', 'J', 'S', 'B', 'C', '0', '1'};
+static std::unordered_map<std::string, std::vector<uint8_t>> scriptBytecodeCache;  ///< Bytecode by cache key.
+
+static std::string scriptBytecodeKey(const char *bytes, size_t size, const std::string &path)
+{
+	Sha256 sourceHash = sha256Sum(bytes, size);
+	std::string keyData = version_getVersionString();
+	keyData.push_back('\0');
+	keyData += path;
+	keyData.push_back('\0');
+	keyData.append(reinterpret_cast<const char *>(sourceHash.bytes), Sha256::Bytes);
+	return sha256Sum(keyData.data(), keyData.size()).toString();
+}
+
+static std::string scriptBytecodeFile(const std::string &key)
+{
+	return SCRIPT_BYTECODE_CACHE_DIR "/" + key + ".bc";
+}
+
+static const std::vector<uint8_t> *findScriptBytecode(const std::string &key)
+{
+	auto it = scriptBytecodeCache.find(key);
+	if (it == scriptBytecodeCache.end())
+	{
+		std::vector<uint8_t> bytecode;
+		if (!loadCacheFile(scriptBytecodeFile(key).c_str(), scriptBytecodeMagic, bytecode))
+		{
+			return nullptr;
+		}
+		it = scriptBytecodeCache.emplace(key, std::move(bytecode)).first;
+	}
+	return &it->second;
+}
+
+static void storeScriptBytecode(JSContext *ctx, const std::string &key, JSValueConst compiledScriptObj)
+{
+	size_t size = 0;
+	uint8_t *data = JS_WriteObject(ctx, &size, compiledScriptObj, JS_WRITE_OBJ_BYTECODE);
+	if (data == nullptr)
+	{
+		JS_FreeValue(ctx, JS_GetException(ctx));
+		return;
+	}
+	std::vector<uint8_t> &bytecode = scriptBytecodeCache[key];
+	bytecode.assign(data, data + size);
+	js_free(ctx, data);
+	saveCacheFile(scriptBytecodeFile(key).c_str(), scriptBytecodeMagic, bytecode.data(), bytecode.size());
+}
+
+/// Compiles a script, like JS_Eval() with JS_EVAL_FLAG_COMPILE_ONLY, unless it is in the bytecode cache. bytes must be nul-terminated.
+static JSValue compileScript(JSContext *ctx, const char *bytes, size_t size, const std::string &path)
+{
+	std::string key = scriptBytecodeKey(bytes, size, path);
+	const std::vector<uint8_t> *bytecode = findScriptBytecode(key);
+	if (bytecode != nullptr)
+	{
+		JSValue compiledScriptObj = JS_ReadObject(ctx, bytecode->data(), bytecode->size(), JS_READ_OBJ_BYTECODE);
+		if (!JS_IsException(compiledScriptObj))
+		{
+			return compiledScriptObj;
+		}
+		JS_FreeValue(ctx, JS_GetException(ctx));
+		debug(LOG_WARNING, "Could not read cached bytecode of %s, compiling it again", path.c_str());
+	}
+	JSValue compiledScriptObj = JS_Eval(ctx, bytes, size, path.c_str(), JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+	if (!JS_IsException(compiledScriptObj))
+	{
+		storeScriptBytecode(ctx, key, compiledScriptObj);
+	}
+	return compiledScriptObj;
+}
+
+// MARK: Lazy game objects
+
+// Droids, structures and features are handed to scripts by the hundred (enumDroid(), enumRange(), events),
+// and most scripts only look at a few of their properties. The cheap properties that change all the time
+// are set when converting, the rest are only worked out when the script reads them, and kept in the object.
+// Once the outermost LazyObjectScope ends, or the game object is destroyed, the unread properties of the
+// objects the script kept are read too, so script objects remain snapshots, as they always were.
+
+static JSClassID lazyObjectClassId = 0;
+
+struct LazyGameObject
+{
+	quickjs_scripting_instance *instance;
+	const BASE_OBJECT *psObj;               ///< Game object to read the properties from, nullptr once snapshotted.
+	size_t pendingIndex;                    ///< Index in instance->pendingLazyObjects, while psObj is set.
+	uint32_t properties;                    ///< Bit mask of the LazyObjectProperty values this object has.
+	JSValue values[LAZY_PROPERTY_COUNT];    ///< Properties read so far, JS_UNINITIALIZED if not read yet.
+};
+
+struct WeaponSummary
+{
+	bool aa = false;
+	bool ga = false;
+	bool indirect = false;
+	int range = -1;
+};
+
+template <typename OBJECT>
+static WeaponSummary summariseWeapons(const OBJECT *psObj)
+{
+	WeaponSummary summary;
+	for (int i = 0; i < psObj->numWeaps; i++)
+	{
+		if (psObj->asWeaps[i].nStat)
+		{
+			WEAPON_STATS *psWeap = &asWeaponStats[psObj->asWeaps[i].nStat];
+			summary.aa = summary.aa || psWeap->surfaceToAir & SHOOT_IN_AIR;
+			summary.ga = summary.ga || psWeap->surfaceToAir & SHOOT_ON_GROUND;
+			summary.indirect = summary.indirect || psWeap->movementModel == MM_INDIRECT || psWeap->movementModel == MM_HOMINGINDIRECT;
+			summary.range = MAX(proj_GetLongRange(psWeap, psObj->player), summary.range);
+		}
+	}
+	return summary;
+}
+
+static JSValue convWeapons(const DROID *psDroid, JSContext *ctx)
+{
+	JSValue weaponlist = JS_NewArray(ctx);
+	for (int j = 0; j < psDroid->numWeaps; j++)
+	{
+		int armed = droidReloadBar(psDroid, &psDroid->asWeaps[j], j);
+		JSValue weapon = JS_NewObject(ctx);
+		const WEAPON_STATS *psStats = asWeaponStats + psDroid->asWeaps[j].nStat;
+		QuickJS_DefinePropertyValue(ctx, weapon, "fullname", JS_NewString(ctx, psStats->name.toUtf8().c_str()), 0);
+		QuickJS_DefinePropertyValue(ctx, weapon, "name", JS_NewString(ctx, psStats->id.toUtf8().c_str()), 0); // will be changed to contain full name
+		QuickJS_DefinePropertyValue(ctx, weapon, "id", JS_NewString(ctx, psStats->id.toUtf8().c_str()), 0);
+		QuickJS_DefinePropertyValue(ctx, weapon, "lastFired", JS_NewUint32(ctx, psDroid->asWeaps[j].lastFired), 0);
+		QuickJS_DefinePropertyValue(ctx, weapon, "armed", JS_NewInt32(ctx, armed), 0);
+		JS_DefinePropertyValueUint32(ctx, weaponlist, j, weapon, 0);
+	}
+	return weaponlist;
+}
+
+static JSValue convWeapons(const STRUCTURE *psStruct, JSContext *ctx)
+{
+	JSValue weaponlist = JS_NewArray(ctx);
+	for (int j = 0; j < psStruct->numWeaps; j++)
+	{
+		JSValue weapon = JS_NewObject(ctx);
+		const WEAPON_STATS *psStats = asWeaponStats + psStruct->asWeaps[j].nStat;
+		QuickJS_DefinePropertyValue(ctx, weapon, "fullname", JS_NewString(ctx, psStats->name.toUtf8().c_str()), 0);
+		QuickJS_DefinePropertyValue(ctx, weapon, "name", JS_NewString(ctx, psStats->id.toUtf8().c_str()), 0); // will be changed to contain full name
+		QuickJS_DefinePropertyValue(ctx, weapon, "id", JS_NewString(ctx, psStats->id.toUtf8().c_str()), 0);
+		QuickJS_DefinePropertyValue(ctx, weapon, "lastFired", JS_NewUint32(ctx, psStruct->asWeaps[j].lastFired), 0);
+		JS_DefinePropertyValueUint32(ctx, weaponlist, j, weapon, 0);
+	}
+	return weaponlist;
+}
+
+static JSValue droidLazyProperty(const DROID *psDroid, LazyObjectProperty property, JSContext *ctx)
+{
+	switch (property)
+	{
+	case LAZY_RANGE:
+		{
+			int range = summariseWeapons(psDroid).range;
+			return range >= 0 ? JS_NewInt32(ctx, range) : JS_NULL;
+		}
+	case LAZY_COST: return JS_NewUint32(ctx, calcDroidPower(psDroid));
+	case LAZY_HAS_INDIRECT: return JS_NewBool(ctx, summariseWeapons(psDroid).indirect);
+	case LAZY_CAN_HIT_AIR: return JS_NewBool(ctx, summariseWeapons(psDroid).aa);
+	case LAZY_CAN_HIT_GROUND: return JS_NewBool(ctx, summariseWeapons(psDroid).ga);
+	case LAZY_IS_RADAR_DETECTOR: return JS_NewBool(ctx, objRadarDetector(psDroid));
+	case LAZY_IS_CB: return JS_NewBool(ctx, cbSensorDroid(psDroid));
+	case LAZY_IS_SENSOR: return JS_NewBool(ctx, standardSensorDroid(psDroid));
+	case LAZY_IS_VTOL: return JS_NewBool(ctx, isVtolDroid(psDroid));
+	case LAZY_BODY_SIZE: return JS_NewInt32(ctx, asBodyStats[psDroid->asBits[COMP_BODY]].size);
+	case LAZY_BODY: return JS_NewString(ctx, asBodyStats[psDroid->asBits[COMP_BODY]].id.toUtf8().c_str());
+	case LAZY_PROPULSION: return JS_NewString(ctx, asPropulsionStats[psDroid->asBits[COMP_PROPULSION]].id.toUtf8().c_str());
+	case LAZY_ARMED: return JS_NewFloat64(ctx, 0.0); // deprecated!
+	case LAZY_CARGO_CAPACITY: return JS_NewInt32(ctx, TRANSPORTER_CAPACITY);
+	case LAZY_CARGO_LEFT: return JS_NewInt32(ctx, calcRemainingCapacity(psDroid));
+	case LAZY_CARGO_COUNT: return JS_NewUint32(ctx, psDroid->psGroup != nullptr? psDroid->psGroup->getNumMembers() : 0);
+	case LAZY_CARGO_SIZE: return JS_NewInt32(ctx, transporterSpaceRequired(psDroid));
+	case LAZY_WEAPONS: return convWeapons(psDroid, ctx);
+	default: ASSERT(false, "Droids have no lazy property %s", lazyPropertyNames[property]); return JS_UNDEFINED;
+	}
+}
+
+static JSValue structureLazyProperty(const STRUCTURE *psStruct, LazyObjectProperty property, JSContext *ctx)
+{
+	switch (property)
+	{
+	case LAZY_RANGE: return JS_NewInt32(ctx, summariseWeapons(psStruct).range);
+	case LAZY_COST: return JS_NewInt32(ctx, psStruct->pStructureType->powerToBuild);
+	case LAZY_HAS_INDIRECT: return JS_NewBool(ctx, summariseWeapons(psStruct).indirect);
+	case LAZY_CAN_HIT_AIR: return JS_NewBool(ctx, summariseWeapons(psStruct).aa);
+	case LAZY_CAN_HIT_GROUND: return JS_NewBool(ctx, summariseWeapons(psStruct).ga);
+	case LAZY_IS_RADAR_DETECTOR: return JS_NewBool(ctx, objRadarDetector(psStruct));
+	case LAZY_IS_CB: return JS_NewBool(ctx, structCBSensor(psStruct));
+	case LAZY_IS_SENSOR: return JS_NewBool(ctx, structStandardSensor(psStruct));
+	case LAZY_MODULES:
+		if (psStruct->pStructureType->type == REF_FACTORY || psStruct->pStructureType->type == REF_CYBORG_FACTORY
+		    || psStruct->pStructureType->type == REF_VTOL_FACTORY
+		    || psStruct->pStructureType->type == REF_RESEARCH
+		    || psStruct->pStructureType->type == REF_POWER_GEN)
+		{
+			return JS_NewUint32(ctx, psStruct->capacity);
+		}
+		return JS_NULL;
+	case LAZY_WEAPONS: return convWeapons(psStruct, ctx);
+	default: ASSERT(false, "Structures have no lazy property %s", lazyPropertyNames[property]); return JS_UNDEFINED;
+	}
+}
+
+static JSValue lazyProperty(const BASE_OBJECT *psObj, LazyObjectProperty property, JSContext *ctx)
+{
+	switch (property)
+	{
+	case LAZY_ARMOUR: return JS_NewInt32(ctx, objArmour(psObj, WC_KINETIC));
+	case LAZY_THERMAL: return JS_NewInt32(ctx, objArmour(psObj, WC_HEAT));
+	case LAZY_NAME: return JS_NewString(ctx, objInfo(psObj));
+	default:
+		break;
+	}
+	switch (psObj->type)
+	{
+	case OBJ_DROID: return droidLazyProperty((const DROID *)psObj, property, ctx);
+	case OBJ_STRUCTURE: return structureLazyProperty((const STRUCTURE *)psObj, property, ctx);
+	default: ASSERT(false, "Object has no lazy property %s", lazyPropertyNames[property]); return JS_UNDEFINED;
+	}
+}
+
+/// Which lazy properties an object gets, these are the properties not set by convObj(), convDroid() and so on.
+static uint32_t lazyProperties(const BASE_OBJECT *psObj)
+{
+	uint32_t properties = 1u << LAZY_ARMOUR | 1u << LAZY_THERMAL | 1u << LAZY_NAME;
+	switch (psObj->type)
+	{
+	case OBJ_DROID:
+		for (int property = LAZY_RANGE; property <= LAZY_ARMED; ++property)
+		{
+			properties |= 1u << property;
+		}
+		properties |= 1u << LAZY_CARGO_SIZE | 1u << LAZY_WEAPONS;
+		if (isTransporter((const DROID *)psObj))
+		{
+			properties |= 1u << LAZY_CARGO_CAPACITY | 1u << LAZY_CARGO_LEFT | 1u << LAZY_CARGO_COUNT;
+		}
+		break;
+	case OBJ_STRUCTURE:
+		for (int property = LAZY_RANGE; property <= LAZY_IS_SENSOR; ++property)
+		{
+			properties |= 1u << property;
+		}
+		properties |= 1u << LAZY_MODULES | 1u << LAZY_WEAPONS;
+		break;
+	default:
+		break;
+	}
+	return properties;
+}
+
+static LazyGameObject *getLazyGameObject(JSValueConst obj)
+{
+	return static_cast<LazyGameObject *>(JS_GetOpaque(obj, lazyObjectClassId));
+}
+
+static int findLazyProperty(const LazyGameObject *lazy, JSAtom prop)
+{
+	for (int property = 0; property < LAZY_PROPERTY_COUNT; ++property)
+	{
+		if ((lazy->properties & 1u << property) != 0 && lazy->instance->lazyPropertyAtoms[property] == prop)
+		{
+			return property;
+		}
+	}
+	return -1;
+}
+
+static int lazyObjectGetOwnProperty(JSContext *ctx, JSPropertyDescriptor *desc, JSValueConst obj, JSAtom prop)
+{
+	LazyGameObject *lazy = getLazyGameObject(obj);
+	int property = findLazyProperty(lazy, prop);
+	if (property < 0)
+	{
+		return false;
+	}
+	if (desc != nullptr)
+	{
+		JSValue &value = lazy->values[property];
+		if (JS_IsUninitialized(value))
+		{
+			ASSERT_OR_RETURN(-1, lazy->psObj != nullptr, "Lazy property %s was never read", lazyPropertyNames[property]);
+			scripting_engine::GameStateLock lock(lazy->instance);
+			// Must not touch the object's shape here, QuickJS may be in the middle of listing its properties.
+			value = lazyProperty(lazy->psObj, static_cast<LazyObjectProperty>(property), ctx);
+		}
+		desc->flags = 0;  // Read-only and not enumerable, like all the other properties of game objects.
+		desc->value = JS_DupValue(ctx, value);
+		desc->getter = JS_UNDEFINED;
+		desc->setter = JS_UNDEFINED;
+	}
+	return true;
+}
+
+static int lazyObjectGetOwnPropertyNames(JSContext *ctx, JSPropertyEnum **ptab, uint32_t *plen, JSValueConst obj)
+{
+	const LazyGameObject *lazy = getLazyGameObject(obj);
+	JSPropertyEnum *tab = static_cast<JSPropertyEnum *>(js_malloc(ctx, sizeof(JSPropertyEnum) * LAZY_PROPERTY_COUNT));
+	if (tab == nullptr)
+	{
+		return -1;
+	}
+	uint32_t len = 0;
+	for (int property = 0; property < LAZY_PROPERTY_COUNT; ++property)
+	{
+		if ((lazy->properties & 1u << property) != 0)
+		{
+			tab[len].is_enumerable = false;
+			tab[len].atom = JS_DupAtom(ctx, lazy->instance->lazyPropertyAtoms[property]);
+			++len;
+		}
+	}
+	*ptab = tab;
+	*plen = len;
+	return 0;
+}
+
+static int lazyObjectDeleteProperty(JSContext *ctx, JSValueConst obj, JSAtom prop)
+{
+	return findLazyProperty(getLazyGameObject(obj), prop) < 0;  // Not configurable.
+}
+
+static int lazyObjectDefineOwnProperty(JSContext *ctx, JSValueConst this_obj, JSAtom prop, JSValueConst val, JSValueConst getter, JSValueConst setter, int flags)
+{
+	if (findLazyProperty(getLazyGameObject(this_obj), prop) >= 0)
+	{
+		if ((flags & JS_PROP_THROW) != 0)
+		{
+			JS_ThrowTypeError(ctx, "property is not configurable");
+			return -1;
+		}
+		return false;
+	}
+	// Scripts may add their own properties to game objects.
+	return JS_DefineProperty(ctx, this_obj, prop, val, getter, setter, flags | JS_PROP_NO_EXOTIC);
+}
+
+static void lazyObjectFinalizer(JSRuntime *rt, JSValue val)
+{
+	LazyGameObject *lazy = getLazyGameObject(val);
+	if (lazy->psObj != nullptr)
+	{
+		lazy->instance->pendingLazyObjects[lazy->pendingIndex] = nullptr;
+	}
+	for (JSValue &value : lazy->values)
+	{
+		JS_FreeValueRT(rt, value);
+	}
+	delete lazy;
+}
+
+static void lazyObjectMark(JSRuntime *rt, JSValueConst val, JS_MarkFunc *mark_func)
+{
+	for (JSValue &value : getLazyGameObject(val)->values)
+	{
+		JS_MarkValue(rt, value, mark_func);
+	}
+}
+
+static void initLazyObjectClass(JSContext *ctx)
+{
+	static JSClassExoticMethods exoticMethods = {
+		lazyObjectGetOwnProperty,
+		lazyObjectGetOwnPropertyNames,
+		lazyObjectDeleteProperty,
+		lazyObjectDefineOwnProperty,
+		nullptr, nullptr, nullptr
+	};
+	static JSClassDef classDef = {"GameObject", lazyObjectFinalizer, lazyObjectMark, nullptr, &exoticMethods};
+
+	JS_NewClassID(&lazyObjectClassId);
+	JS_NewClass(JS_GetRuntime(ctx), lazyObjectClassId, &classDef);
+	// Classes added after the context was created have no prototype, game objects used to be plain objects.
+	JSValue plainObject = JS_NewObject(ctx);
+	JS_SetClassProto(ctx, lazyObjectClassId, JS_GetPrototype(ctx, plainObject));
+	JS_FreeValue(ctx, plainObject);
+}
+
+static JSValue newLazyGameObject(const BASE_OBJECT *psObj, JSContext *ctx)
+{
+	JSValue value = JS_NewObjectClass(ctx, lazyObjectClassId);
+	if (JS_IsException(value))
+	{
+		return value;
+	}
+	quickjs_scripting_instance *instance = engineToInstanceMap.at(ctx);
+	LazyGameObject *lazy = new LazyGameObject;
+	lazy->instance = instance;
+	lazy->psObj = psObj;
+	lazy->pendingIndex = instance->pendingLazyObjects.size();
+	lazy->properties = lazyProperties(psObj);
+	std::fill(std::begin(lazy->values), std::end(lazy->values), JS_UNINITIALIZED);
+	instance->pendingLazyObjects.push_back(lazy);
+	JS_SetOpaque(value, lazy);
+	return value;
+}
+
+void quickjs_scripting_instance::snapshotLazyObjects(const BASE_OBJECT *psObj)
+{
+	// Reading properties allocates, and may run the garbage collector, which can finalize any of these objects.
+	for (size_t i = 0; i < pendingLazyObjects.size(); ++i)
+	{
+		LazyGameObject *lazy = pendingLazyObjects[i];
+		if (lazy == nullptr || (psObj != nullptr && lazy->psObj != psObj))
+		{
+			continue;
+		}
+		const BASE_OBJECT *psLazyObj = lazy->psObj;
+		for (int property = 0; property < LAZY_PROPERTY_COUNT && pendingLazyObjects[i] == lazy; ++property)
+		{
+			if ((lazy->properties & 1u << property) != 0 && JS_IsUninitialized(lazy->values[property]))
+			{
+				JSValue value = lazyProperty(psLazyObj, static_cast<LazyObjectProperty>(property), ctx);
+				if (pendingLazyObjects[i] == lazy)
+				{
+					lazy->values[property] = value;
+				}
+				else
+				{
+					JS_FreeValue(ctx, value);
+				}
+			}
+		}
+		if (pendingLazyObjects[i] == lazy)
+		{
+			lazy->psObj = nullptr;
+			pendingLazyObjects[i] = nullptr;
+		}
+	}
+	if (psObj == nullptr)
+	{
+		pendingLazyObjects.clear();
+	}
+}
+
+/// Lazy objects handed to the script read their game objects until the outermost scope ends.
+/// Script code only runs inside a scope, so opening one also means the globals may change.
+class LazyObjectScope
+{
+public:
+	explicit LazyObjectScope(quickjs_scripting_instance *instance) : instance(instance)
+	{
+		++instance->lazyScopeDepth;
+		instance->globalsChanged = true;
+	}
+	explicit LazyObjectScope(JSContext *ctx) : LazyObjectScope(engineToInstanceMap.at(ctx))
+	{
+	}
+	~LazyObjectScope()
+	{
+		if (--instance->lazyScopeDepth == 0)
+		{
+			instance->snapshotLazyObjects();
+		}
+	}
+
+private:
+	quickjs_scripting_instance *instance;
+};
+
+void snapshotQuickJSObject(const BASE_OBJECT *psObj)
+{
+	for (auto &it : engineToInstanceMap)
+	{
+		if (!it.second->pendingLazyObjects.empty())
+		{
+			it.second->snapshotLazyObjects(psObj);
+		}
+	}
+}
+
 //;; ## Research
 //;;
 //;; Describes a research item. The following properties are defined:
@@ -766,32 +1389,9 @@ JSValue convResearch(const RESEARCH *psResearch, JSContext *ctx, int player)
 //;;
 JSValue convStructure(const STRUCTURE *psStruct, JSContext *ctx)
 {
-	bool aa = false;
-	bool ga = false;
-	bool indirect = false;
-	int range = -1;
-	for (int i = 0; i < psStruct->numWeaps; i++)
-	{
-		if (psStruct->asWeaps[i].nStat)
-		{
-			WEAPON_STATS *psWeap = &asWeaponStats[psStruct->asWeaps[i].nStat];
-			aa = aa || psWeap->surfaceToAir & SHOOT_IN_AIR;
-			ga = ga || psWeap->surfaceToAir & SHOOT_ON_GROUND;
-			indirect = indirect || psWeap->movementModel == MM_INDIRECT || psWeap->movementModel == MM_HOMINGINDIRECT;
-			range = MAX(proj_GetLongRange(psWeap, psStruct->player), range);
-		}
-	}
 	JSValue value = convObj(psStruct, ctx);
-	QuickJS_DefinePropertyValue(ctx, value, "isCB", JS_NewBool(ctx, structCBSensor(psStruct)), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "isSensor", JS_NewBool(ctx, structStandardSensor(psStruct)), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "canHitAir", JS_NewBool(ctx, aa), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "canHitGround", JS_NewBool(ctx, ga), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "hasIndirect", JS_NewBool(ctx, indirect), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "isRadarDetector", JS_NewBool(ctx, objRadarDetector(psStruct)), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "range", JS_NewInt32(ctx, range), 0);
 	QuickJS_DefinePropertyValue(ctx, value, "status", JS_NewInt32(ctx, (int)psStruct->status), 0);
 	QuickJS_DefinePropertyValue(ctx, value, "health", JS_NewInt32(ctx, 100 * psStruct->body / MAX(1, structureBody(psStruct))), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "cost", JS_NewInt32(ctx, psStruct->pStructureType->powerToBuild), 0);
 	int stattype = 0;
 	switch (psStruct->pStructureType->type) // don't bleed our source insanities into the scripting world
 	{
@@ -809,29 +1409,7 @@ JSValue convStructure(const STRUCTURE *psStruct, JSContext *ctx)
 		break;
 	}
 	QuickJS_DefinePropertyValue(ctx, value, "stattype", JS_NewInt32(ctx, stattype), 0);
-	if (psStruct->pStructureType->type == REF_FACTORY || psStruct->pStructureType->type == REF_CYBORG_FACTORY
-	    || psStruct->pStructureType->type == REF_VTOL_FACTORY
-	    || psStruct->pStructureType->type == REF_RESEARCH
-	    || psStruct->pStructureType->type == REF_POWER_GEN)
-	{
-		QuickJS_DefinePropertyValue(ctx, value, "modules", JS_NewUint32(ctx, psStruct->capacity), 0);
-	}
-	else
-	{
-		QuickJS_DefinePropertyValue(ctx, value, "modules", JS_NULL, 0);
-	}
-	JSValue weaponlist = JS_NewArray(ctx);
-	for (int j = 0; j < psStruct->numWeaps; j++)
-	{
-		JSValue weapon = JS_NewObject(ctx);
-		const WEAPON_STATS *psStats = asWeaponStats + psStruct->asWeaps[j].nStat;
-		QuickJS_DefinePropertyValue(ctx, weapon, "fullname", JS_NewString(ctx, psStats->name.toUtf8().c_str()), 0);
-		QuickJS_DefinePropertyValue(ctx, weapon, "name", JS_NewString(ctx, psStats->id.toUtf8().c_str()), 0); // will be changed to contain full name
-		QuickJS_DefinePropertyValue(ctx, weapon, "id", JS_NewString(ctx, psStats->id.toUtf8().c_str()), 0);
-		QuickJS_DefinePropertyValue(ctx, weapon, "lastFired", JS_NewUint32(ctx, psStruct->asWeaps[j].lastFired), 0);
-		JS_DefinePropertyValueUint32(ctx, weaponlist, j, weapon, 0);
-	}
-	QuickJS_DefinePropertyValue(ctx, value, "weapons", weaponlist, 0);
+	// The other properties are read when needed, see structureLazyProperty().
 	return value;
 }
 
@@ -917,37 +1495,10 @@ JSValue convFeature(const FEATURE *psFeature, JSContext *ctx)
 //;;
 JSValue convDroid(const DROID *psDroid, JSContext *ctx)
 {
-	bool aa = false;
-	bool ga = false;
-	bool indirect = false;
-	int range = -1;
-	const BODY_STATS *psBodyStats = &asBodyStats[psDroid->asBits[COMP_BODY]];
-
-	for (int i = 0; i < psDroid->numWeaps; i++)
-	{
-		if (psDroid->asWeaps[i].nStat)
-		{
-			WEAPON_STATS *psWeap = &asWeaponStats[psDroid->asWeaps[i].nStat];
-			aa = aa || psWeap->surfaceToAir & SHOOT_IN_AIR;
-			ga = ga || psWeap->surfaceToAir & SHOOT_ON_GROUND;
-			indirect = indirect || psWeap->movementModel == MM_INDIRECT || psWeap->movementModel == MM_HOMINGINDIRECT;
-			range = MAX(proj_GetLongRange(psWeap, psDroid->player), range);
-		}
-	}
 	DROID_TYPE type = psDroid->droidType;
 	JSValue value = convObj(psDroid, ctx);
 	QuickJS_DefinePropertyValue(ctx, value, "action", JS_NewInt32(ctx, (int)psDroid->action), 0);
-	if (range >= 0)
-	{
-		QuickJS_DefinePropertyValue(ctx, value, "range", JS_NewInt32(ctx, range), 0);
-	}
-	else
-	{
-		QuickJS_DefinePropertyValue(ctx, value, "range", JS_NULL, 0);
-	}
 	QuickJS_DefinePropertyValue(ctx, value, "order", JS_NewInt32(ctx, (int)psDroid->order.type), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "cost", JS_NewUint32(ctx, calcDroidPower(psDroid)), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "hasIndirect", JS_NewBool(ctx, indirect), 0);
 	switch (psDroid->droidType) // hide some engine craziness
 	{
 	case DROID_CYBORG_CONSTRUCT:
@@ -961,42 +1512,10 @@ JSValue convDroid(const DROID *psDroid, JSContext *ctx)
 	default:
 		break;
 	}
-	QuickJS_DefinePropertyValue(ctx, value, "bodySize", JS_NewInt32(ctx, psBodyStats->size), 0);
-	if (isTransporter(psDroid))
-	{
-		QuickJS_DefinePropertyValue(ctx, value, "cargoCapacity", JS_NewInt32(ctx, TRANSPORTER_CAPACITY), 0);
-		QuickJS_DefinePropertyValue(ctx, value, "cargoLeft", JS_NewInt32(ctx, calcRemainingCapacity(psDroid)), 0);
-		QuickJS_DefinePropertyValue(ctx, value, "cargoCount", JS_NewUint32(ctx, psDroid->psGroup != nullptr? psDroid->psGroup->getNumMembers() : 0), 0);
-	}
-	QuickJS_DefinePropertyValue(ctx, value, "isRadarDetector", JS_NewBool(ctx, objRadarDetector(psDroid)), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "isCB", JS_NewBool(ctx, cbSensorDroid(psDroid)), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "isSensor", JS_NewBool(ctx, standardSensorDroid(psDroid)), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "canHitAir", JS_NewBool(ctx, aa), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "canHitGround", JS_NewBool(ctx, ga), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "isVTOL", JS_NewBool(ctx, isVtolDroid(psDroid)), 0);
 	QuickJS_DefinePropertyValue(ctx, value, "droidType", JS_NewInt32(ctx, (int)type), 0);
 	QuickJS_DefinePropertyValue(ctx, value, "experience", JS_NewFloat64(ctx, (double)psDroid->experience / 65536.0), 0);
 	QuickJS_DefinePropertyValue(ctx, value, "health", JS_NewFloat64(ctx, 100.0 / (double)psDroid->originalBody * (double)psDroid->body), 0);
-
-	QuickJS_DefinePropertyValue(ctx, value, "body", JS_NewString(ctx, asBodyStats[psDroid->asBits[COMP_BODY]].id.toUtf8().c_str()), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "propulsion", JS_NewString(ctx, asPropulsionStats[psDroid->asBits[COMP_PROPULSION]].id.toUtf8().c_str()), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "armed", JS_NewFloat64(ctx, 0.0), 0); // deprecated!
-
-	JSValue weaponlist = JS_NewArray(ctx);
-	for (int j = 0; j < psDroid->numWeaps; j++)
-	{
-		int armed = droidReloadBar(psDroid, &psDroid->asWeaps[j], j);
-		JSValue weapon = JS_NewObject(ctx);
-		const WEAPON_STATS *psStats = asWeaponStats + psDroid->asWeaps[j].nStat;
-		QuickJS_DefinePropertyValue(ctx, weapon, "fullname", JS_NewString(ctx, psStats->name.toUtf8().c_str()), 0);
-		QuickJS_DefinePropertyValue(ctx, weapon, "name", JS_NewString(ctx, psStats->id.toUtf8().c_str()), 0); // will be changed to contain full name
-		QuickJS_DefinePropertyValue(ctx, weapon, "id", JS_NewString(ctx, psStats->id.toUtf8().c_str()), 0);
-		QuickJS_DefinePropertyValue(ctx, weapon, "lastFired", JS_NewUint32(ctx, psDroid->asWeaps[j].lastFired), 0);
-		QuickJS_DefinePropertyValue(ctx, weapon, "armed", JS_NewInt32(ctx, armed), 0);
-		JS_DefinePropertyValueUint32(ctx, weaponlist, j, weapon, 0);
-	}
-	QuickJS_DefinePropertyValue(ctx, value, "weapons", weaponlist, 0);
-	QuickJS_DefinePropertyValue(ctx, value, "cargoSize", JS_NewInt32(ctx, transporterSpaceRequired(psDroid)), 0);
+	// The other properties are read when needed, see droidLazyProperty().
 	return value;
 }
 
@@ -1022,18 +1541,15 @@ JSValue convDroid(const DROID *psDroid, JSContext *ctx)
 //;;
 JSValue convObj(const BASE_OBJECT *psObj, JSContext *ctx)
 {
-	JSValue value = JS_NewObject(ctx);
-	ASSERT_OR_RETURN(value, psObj, "No object for conversion");
+	ASSERT_OR_RETURN(JS_NewObject(ctx), psObj, "No object for conversion");
+	JSValue value = newLazyGameObject(psObj, ctx);
 	QuickJS_DefinePropertyValue(ctx, value, "id", JS_NewUint32(ctx, psObj->id), 0);
 	QuickJS_DefinePropertyValue(ctx, value, "x", JS_NewInt32(ctx, map_coord(psObj->pos.x)), 0);
 	QuickJS_DefinePropertyValue(ctx, value, "y", JS_NewInt32(ctx, map_coord(psObj->pos.y)), 0);
 	QuickJS_DefinePropertyValue(ctx, value, "z", JS_NewInt32(ctx, map_coord(psObj->pos.z)), 0);
 	QuickJS_DefinePropertyValue(ctx, value, "player", JS_NewUint32(ctx, psObj->player), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "armour", JS_NewInt32(ctx, objArmour(psObj, WC_KINETIC)), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "thermal", JS_NewInt32(ctx, objArmour(psObj, WC_HEAT)), 0);
 	QuickJS_DefinePropertyValue(ctx, value, "type", JS_NewInt32(ctx, psObj->type), 0);
 	QuickJS_DefinePropertyValue(ctx, value, "selected", JS_NewUint32(ctx, psObj->selected), 0);
-	QuickJS_DefinePropertyValue(ctx, value, "name", JS_NewString(ctx, objInfo(psObj)), 0);
 	QuickJS_DefinePropertyValue(ctx, value, "born", JS_NewUint32(ctx, psObj->born), 0);
 	scripting_engine::GROUPMAP *psMap = scripting_engine::instance().getGroupMap(engineToInstanceMap.at(ctx));
 	if (psMap != nullptr && psMap->map().count(psObj) > 0) // FIXME:
@@ -1110,23 +1626,24 @@ JSValue convMax(const BASE_OBJECT *psObj, JSContext *ctx)
 static JSValue callFunction(JSContext *ctx, const std::string &function, std::vector<JSValue> &args, bool event = true)
 {
 	const auto instance = engineToInstanceMap.at(ctx);
+	LazyObjectScope lazyObjectScope(instance);
 	JSValue global_obj = instance->Get_Global_Obj();
+	std::shared_ptr<const quickjs_scripting_instance::EventHandlers> handlers = instance->eventHandlers(function);  // Held, since the script may add a namespace.
 	if (event)
 	{
-		// recurse into variants, if any
-		for (const std::string &s : instance->eventNamespaces)
+		// call the variants, if any
+		for (size_t i = 0; i + 1 < handlers->atoms.size(); ++i)
 		{
-			std::string funcName = s + function;
-			JSValue value = JS_GetPropertyStr(ctx, global_obj, funcName.c_str());
+			JSValue value = JS_GetProperty(ctx, global_obj, handlers->atoms[i]);
 			if (JS_IsFunction(ctx, value))
 			{
-				callFunction(ctx, funcName, args, event);
+				callFunction(ctx, handlers->names[i], args, false);
 			}
 			JS_FreeValue(ctx, value);
 		}
 	}
 	code_part level = event ? LOG_SCRIPT : LOG_ERROR;
-	JSValue value = JS_GetPropertyStr(ctx, global_obj, function.c_str());
+	JSValue value = JS_GetProperty(ctx, global_obj, handlers->atoms.back());
 	auto free_func_ref = gsl::finally([ctx, value] { JS_FreeValue(ctx, value); });  // establish exit action
 	if (!JS_IsFunction(ctx, value))
 	{
@@ -1137,7 +1654,8 @@ static JSValue callFunction(JSContext *ctx, const std::string &function, std::ve
 	}
 
 	JSValue result;
-	scripting_engine::instance().executeWithPerformanceMonitoring(instance, function, [ctx, &result, value, &args](){
+	scripting_engine::instance().executeWithPerformanceMonitoring(instance, function, [ctx, instance, &result, value, &args](){
+		scripting_engine::GameStateUnlock unlock(instance);
 		result = JS_Call(ctx, value, JS_UNDEFINED, (int)args.size(), args.data());
 	});
 
@@ -1204,6 +1722,7 @@ static JSValue callFunction(JSContext *ctx, const std::string &function, std::ve
 		{
 			JSContext *pCtx = ctx;
 			return [pCtx, func](const int player) {
+				LazyObjectScope lazyObjectScope(pCtx);
 				std::vector<JSValue> args;
 				args.push_back(JS_NewInt32(pCtx, player));
 				callFunction(pCtx, func.toUtf8(), args);
@@ -1755,6 +2274,50 @@ static JSValue callFunction(JSContext *ctx, const std::string &function, std::ve
 			}
 		};
 
+		template<>
+		struct unbox<wzapi::object_or_position_list>
+		{
+			wzapi::object_or_position_list operator()(size_t& idx, JSContext *ctx, int argc, JSValueConst *argv, const char *function)
+			{
+				if (argc <= idx)
+					return {};
+				JSValue list = argv[idx++];
+				wzapi::object_or_position_list result;
+				uint64_t length = 0;
+				bool isArray = QuickJS_GetArrayLength(ctx, list, length);
+				UNBOX_SCRIPT_ASSERT(context, isArray, "Expected an array of game objects or positions");
+				result.entries.reserve(length);
+				for (uint32_t k = 0; k < length; k++)
+				{
+					JSValue item = JS_GetPropertyUint32(ctx, list, k);
+					JSValue typeVal = JS_GetPropertyStr(ctx, item, "type");
+					int type = JS_IsNumber(typeVal) ? JSValueToInt32(ctx, typeVal) : -1;
+					JS_FreeValue(ctx, typeVal);
+					wzapi::object_or_position_list::entry entry;
+					if (type == OBJ_DROID || type == OBJ_STRUCTURE || type == OBJ_FEATURE)
+					{
+						int oid = QuickJS_GetInt32(ctx, item, "id");
+						int oplayer = QuickJS_GetInt32(ctx, item, "player");
+						entry.psObj = IdToObject((OBJECT_TYPE)type, oid, oplayer);
+						UNBOX_SCRIPT_ASSERT(context, entry.psObj, "No such object id %d belonging to player %d", oid, oplayer);
+						if (entry.psObj == nullptr)
+						{
+							JS_FreeValue(ctx, item);
+							return {};
+						}
+						entry.pos = entry.psObj->pos.xy();
+					}
+					else
+					{
+						entry.pos = Vector2i(world_coord(QuickJS_GetInt32(ctx, item, "x")), world_coord(QuickJS_GetInt32(ctx, item, "y")));  // As enumRange() does.
+					}
+					JS_FreeValue(ctx, item);
+					result.entries.push_back(entry);
+				}
+				return result;
+			}
+		};
+
 		template<typename T>
 		JSValue box(T a, JSContext *);
 
@@ -2159,6 +2722,12 @@ static JSValue callFunction(JSContext *ctx, const std::string &function, std::ve
 		template <typename... Args>
 		bool wrap_event_handler__(const std::string &functionName, JSContext *context, Args&&... args)
 		{
+			ASSERT_OR_RETURN(false, !engineToInstanceMap.at(context)->isRunningConcurrently(), "%s triggered while scripts run concurrently, the calling API function should be deferred", functionName.c_str());
+			if (!engineToInstanceMap.at(context)->handlesEvent(functionName))
+			{
+				return true;  // Don't bother converting the arguments.
+			}
+			LazyObjectScope lazyObjectScope(context);
 			std::vector<JSValue> args_list;
 			using expander = int[];
 //			WZ_DECL_UNUSED int dummy[] = { 0, ((void) append_value_list(args_list, std::forward<Args>(args), engine),0)... };
@@ -2304,7 +2873,7 @@ static JSValue js_include(JSContext *ctx, JSValueConst this_val, int argc, JSVal
 		JS_ThrowReferenceError(ctx, "Failed to read include file \"%s\" (path=%s, name=%s)", path.c_str(), basePath.c_str(), basename.filePath().toUtf8().constData());
 		return JS_FALSE;
 	}
-	JSValue compiledFuncObj = JS_Eval(ctx, bytes, size, path.c_str(), JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+	JSValue compiledFuncObj = compileScript(ctx, bytes, size, path);
 	free(bytes);
 	if (JS_IsException(compiledFuncObj))
 	{
@@ -2346,6 +2915,7 @@ static uniqueTimerID SetQuickJSTimer(JSContext *ctx, int player, const std::stri
 	  // timerFunc
 	, [ctx, funcName](uniqueTimerID timerID, BASE_OBJECT* baseObject, timerAdditionalData* additionalParams) {
 		quickjs_timer_additionaldata* pData = static_cast<quickjs_timer_additionaldata*>(additionalParams);
+		LazyObjectScope lazyObjectScope(ctx);
 		std::vector<JSValue> args;
 		if (baseObject != nullptr)
 		{
@@ -2516,7 +3086,7 @@ static JSValue js_namespace(JSContext *ctx, JSValueConst this_val, int argc, JSV
 	SCRIPT_ASSERT(ctx, JS_IsString(argv[0]), "Must provide a string namespace prefix");
 	std::string prefix = JSValueToStdString(ctx, argv[0]);
 	auto instance = engineToInstanceMap.at(ctx);
-	instance->eventNamespaces.push_back(prefix);
+	instance->addEventNamespace(prefix);
 	return JS_TRUE;
 }
 
@@ -2771,7 +3341,7 @@ ScriptMapData runMapScript_QuickJS(WzString const &path, uint64_t seed, bool pre
 		debug(LOG_ERROR, "Failed to read script file \"%s\"", path.toUtf8().c_str());
 		return data;
 	}
-	JSValue compiledScriptObj = JS_Eval(ctx, bytes, size, path.toUtf8().c_str(), JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+	JSValue compiledScriptObj = compileScript(ctx, bytes, size, path.toStdString());
 	free(bytes);
 	if (JS_IsException(compiledScriptObj))
 	{
@@ -2875,16 +3445,160 @@ bool QuickJS_EnumerateObjectProperties(JSContext *ctx, JSValue obj, const std::f
 	return true;
 }
 
+// MARK: Concurrent execution
+
+/// Calls func with the game state lock held, see scripting_engine::GameStateLock.
+template <JSCFunction *func>
+static JSValue js_withGameState(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+	scripting_engine::GameStateLock lock(engineToInstanceMap.at(ctx));
+	return func(ctx, this_val, argc, argv);
+}
+
+/// For API functions which change the game state. While the instance runs concurrently, the call is queued until
+/// endConcurrentExecution(), and the script gets true, since the outcome isn't known yet.
+template <JSCFunction *func>
+static JSValue js_deferredWhileConcurrent(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+	quickjs_scripting_instance *instance = engineToInstanceMap.at(ctx);
+	if (!instance->isRunningConcurrently())
+	{
+		return func(ctx, this_val, argc, argv);
+	}
+	instance->deferCall(func, argc, argv);
+	return JS_TRUE;
+}
+
+/// For API functions which change the game state, and return something the script needs at once, so can't be deferred.
+/// While the instance runs concurrently, the call fails, and the instance's timers run on the main thread from then on.
+template <JSCFunction *func>
+static JSValue js_rejectedWhileConcurrent(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+	quickjs_scripting_instance *instance = engineToInstanceMap.at(ctx);
+	if (!instance->isRunningConcurrently())
+	{
+		return func(ctx, this_val, argc, argv);
+	}
+	if (instance->mayRunConcurrently())
+	{
+		debug(LOG_WARNING, "%s changes the game state from a concurrently running timer, running its timers on the main thread from now on", instance->scriptName().c_str());
+		instance->setMayRunConcurrently(false);
+	}
+	return JS_ThrowInternalError(ctx, "Function can't be called while the timers of AI scripts run concurrently");
+}
+
+void quickjs_scripting_instance::beginConcurrentExecution()
+{
+	JS_UpdateStackTop(rt);  // On the worker thread's stack now.
+}
+
+void quickjs_scripting_instance::endConcurrentExecution()
+{
+	JS_UpdateStackTop(rt);
+	std::vector<DeferredCall> calls;
+	calls.swap(deferredCalls);
+	LazyObjectScope lazyObjectScope(this);
+	for (auto &call : calls)
+	{
+		JSValue result = call.function(ctx, JS_UNDEFINED, static_cast<int>(call.args.size()), call.args.data());
+		if (JS_IsException(result))
+		{
+			JSValue err = JS_GetException(ctx);
+			const char *message = JS_ToCString(ctx, err);
+			debug(LOG_ERROR, "Deferred call by %s failed: %s", scriptName().c_str(), message != nullptr ? message : "<unknown error>");
+			JS_FreeCString(ctx, message);
+			JS_FreeValue(ctx, err);
+		}
+		JS_FreeValue(ctx, result);
+		std::for_each(call.args.begin(), call.args.end(), [this](JSValue &val) { JS_FreeValue(ctx, val); });
+	}
+}
+
+void quickjs_scripting_instance::deferCall(JSCFunction *function, int argc, JSValueConst *argv)
+{
+	DeferredCall call;
+	call.function = function;
+	for (int i = 0; i < argc; ++i)
+	{
+		call.args.push_back(JS_DupValue(ctx, argv[i]));
+	}
+	deferredCalls.push_back(std::move(call));
+}
+
+void quickjs_scripting_instance::configureMemory()
+{
+	if (war_getScriptMemoryLimit() > 0)
+	{
+		JS_SetMemoryLimit(rt, static_cast<size_t>(war_getScriptMemoryLimit()) * 1024 * 1024);
+	}
+	if (war_getScriptGCThreshold() > 0)
+	{
+		minGCThreshold = static_cast<size_t>(war_getScriptGCThreshold()) * 1024;
+	}
+	if (war_getScriptGCBudget() > 0)
+	{
+		gcThreshold = minGCThreshold;
+		JS_SetGCThreshold(rt, static_cast<size_t>(-1));  // Only collect in collectGarbage().
+	}
+	else
+	{
+		JS_SetGCThreshold(rt, minGCThreshold);
+	}
+}
+
+bool quickjs_scripting_instance::needsGarbageCollection() const
+{
+	return gcThreshold != 0 && JS_GetMallocSize(rt) > gcThreshold;
+}
+
+void quickjs_scripting_instance::collectGarbage()
+{
+	auto begin = std::chrono::steady_clock::now();
+	JS_RunGC(rt);
+	gcTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+	++gcCount;
+	if (gcThreshold != 0)
+	{
+		// Wait for the heap to grow by half again, like QuickJS does when it collects by itself.
+		size_t size = JS_GetMallocSize(rt);
+		gcThreshold = std::max(minGCThreshold, size + size / 2);
+	}
+}
+
+nlohmann::json quickjs_scripting_instance::debugGetMemoryUsage()
+{
+	JSMemoryUsage usage;
+	JS_ComputeMemoryUsage(rt, &usage);
+	nlohmann::json result = nlohmann::json::object();
+	result["mallocSize"] = usage.malloc_size;
+	if (war_getScriptMemoryLimit() > 0)
+	{
+		result["mallocLimit"] = usage.malloc_limit;
+	}
+	result["memoryUsedSize"] = usage.memory_used_size;
+	result["objects"] = usage.obj_count;
+	result["arrays"] = usage.array_count;
+	result["strings"] = usage.str_count;
+	result["functions"] = usage.js_func_count;
+	if (gcThreshold != 0)
+	{
+		result["gcThreshold"] = gcThreshold;
+	}
+	result["gcCount"] = gcCount;
+	result["gcTimeMsec"] = gcTime / 1000;
+	return result;
+}
+
 static const JSCFunctionListEntry js_builtin_funcs[] = {
-	QJS_CFUNC_DEF("setTimer", 2, js_setTimer ), // JS-specific implementation
-	QJS_CFUNC_DEF("queue", 1, js_queue ), // JS-specific implementation
-	QJS_CFUNC_DEF("removeTimer", 1, js_removeTimer ), // JS-specific implementation
-	QJS_CFUNC_DEF("profile", 1, js_profile ), // JS-specific implementation
-	QJS_CFUNC_DEF("include", 1, js_include ), // backend-specific (a scripting_instance can't directly include a different type of script)
-	QJS_CFUNC_DEF("namespace", 1, js_namespace ), // JS-specific implementation
-	QJS_CFUNC_DEF("debugGetCallerFuncObject", 0, debugGetCallerFuncObject ), // backend-specific
-	QJS_CFUNC_DEF("debugGetCallerFuncName", 0, debugGetCallerFuncName ), // backend-specific
-	QJS_CFUNC_DEF("debugGetBacktrace", 0, debugGetBacktrace ) // backend-specific
+	QJS_CFUNC_DEF("setTimer", 2, js_deferredWhileConcurrent<js_setTimer> ), // JS-specific implementation
+	QJS_CFUNC_DEF("queue", 1, js_deferredWhileConcurrent<js_queue> ), // JS-specific implementation
+	QJS_CFUNC_DEF("removeTimer", 1, js_deferredWhileConcurrent<js_removeTimer> ), // JS-specific implementation
+	QJS_CFUNC_DEF("profile", 1, js_withGameState<js_profile> ), // JS-specific implementation
+	QJS_CFUNC_DEF("include", 1, js_withGameState<js_include> ), // backend-specific (a scripting_instance can't directly include a different type of script)
+	QJS_CFUNC_DEF("namespace", 1, js_withGameState<js_namespace> ), // JS-specific implementation
+	QJS_CFUNC_DEF("debugGetCallerFuncObject", 0, js_withGameState<debugGetCallerFuncObject> ), // backend-specific
+	QJS_CFUNC_DEF("debugGetCallerFuncName", 0, js_withGameState<debugGetCallerFuncName> ), // backend-specific
+	QJS_CFUNC_DEF("debugGetBacktrace", 0, js_withGameState<debugGetBacktrace> ) // backend-specific
 };
 
 bool quickjs_scripting_instance::loadScript(const WzString& path, int player, int difficulty)
@@ -2897,7 +3611,7 @@ bool quickjs_scripting_instance::loadScript(const WzString& path, int player, in
 		return false;
 	}
 	m_path = path.toUtf8();
-	compiledScriptObj = JS_Eval(ctx, bytes, size, path.toUtf8().c_str(), JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+	compiledScriptObj = compileScript(ctx, bytes, size, path.toStdString());
 	free(bytes);
 	if (JS_IsException(compiledScriptObj))
 	{
@@ -2927,6 +3641,7 @@ bool quickjs_scripting_instance::loadScript(const WzString& path, int player, in
 
 bool quickjs_scripting_instance::readyInstanceForExecution()
 {
+	LazyObjectScope lazyObjectScope(this);
 	JSValue result = JS_EvalFunction(ctx, compiledScriptObj);
 	compiledScriptObj = JS_UNINITIALIZED;
 	if (JS_IsException(result))
@@ -2944,6 +3659,12 @@ bool quickjs_scripting_instance::readyInstanceForExecution()
 
 bool quickjs_scripting_instance::saveScriptGlobals(nlohmann::json &result)
 {
+	if (!globalsChanged)
+	{
+		// Campaign scripts in particular have lots of globals, don't convert them again if no script code ran since.
+		result = savedGlobals;
+		return true;
+	}
 	// we save 'scriptName' and 'me' implicitly
 	QuickJS_EnumerateObjectProperties(ctx, global_obj, [this, &result](const char *key, JSAtom &atom) {
         JSValue jsVal = JS_GetProperty(ctx, global_obj, atom);
@@ -2955,12 +3676,15 @@ bool quickjs_scripting_instance::saveScriptGlobals(nlohmann::json &result)
 		}
         JS_FreeValue(ctx, jsVal);
 	});
+	savedGlobals = result;
+	globalsChanged = false;
 	return true;
 }
 
 bool quickjs_scripting_instance::loadScriptGlobals(const nlohmann::json &result)
 {
 	ASSERT_OR_RETURN(false, result.is_object(), "Can't load script globals from non-json-object");
+	globalsChanged = true;
 	for (auto it : result.items())
 	{
 		// IMPORTANT: "null" JSON values *MUST* map to JS_UNDEFINED.
@@ -3015,6 +3739,7 @@ std::tuple<TimerFunc, std::unique_ptr<timerAdditionalData>> quickjs_scripting_in
 		// timerFunc
 		[pContext, funcName](uniqueTimerID timerID, BASE_OBJECT* baseObject, timerAdditionalData* additionalParams) {
 			quickjs_timer_additionaldata* pData = static_cast<quickjs_timer_additionaldata*>(additionalParams);
+			LazyObjectScope lazyObjectScope(pContext);
 			std::vector<JSValue> args;
 			if (baseObject != nullptr)
 			{
@@ -3063,6 +3788,7 @@ bool quickjs_scripting_instance::debugEvaluateCommand(const std::string &text)
 		compiledFuncObj = JS_UNINITIALIZED;
 		return false;
 	}
+	LazyObjectScope lazyObjectScope(this);
 	JSValue result = JS_EvalFunction(ctx, compiledFuncObj);
 	compiledFuncObj = JS_UNINITIALIZED;
 	if (JS_IsException(result))
@@ -3101,6 +3827,7 @@ void quickjs_scripting_instance::setSpecifiedGlobalVariables(const nlohmann::jso
 		return;
 	}
 	int propertyFlags = toQuickJSPropertyFlags(flags) | JS_PROP_ENUMERABLE;
+	globalsChanged = true;
 	bool markGlobalAsInternal = (flags & wzapi::GlobalVariableFlags::DoNotSave) == wzapi::GlobalVariableFlags::DoNotSave;
 	for (auto it : variables.items())
 	{
@@ -3117,6 +3844,7 @@ void quickjs_scripting_instance::setSpecifiedGlobalVariable(const std::string& n
 {
 	ASSERT(!name.empty(), "Empty key");
 	int propertyFlags = toQuickJSPropertyFlags(flags) | JS_PROP_ENUMERABLE;
+	globalsChanged = true;
 	bool markGlobalAsInternal = (flags & wzapi::GlobalVariableFlags::DoNotSave) == wzapi::GlobalVariableFlags::DoNotSave;
 	JS_DefinePropertyValueStr(ctx, global_obj, name.c_str(), mapJsonToQuickJSValue(ctx, value, propertyFlags), propertyFlags);
 	if (markGlobalAsInternal)
@@ -3127,9 +3855,105 @@ void quickjs_scripting_instance::setSpecifiedGlobalVariable(const std::string& n
 
 void quickjs_scripting_instance::doNotSaveGlobal(const std::string &global)
 {
+	globalsChanged = true;
 	internalNamespace.insert(global);
 }
 
+std::shared_ptr<const quickjs_scripting_instance::EventHandlers> quickjs_scripting_instance::eventHandlers(const std::string &function)
+{
+	auto it = eventDispatchTable.find(function);
+	if (it == eventDispatchTable.end())
+	{
+		auto handlers = std::make_shared<EventHandlers>(rt);
+		for (const std::string &prefix : eventNamespaces)
+		{
+			handlers->names.push_back(prefix + function);
+		}
+		handlers->names.push_back(function);
+		for (const std::string &name : handlers->names)
+		{
+			handlers->atoms.push_back(JS_NewAtomLen(ctx, name.c_str(), name.length()));
+		}
+		it = eventDispatchTable.emplace(function, std::move(handlers)).first;
+	}
+	return it->second;
+}
+
+bool quickjs_scripting_instance::handlesEvent(const std::string &function)
+{
+	for (JSAtom atom : eventHandlers(function)->atoms)
+	{
+		JSValue value = JS_GetProperty(ctx, global_obj, atom);
+		bool isFunction = JS_IsFunction(ctx, value);
+		JS_FreeValue(ctx, value);
+		if (isFunction)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/// Called by QuickJS every so often while running the script, to let us interrupt it, we take profiler samples instead.
+int quickjs_scripting_instance::profilerInterruptHandler(JSRuntime *rt, void *opaque)
+{
+	quickjs_scripting_instance *instance = static_cast<quickjs_scripting_instance *>(opaque);
+	const int maxFrames = 128;
+	JSDebuggerStackFrame frames[maxFrames];
+	unsigned frameIds[maxFrames];
+	int count = js_debugger_get_stack(rt, frames, maxFrames);
+	for (int i = 0; i < count; ++i)
+	{
+		frameIds[i] = instance->profilerFrame(frames[i]);
+	}
+	scriptProfilerSample(instance, frameIds, count);
+	return 0;  // Carry on.
+}
+
+unsigned quickjs_scripting_instance::profilerFrame(JSDebuggerStackFrame const &frame)
+{
+	auto key = std::make_tuple(frame.function_name, frame.filename, frame.line);
+	auto it = profilerFrameIds.find(key);
+	if (it != profilerFrameIds.end())
+	{
+		return it->second;
+	}
+	unsigned id = scriptProfilerUnnamedFrame();  // Named by nameProfilerFrames().
+	JS_DupAtom(ctx, frame.function_name);
+	JS_DupAtom(ctx, frame.filename);
+	profilerFrameIds.emplace(key, id);
+	return id;
+}
+
+void quickjs_scripting_instance::nameProfilerFrames()
+{
+	for (auto const &it : profilerFrameIds)
+	{
+		JSAtom functionAtom = std::get<0>(it.first);
+		JSAtom fileAtom = std::get<1>(it.first);
+		std::string name = "(native)";
+		if (functionAtom != JS_ATOM_NULL)
+		{
+			const char *functionName = JS_AtomToCString(ctx, functionAtom);
+			name = functionName != nullptr && functionName[0] != '\0' ? functionName : "<anonymous>";
+			JS_FreeCString(ctx, functionName);
+			if (fileAtom != JS_ATOM_NULL)
+			{
+				const char *fileName = JS_AtomToCString(ctx, fileAtom);
+				name += std::string(" (") + (fileName != nullptr ? fileName : "?") + ":" + std::to_string(std::get<2>(it.first)) + ")";
+				JS_FreeCString(ctx, fileName);
+			}
+		}
+		scriptProfilerNameFrame(it.second, name);
+	}
+}
+
+void quickjs_scripting_instance::addEventNamespace(const std::string &prefix)
+{
+	eventNamespaces.push_back(prefix);
+	eventDispatchTable.clear();  // Entries in use by callFunction() are kept alive by it.
+}
+
 
 IMPL_EVENT_HANDLER_NO_PARAMS(eventGameInit)
 IMPL_EVENT_HANDLER_NO_PARAMS(eventStartLevel)
@@ -3187,6 +4011,7 @@ IMPL_EVENT_HANDLER(eventBeaconRemoved, int, int)
 IMPL_EVENT_HANDLER(eventGroupLoss, const BASE_OBJECT *, int, int)
 bool quickjs_scripting_instance::handle_eventArea(const std::string& label, const DROID *psDroid)
 {
+	LazyObjectScope lazyObjectScope(this);
 	std::vector<JSValue> args;
 	args.push_back(convDroid(psDroid, ctx));
 	std::string funcname = std::string("eventArea") + label;
@@ -3348,6 +4173,9 @@ IMPL_JS_FUNC(getScrollLimits, wzapi::getScrollLimits)
 IMPL_JS_FUNC(loadLevel, wzapi::loadLevel)
 IMPL_JS_FUNC(autoSave, wzapi::autoSave)
 IMPL_JS_FUNC(enumRange, wzapi::enumRange)
+IMPL_JS_FUNC(enumRangeNearest, wzapi::enumRangeNearest)
+IMPL_JS_FUNC(countRange, wzapi::countRange)
+IMPL_JS_FUNC(threatRange, wzapi::threatRange)
 IMPL_JS_FUNC(enumArea, scripting_engine::enumAreaJS)
 IMPL_JS_FUNC(addBeacon, wzapi::addBeacon)
 
@@ -3409,6 +4237,7 @@ IMPL_JS_FUNC(setRevealStatus, wzapi::setRevealStatus)
 
 static JSValue js_stats_get(JSContext *ctx, JSValueConst this_val)
 {
+	scripting_engine::GameStateLock lock(engineToInstanceMap.at(ctx));
 	JSValue currentFuncObj = js_debugger_get_current_funcObject(ctx);
 	int type = QuickJS_GetInt32(ctx, currentFuncObj, "type");
 	int player = QuickJS_GetInt32(ctx, currentFuncObj, "player");
@@ -3419,14 +4248,43 @@ static JSValue js_stats_get(JSContext *ctx, JSValueConst this_val)
 	return mapJsonToQuickJSValue(ctx, wzapi::getUpgradeStats(execution_context, player, name, type, index), JS_PROP_C_W_E);
 }
 
+/// Makes an upgrade stats assignment queued by js_stats_set(). The arguments are player, name, type, index and the value.
+static JSValue js_stats_set_deferred(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+	int32_t player = 0;
+	int32_t type = 0;
+	uint32_t index = 0;
+	const char *name = argc == 5 ? JS_ToCString(ctx, argv[1]) : nullptr;
+	if (name == nullptr || JS_ToInt32(ctx, &player, argv[0]) || JS_ToInt32(ctx, &type, argv[2]) || JS_ToUint32(ctx, &index, argv[3]))
+	{
+		JS_FreeCString(ctx, name);
+		return JS_ThrowTypeError(ctx, "Bad queued upgrade");
+	}
+	std::string nameStr = name;
+	JS_FreeCString(ctx, name);
+	quickjs_execution_context execution_context(ctx);
+	wzapi::setUpgradeStats(execution_context, player, nameStr, type, index, JSContextValue{ctx, argv[4]});
+	return JS_UNDEFINED;
+}
+
 static JSValue js_stats_set(JSContext *ctx, JSValueConst this_val, JSValueConst val)
 {
+	quickjs_scripting_instance *instance = engineToInstanceMap.at(ctx);
 	JSValue currentFuncObj = js_debugger_get_current_funcObject(ctx);
 	int type = QuickJS_GetInt32(ctx, currentFuncObj, "type");
 	int player = QuickJS_GetInt32(ctx, currentFuncObj, "player");
 	unsigned index = QuickJS_GetUint32(ctx, currentFuncObj, "index");
 	std::string name = QuickJS_GetStdString(ctx, currentFuncObj, "name");
 	JS_FreeValue(ctx, currentFuncObj);
+	if (instance->isRunningConcurrently())
+	{
+		// Queued like the API functions which change the game state, see js_deferredWhileConcurrent().
+		JSValue args[5] = {JS_NewInt32(ctx, player), JS_NewString(ctx, name.c_str()), JS_NewInt32(ctx, type), JS_NewUint32(ctx, index), val};
+		instance->deferCall(js_stats_set_deferred, 5, args);
+		JS_FreeValue(ctx, args[1]);
+		return JS_UNDEFINED;
+	}
+	scripting_engine::GameStateLock lock(instance);
 	quickjs_execution_context execution_context(ctx);
 	wzapi::setUpgradeStats(execution_context, player, name, type, index, JSContextValue{ctx, val});
 	// Now read value and return it
@@ -3508,19 +4366,45 @@ JSValue constructUpgradesQuickJSValue(JSContext *ctx)
 
 #define JS_REGISTER_FUNC(js_func_name, num_parameters) \
 	JS_SetPropertyStr(ctx, global_obj, #js_func_name, \
-		JS_NewCFunction(ctx, JS_FUNC_IMPL_NAME(js_func_name), #js_func_name, num_parameters));
+		JS_NewCFunction(ctx, js_withGameState<JS_FUNC_IMPL_NAME(js_func_name)>, #js_func_name, num_parameters));
 
 #define JS_REGISTER_FUNC2(js_func_name, min_num_parameters, max_num_parameters) \
 	JS_SetPropertyStr(ctx, global_obj, #js_func_name, \
-		JS_NewCFunction(ctx, JS_FUNC_IMPL_NAME(js_func_name), #js_func_name, min_num_parameters));
+		JS_NewCFunction(ctx, js_withGameState<JS_FUNC_IMPL_NAME(js_func_name)>, #js_func_name, min_num_parameters));
 
 #define JS_REGISTER_FUNC_NAME(js_func_name, num_parameters, full_impl_handler_func_name) \
 	JS_SetPropertyStr(ctx, global_obj, #js_func_name, \
-		JS_NewCFunction(ctx, full_impl_handler_func_name, #js_func_name, num_parameters));
+		JS_NewCFunction(ctx, js_withGameState<full_impl_handler_func_name>, #js_func_name, num_parameters));
 
 #define JS_REGISTER_FUNC_NAME2(js_func_name, min_num_parameters, max_num_parameters, full_impl_handler_func_name) \
 	JS_SetPropertyStr(ctx, global_obj, #js_func_name, \
-		JS_NewCFunction(ctx, full_impl_handler_func_name, #js_func_name, min_num_parameters));
+		JS_NewCFunction(ctx, js_withGameState<full_impl_handler_func_name>, #js_func_name, min_num_parameters));
+
+// For functions which change the game state, see js_deferredWhileConcurrent()
+#define JS_REGISTER_DEFERRED_FUNC(js_func_name, num_parameters) \
+	JS_SetPropertyStr(ctx, global_obj, #js_func_name, \
+		JS_NewCFunction(ctx, js_deferredWhileConcurrent<JS_FUNC_IMPL_NAME(js_func_name)>, #js_func_name, num_parameters));
+
+#define JS_REGISTER_DEFERRED_FUNC2(js_func_name, min_num_parameters, max_num_parameters) \
+	JS_SetPropertyStr(ctx, global_obj, #js_func_name, \
+		JS_NewCFunction(ctx, js_deferredWhileConcurrent<JS_FUNC_IMPL_NAME(js_func_name)>, #js_func_name, min_num_parameters));
+
+#define JS_REGISTER_DEFERRED_FUNC_NAME(js_func_name, num_parameters, full_impl_handler_func_name) \
+	JS_SetPropertyStr(ctx, global_obj, #js_func_name, \
+		JS_NewCFunction(ctx, js_deferredWhileConcurrent<full_impl_handler_func_name>, #js_func_name, num_parameters));
+
+#define JS_REGISTER_DEFERRED_FUNC_NAME2(js_func_name, min_num_parameters, max_num_parameters, full_impl_handler_func_name) \
+	JS_SetPropertyStr(ctx, global_obj, #js_func_name, \
+		JS_NewCFunction(ctx, js_deferredWhileConcurrent<full_impl_handler_func_name>, #js_func_name, min_num_parameters));
+
+// For functions which change the game state and return something new, see js_rejectedWhileConcurrent()
+#define JS_REGISTER_REJECTED_FUNC(js_func_name, num_parameters) \
+	JS_SetPropertyStr(ctx, global_obj, #js_func_name, \
+		JS_NewCFunction(ctx, js_rejectedWhileConcurrent<JS_FUNC_IMPL_NAME(js_func_name)>, #js_func_name, num_parameters));
+
+#define JS_REGISTER_REJECTED_FUNC2(js_func_name, min_num_parameters, max_num_parameters) \
+	JS_SetPropertyStr(ctx, global_obj, #js_func_name, \
+		JS_NewCFunction(ctx, js_rejectedWhileConcurrent<JS_FUNC_IMPL_NAME(js_func_name)>, #js_func_name, min_num_parameters));
 
 #define MAX_JS_VARARGS 20
 
@@ -3538,60 +4422,60 @@ bool quickjs_scripting_instance::registerFunctions(const std::string& scriptName
 	// Register functions to the script engine here
 	JS_REGISTER_FUNC_NAME(_, 1, JS_FUNC_IMPL_NAME(translate)); // WZAPI
 	JS_REGISTER_FUNC2(dump, 1, MAX_JS_VARARGS);
-	JS_REGISTER_FUNC(syncRandom, 1); // WZAPI
+	JS_REGISTER_REJECTED_FUNC(syncRandom, 1); // WZAPI
 	JS_REGISTER_FUNC_NAME2(label, 1, 3, JS_FUNC_IMPL_NAME(getObject)); // deprecated // scripting_engine
 	JS_REGISTER_FUNC2(getObject, 1, 3); // scripting_engine
-	JS_REGISTER_FUNC2(addLabel, 2, 3); // scripting_engine
-	JS_REGISTER_FUNC(removeLabel, 1); // scripting_engine
+	JS_REGISTER_DEFERRED_FUNC2(addLabel, 2, 3); // scripting_engine
+	JS_REGISTER_DEFERRED_FUNC(removeLabel, 1); // scripting_engine
 	JS_REGISTER_FUNC(getLabel, 1); // scripting_engine
 	JS_REGISTER_FUNC(enumLabels, 1); // scripting_engine
 	JS_REGISTER_FUNC(enumGateways, 0); // WZAPI
 	JS_REGISTER_FUNC(enumTemplates, 1);
 	JS_REGISTER_FUNC2(makeTemplate, 6, 6 + MAX_JS_VARARGS); // WZAPI
-	JS_REGISTER_FUNC(setAlliance, 3); // WZAPI
-	JS_REGISTER_FUNC(sendAllianceRequest, 1); // WZAPI
-	JS_REGISTER_FUNC(setAssemblyPoint, 3); // WZAPI
-	JS_REGISTER_FUNC(setSunPosition, 3); // WZAPI
-	JS_REGISTER_FUNC(setSunIntensity, 9); // WZAPI
-	JS_REGISTER_FUNC(setWeather, 1); // WZAPI
-	JS_REGISTER_FUNC(setSky, 3); // WZAPI
-	JS_REGISTER_FUNC(cameraSlide, 2); // WZAPI
-	JS_REGISTER_FUNC(cameraTrack, 1); // WZAPI
-	JS_REGISTER_FUNC(cameraZoom, 2); // WZAPI
-	JS_REGISTER_FUNC_NAME2(resetArea, 1, 2, JS_FUNC_IMPL_NAME(resetLabel)); // deprecated // scripting_engine
-	JS_REGISTER_FUNC2(resetLabel, 1, 2); // scripting_engine
-	JS_REGISTER_FUNC(addSpotter, 6); // WZAPI
-	JS_REGISTER_FUNC(removeSpotter, 1); // WZAPI
-	JS_REGISTER_FUNC2(syncRequest, 3, 5); // WZAPI
-	JS_REGISTER_FUNC(replaceTexture, 2); // WZAPI
-	JS_REGISTER_FUNC(changePlayerColour, 2); // WZAPI
-	JS_REGISTER_FUNC(setHealth, 2); // WZAPI
-	JS_REGISTER_FUNC(useSafetyTransport, 1); // WZAPI
-	JS_REGISTER_FUNC(restoreLimboMissionData, 0); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setAlliance, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(sendAllianceRequest, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setAssemblyPoint, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setSunPosition, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setSunIntensity, 9); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setWeather, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setSky, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(cameraSlide, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(cameraTrack, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(cameraZoom, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC_NAME2(resetArea, 1, 2, JS_FUNC_IMPL_NAME(resetLabel)); // deprecated // scripting_engine
+	JS_REGISTER_DEFERRED_FUNC2(resetLabel, 1, 2); // scripting_engine
+	JS_REGISTER_REJECTED_FUNC(addSpotter, 6); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(removeSpotter, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(syncRequest, 3, 5); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(replaceTexture, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(changePlayerColour, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setHealth, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(useSafetyTransport, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(restoreLimboMissionData, 0); // WZAPI
 	JS_REGISTER_FUNC(getMultiTechLevel, 0); // WZAPI
-	JS_REGISTER_FUNC(setCampaignNumber, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setCampaignNumber, 1); // WZAPI
 	JS_REGISTER_FUNC(getMissionType, 0); // WZAPI
 	JS_REGISTER_FUNC(getRevealStatus, 0); // WZAPI
-	JS_REGISTER_FUNC(setRevealStatus, 1); // WZAPI
-	JS_REGISTER_FUNC(autoSave, 0); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setRevealStatus, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(autoSave, 0); // WZAPI
 
 	// horrible hacks follow -- do not rely on these being present!
-	JS_REGISTER_FUNC(hackNetOff, 0); // WZAPI
-	JS_REGISTER_FUNC(hackNetOn, 0); // WZAPI
-	JS_REGISTER_FUNC(hackAddMessage, 4); // WZAPI
-	JS_REGISTER_FUNC(hackRemoveMessage, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(hackNetOff, 0); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(hackNetOn, 0); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(hackAddMessage, 4); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(hackRemoveMessage, 3); // WZAPI
 	JS_REGISTER_FUNC(hackGetObj, 3); // WZAPI
 	JS_REGISTER_FUNC2(hackAssert, 2, 2 + MAX_JS_VARARGS); // WZAPI
-	JS_REGISTER_FUNC2(hackMarkTiles, 1, 4); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(hackMarkTiles, 1, 4); // WZAPI
 	JS_REGISTER_FUNC2(receiveAllEvents, 0, 1); // WZAPI
-	JS_REGISTER_FUNC(hackDoNotSave, 1); // WZAPI
-	JS_REGISTER_FUNC(hackPlayIngameAudio, 0); // WZAPI
-	JS_REGISTER_FUNC(hackStopIngameAudio, 0); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(hackDoNotSave, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(hackPlayIngameAudio, 0); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(hackStopIngameAudio, 0); // WZAPI
 
 	// General functions -- geared for use in AI scripts
 	JS_REGISTER_FUNC2(debug, 1, 1 + MAX_JS_VARARGS);
-	JS_REGISTER_FUNC2(console, 1, 1 + MAX_JS_VARARGS); // WZAPI
-	JS_REGISTER_FUNC(clearConsole, 0); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(console, 1, 1 + MAX_JS_VARARGS); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(clearConsole, 0); // WZAPI
 	JS_REGISTER_FUNC(structureIdle, 1); // WZAPI
 	JS_REGISTER_FUNC2(enumStruct, 0, 3); // WZAPI
 	JS_REGISTER_FUNC2(enumStructOffWorld, 0, 3); // WZAPI
@@ -3602,17 +4486,20 @@ bool quickjs_scripting_instance::registerFunctions(const std::string& scriptName
 	JS_REGISTER_FUNC(enumSelected, 0); // WZAPI
 	JS_REGISTER_FUNC(enumResearch, 0); // WZAPI
 	JS_REGISTER_FUNC2(enumRange, 3, 5); // WZAPI
+	JS_REGISTER_FUNC2(enumRangeNearest, 3, 5); // WZAPI
+	JS_REGISTER_FUNC2(countRange, 2, 4); // WZAPI
+	JS_REGISTER_FUNC2(threatRange, 2, 4); // WZAPI
 	JS_REGISTER_FUNC2(enumArea, 1, 6); // scripting_engine
 	JS_REGISTER_FUNC2(getResearch, 1, 2); // WZAPI
-	JS_REGISTER_FUNC(pursueResearch, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(pursueResearch, 2); // WZAPI
 	JS_REGISTER_FUNC2(findResearch, 1, 2); // WZAPI
 	JS_REGISTER_FUNC(distBetweenTwoPoints, 4); // WZAPI
-	JS_REGISTER_FUNC(newGroup, 0); // scripting_engine
-	JS_REGISTER_FUNC(groupAddArea, 5); // scripting_engine
-	JS_REGISTER_FUNC(groupAddDroid, 2); // scripting_engine
-	JS_REGISTER_FUNC(groupAdd, 2); // scripting_engine
+	JS_REGISTER_REJECTED_FUNC(newGroup, 0); // scripting_engine
+	JS_REGISTER_DEFERRED_FUNC(groupAddArea, 5); // scripting_engine
+	JS_REGISTER_DEFERRED_FUNC(groupAddDroid, 2); // scripting_engine
+	JS_REGISTER_DEFERRED_FUNC(groupAdd, 2); // scripting_engine
 	JS_REGISTER_FUNC(groupSize, 1); // scripting_engine
-	JS_REGISTER_FUNC(orderDroidLoc, 4); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(orderDroidLoc, 4); // WZAPI
 	JS_REGISTER_FUNC(playerPower, 1); // WZAPI
 	JS_REGISTER_FUNC(queuedPower, 1); // WZAPI
 	JS_REGISTER_FUNC2(isStructureAvailable, 1, 2); // WZAPI
@@ -3621,83 +4508,83 @@ bool quickjs_scripting_instance::registerFunctions(const std::string& scriptName
 	JS_REGISTER_FUNC(propulsionCanReach, 5); // WZAPI
 	JS_REGISTER_FUNC(terrainType, 2); // WZAPI
 	JS_REGISTER_FUNC(tileIsBurning, 2); // WZAPI
-	JS_REGISTER_FUNC2(orderDroidBuild, 5, 6); // WZAPI
-	JS_REGISTER_FUNC(orderDroidObj, 3); // WZAPI
-	JS_REGISTER_FUNC(orderDroid, 2); // WZAPI
-	JS_REGISTER_FUNC2(buildDroid, 7, 7 + MAX_JS_VARARGS); // WZAPI
-	JS_REGISTER_FUNC2(addDroid, 9, 9 + MAX_JS_VARARGS); // WZAPI
-	JS_REGISTER_FUNC(addDroidToTransporter, 2); // WZAPI
-	JS_REGISTER_FUNC(addFeature, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(orderDroidBuild, 5, 6); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(orderDroidObj, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(orderDroid, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(buildDroid, 7, 7 + MAX_JS_VARARGS); // WZAPI
+	JS_REGISTER_REJECTED_FUNC2(addDroid, 9, 9 + MAX_JS_VARARGS); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(addDroidToTransporter, 2); // WZAPI
+	JS_REGISTER_REJECTED_FUNC(addFeature, 3); // WZAPI
 	JS_REGISTER_FUNC2(componentAvailable, 1, 2); // WZAPI
 	JS_REGISTER_FUNC(isVTOL, 1); // WZAPI
 	JS_REGISTER_FUNC(safeDest, 3); // WZAPI
-	JS_REGISTER_FUNC2(activateStructure, 1, 2); // WZAPI
-	JS_REGISTER_FUNC(chat, 2); // WZAPI
-	JS_REGISTER_FUNC2(addBeacon, 3, 4); // WZAPI
-	JS_REGISTER_FUNC(removeBeacon, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(activateStructure, 1, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(chat, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(addBeacon, 3, 4); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(removeBeacon, 1); // WZAPI
 	JS_REGISTER_FUNC(getDroidProduction, 1); // WZAPI
 	JS_REGISTER_FUNC2(getDroidLimit, 0, 2); // WZAPI
 	JS_REGISTER_FUNC(getExperienceModifier, 1); // WZAPI
-	JS_REGISTER_FUNC2(setDroidLimit, 2, 3); // WZAPI
-	JS_REGISTER_FUNC(setCommanderLimit, 2); // deprecated!!
-	JS_REGISTER_FUNC(setConstructorLimit, 2); // deprecated!!
-	JS_REGISTER_FUNC(setExperienceModifier, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(setDroidLimit, 2, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setCommanderLimit, 2); // deprecated!!
+	JS_REGISTER_DEFERRED_FUNC(setConstructorLimit, 2); // deprecated!!
+	JS_REGISTER_DEFERRED_FUNC(setExperienceModifier, 2); // WZAPI
 	JS_REGISTER_FUNC(getWeaponInfo, 1); // WZAPI // deprecated!!
 	JS_REGISTER_FUNC(enumCargo, 1); // WZAPI
 
 	// Functions that operate on the current player only
-	JS_REGISTER_FUNC(centreView, 2); // WZAPI
-	JS_REGISTER_FUNC2(playSound, 1, 4); // WZAPI
-	JS_REGISTER_FUNC2(gameOverMessage, 1, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(centreView, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(playSound, 1, 4); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(gameOverMessage, 1, 3); // WZAPI
 
 	// Global state manipulation -- not for use with skirmish AI (unless you want it to cheat, obviously)
-	JS_REGISTER_FUNC2(setStructureLimits, 2, 3); // WZAPI
-	JS_REGISTER_FUNC(applyLimitSet, 0); // WZAPI
-	JS_REGISTER_FUNC(setMissionTime, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(setStructureLimits, 2, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(applyLimitSet, 0); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setMissionTime, 1); // WZAPI
 	JS_REGISTER_FUNC(getMissionTime, 0); // WZAPI
-	JS_REGISTER_FUNC(setReinforcementTime, 1); // WZAPI
-	JS_REGISTER_FUNC2(completeResearch, 1, 3); // WZAPI
-	JS_REGISTER_FUNC2(completeAllResearch, 0, 1); // WZAPI
-	JS_REGISTER_FUNC2(enableResearch, 1, 2); // WZAPI
-	JS_REGISTER_FUNC2(setPower, 1, 2); // WZAPI
-	JS_REGISTER_FUNC2(setPowerModifier, 1, 2); // WZAPI
-	JS_REGISTER_FUNC2(setPowerStorageMaximum, 1, 2); // WZAPI
-	JS_REGISTER_FUNC2(extraPowerTime, 1, 2); // WZAPI
-	JS_REGISTER_FUNC(setTutorialMode, 1); // WZAPI
-	JS_REGISTER_FUNC(setDesign, 1); // WZAPI
-	JS_REGISTER_FUNC(enableTemplate, 1); // WZAPI
-	JS_REGISTER_FUNC(removeTemplate, 1); // WZAPI
-	JS_REGISTER_FUNC(setMiniMap, 1); // WZAPI
-	JS_REGISTER_FUNC2(setReticuleButton, 4, 5); // WZAPI
-	JS_REGISTER_FUNC(setReticuleFlash, 2); // WZAPI
-	JS_REGISTER_FUNC(showReticuleWidget, 1); // WZAPI
-	JS_REGISTER_FUNC(showInterface, 0); // WZAPI
-	JS_REGISTER_FUNC(hideInterface, 0); // WZAPI
-	JS_REGISTER_FUNC_NAME(addReticuleButton, 1, JS_FUNC_IMPL_NAME(removeReticuleButton)); // deprecated!!
-	JS_REGISTER_FUNC(removeReticuleButton, 1); // deprecated!!
-	JS_REGISTER_FUNC2(enableStructure, 1, 2); // WZAPI
-	JS_REGISTER_FUNC(makeComponentAvailable, 2); // WZAPI
-	JS_REGISTER_FUNC(enableComponent, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setReinforcementTime, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(completeResearch, 1, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(completeAllResearch, 0, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(enableResearch, 1, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(setPower, 1, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(setPowerModifier, 1, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(setPowerStorageMaximum, 1, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(extraPowerTime, 1, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setTutorialMode, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setDesign, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(enableTemplate, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(removeTemplate, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setMiniMap, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(setReticuleButton, 4, 5); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setReticuleFlash, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(showReticuleWidget, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(showInterface, 0); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(hideInterface, 0); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC_NAME(addReticuleButton, 1, JS_FUNC_IMPL_NAME(removeReticuleButton)); // deprecated!!
+	JS_REGISTER_DEFERRED_FUNC(removeReticuleButton, 1); // deprecated!!
+	JS_REGISTER_DEFERRED_FUNC2(enableStructure, 1, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(makeComponentAvailable, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(enableComponent, 2); // WZAPI
 	JS_REGISTER_FUNC(allianceExistsBetween, 2); // WZAPI
-	JS_REGISTER_FUNC(removeStruct, 1); // WZAPI // deprecated!!
-	JS_REGISTER_FUNC2(removeObject, 1, 2); // WZAPI
-	JS_REGISTER_FUNC_NAME(setScrollParams, 4, JS_FUNC_IMPL_NAME(setScrollLimits)); // deprecated!!
-	JS_REGISTER_FUNC(setScrollLimits, 4); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(removeStruct, 1); // WZAPI // deprecated!!
+	JS_REGISTER_DEFERRED_FUNC2(removeObject, 1, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC_NAME(setScrollParams, 4, JS_FUNC_IMPL_NAME(setScrollLimits)); // deprecated!!
+	JS_REGISTER_DEFERRED_FUNC(setScrollLimits, 4); // WZAPI
 	JS_REGISTER_FUNC(getScrollLimits, 0); // WZAPI
-	JS_REGISTER_FUNC(addStructure, 4); // WZAPI
+	JS_REGISTER_REJECTED_FUNC(addStructure, 4); // WZAPI
 	JS_REGISTER_FUNC2(getStructureLimit, 1, 2); // WZAPI
 	JS_REGISTER_FUNC2(countStruct, 1, 2); // WZAPI
 	JS_REGISTER_FUNC2(countDroid, 0, 2); // WZAPI
-	JS_REGISTER_FUNC(loadLevel, 1); // WZAPI
-	JS_REGISTER_FUNC(setDroidExperience, 2); // WZAPI
-	JS_REGISTER_FUNC(donateObject, 2); // WZAPI
-	JS_REGISTER_FUNC(donatePower, 2); // WZAPI
-	JS_REGISTER_FUNC(setNoGoArea, 5); // WZAPI
-	JS_REGISTER_FUNC(startTransporterEntry, 3); // WZAPI
-	JS_REGISTER_FUNC(setTransporterExit, 3); // WZAPI
-	JS_REGISTER_FUNC(setObjectFlag, 3); // WZAPI
-	JS_REGISTER_FUNC2(fireWeaponAtLoc, 3, 4); // WZAPI
-	JS_REGISTER_FUNC2(fireWeaponAtObj, 2, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(loadLevel, 1); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setDroidExperience, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(donateObject, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(donatePower, 2); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setNoGoArea, 5); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(startTransporterEntry, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setTransporterExit, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC(setObjectFlag, 3); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(fireWeaponAtLoc, 3, 4); // WZAPI
+	JS_REGISTER_DEFERRED_FUNC2(fireWeaponAtObj, 2, 3); // WZAPI
 
 	return true;
 }
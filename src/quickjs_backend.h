@@ -26,4 +26,7 @@
 wzapi::scripting_instance* createQuickJSScriptInstance(const WzString& path, int player, int difficulty);
 ScriptMapData runMapScript_QuickJS(WzString const &path, uint64_t seed, bool preview);
 
+/// Called when a game object is destroyed, so that QuickJS scripts stop reading properties from it.
+void snapshotQuickJSObject(const BASE_OBJECT *psObj);
+
 #endif
@@ -346,8 +346,13 @@ bool loadResearch(WzConfig &ini)
 			if (preResItem != nullptr)
 			{
 				asResearch[inc].pPRList.push_back(preResItem->index);
+				asResearch[preResItem->index].pDependentList.push_back(inc);
 			}
 		}
+		for (auto &playerResList : asPlayerResList)
+		{
+			playerResList[inc].missingPrerequisites = asResearch[inc].pPRList.size();
+		}
 	}
 
 	return true;
@@ -364,8 +369,8 @@ bool researchAvailable(int inc, int playerID, QUEUE_MODE mode)
 		IsResearchStartedFunc = IsResearchStarted;
 	}
 
-	UDWORD				incPR, incS;
-	bool				bPRFound, bStructFound;
+	UDWORD				incS;
+	bool				bStructFound;
 
 	// if its a cancelled topic - add to list
 	if (IsResearchCancelledFunc(&asPlayerResList[playerID][inc]))
@@ -415,17 +420,7 @@ bool researchAvailable(int inc, int playerID, QUEUE_MODE mode)
 		}
 
 		// check for pre-requisites
-		bPRFound = true;
-		for (incPR = 0; incPR < asResearch[inc].pPRList.size(); incPR++)
-		{
-			if (IsResearchCompleted(&(asPlayerResList[playerID][asResearch[inc].pPRList[incPR]])) == 0)
-			{
-				// if haven't pre-requisite - quit checking rest
-				bPRFound = false;
-				break;
-			}
-		}
-		if (!bPRFound)
+		if (asPlayerResList[playerID][inc].missingPrerequisites != 0)
 		{
 			// if haven't pre-requisites, skip the rest of the checks
 			return false;
@@ -502,6 +497,17 @@ void researchResult(UDWORD researchIndex, UBYTE player, bool bDisplay, STRUCTURE
 
 	MakeResearchCompleted(&asPlayerResList[player][researchIndex]);
 
+	// Loading a game marks the research as completed before getting here, so keep track of whether the dependents know.
+	if (!asPlayerResList[player][researchIndex].countedByDependents)
+	{
+		asPlayerResList[player][researchIndex].countedByDependents = true;
+		for (UWORD dependent : pResearch->pDependentList)
+		{
+			ASSERT(asPlayerResList[player][dependent].missingPrerequisites > 0, "Pre-requisites of %s counted twice", getStatsName(&asResearch[dependent]));
+			--asPlayerResList[player][dependent].missingPrerequisites;
+		}
+	}
+
 	//check for structures to be made available
 	for (unsigned short pStructureResult : pResearch->pStructureResults)
 	{
@@ -1396,15 +1402,9 @@ static void RecursivelyDisableResearchByID(size_t index)
 		DisableResearch(&asPlayerResList[player][index]);
 	}
 
-	for (size_t inc = 0; inc < asResearch.size(); inc++)
+	for (UWORD dependent : asResearch[index].pDependentList)
 	{
-		for (size_t prereq = 0; prereq < asResearch[inc].pPRList.size(); prereq++)
-		{
-			if (asResearch[inc].pPRList[prereq] == index)
-			{
-				RecursivelyDisableResearchByID(inc);
-			}
-		}
+		RecursivelyDisableResearchByID(dependent);
 	}
 }
 
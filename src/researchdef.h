@@ -55,6 +55,7 @@ struct RESEARCH : public BASE_STATS
 										   this topic must be explicitly enabled*/
 	UBYTE			disabledWhen;		/* flags when to disable tech */
 	std::vector<UWORD>	pPRList;		///< List of research pre-requisites
+	std::vector<UWORD>	pDependentList;		///< List of research which has this one as a pre-requisite
 	std::vector<UWORD>	pStructList;		///< List of structures that when built would enable this research
 	std::vector<UWORD>	pRedStructs;		///< List of Structures that become redundant
 	std::vector<COMPONENT_STATS *> pRedArtefacts;	///< List of Artefacts that become redundant
@@ -80,6 +81,9 @@ struct PLAYER_RESEARCH
 	UBYTE		ResearchStatus;			// Bit flags   ...  see below
 
 	UBYTE           possible;                       ///< is the research possible ... so can enable topics vis scripts
+
+	UWORD           missingPrerequisites;           ///< Number of pre-requisites not yet researched, kept up to date by researchResult()
+	bool            countedByDependents;            ///< Whether researchResult() has already counted this topic in missingPrerequisites of its dependents
 };
 
 #define STARTED_RESEARCH           0x01            // research in progress
@@ -0,0 +1,297 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file scriptprofiler.cpp
+ *
+ * Sampling profiler for scripts. The performance data in the script logs only says which events and timers
+ * are slow; this says which script functions they spend the time in.
+ *
+ * The backend samples the script's call stack now and then while it runs (QuickJS does so from its interrupt
+ * handler), and each sample is charged the time since the previous one. The time between the last sample and
+ * the end of the call is charged to the event itself. Samples are kept as a call tree per script instance,
+ * whose root's children are the events and timers.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/framework/physfs_ext.h"
+#include "lib/framework/wzapp.h"
+#include "lib/framework/wztime.h"
+
+#include "scriptprofiler.h"
+#include "wzapi.h"
+
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+
+struct ProfileNode
+{
+	explicit ProfileNode(unsigned frame) : frame(frame) {}
+
+	unsigned frame;
+	uint64_t selfTime = 0;                  ///< Microseconds.
+	uint64_t samples = 0;
+	std::map<unsigned, size_t> children;    ///< Node indices by frame.
+};
+
+struct InstanceProfile
+{
+	std::string scriptName;
+	int player = 0;
+	std::vector<ProfileNode> nodes{ProfileNode{0}};  ///< nodes[0] is the root.
+	int callDepth = 0;
+	size_t eventNode = 0;
+	std::chrono::steady_clock::time_point lastSample;
+};
+
+static bool profilerEnabled = false;
+static wz::mutex profilerMutex;  ///< For everything below.
+static std::vector<std::string> frameNames{"<script>"};
+static std::unordered_map<std::string, unsigned> frameIds;
+static std::unordered_map<wzapi::scripting_instance *, InstanceProfile> profiles;
+static std::vector<InstanceProfile> reportedProfiles;
+
+void scriptProfilerSetEnabled(bool enabled)
+{
+	profilerEnabled = enabled;
+}
+
+bool scriptProfilerEnabled()
+{
+	return profilerEnabled;
+}
+
+static unsigned frameLocked(const std::string &name)
+{
+	auto it = frameIds.find(name);
+	if (it == frameIds.end())
+	{
+		it = frameIds.emplace(name, static_cast<unsigned>(frameNames.size())).first;
+		frameNames.push_back(name);
+	}
+	return it->second;
+}
+
+unsigned scriptProfilerFrame(const std::string &name)
+{
+	std::lock_guard<wz::mutex> lock(profilerMutex);
+	return frameLocked(name);
+}
+
+unsigned scriptProfilerUnnamedFrame()
+{
+	std::lock_guard<wz::mutex> lock(profilerMutex);
+	frameNames.push_back("<unnamed>");
+	return static_cast<unsigned>(frameNames.size() - 1);
+}
+
+void scriptProfilerNameFrame(unsigned frame, const std::string &name)
+{
+	std::lock_guard<wz::mutex> lock(profilerMutex);
+	ASSERT_OR_RETURN(, frame < frameNames.size(), "Bad frame %u", frame);
+	frameNames[frame] = name;
+}
+
+static size_t childNode(InstanceProfile &profile, size_t node, unsigned frame)
+{
+	auto it = profile.nodes[node].children.find(frame);
+	if (it != profile.nodes[node].children.end())
+	{
+		return it->second;
+	}
+	size_t child = profile.nodes.size();
+	profile.nodes[node].children.emplace(frame, child);
+	profile.nodes.push_back(ProfileNode{frame});
+	return child;
+}
+
+static uint64_t takeTimeSinceLastSample(InstanceProfile &profile)
+{
+	auto now = std::chrono::steady_clock::now();
+	uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - profile.lastSample).count();
+	profile.lastSample = now;
+	return elapsed;
+}
+
+void scriptProfilerBeginCall(wzapi::scripting_instance *instance, const std::string &function)
+{
+	std::lock_guard<wz::mutex> lock(profilerMutex);
+	InstanceProfile &profile = profiles[instance];
+	if (profile.callDepth++ > 0)
+	{
+		return;  // Nested call, its stack is sampled as part of the outer one.
+	}
+	if (profile.scriptName.empty())
+	{
+		profile.scriptName = instance->scriptName();
+		profile.player = instance->player();
+	}
+	profile.eventNode = childNode(profile, 0, frameLocked(function));
+	profile.lastSample = std::chrono::steady_clock::now();
+}
+
+void scriptProfilerEndCall(wzapi::scripting_instance *instance)
+{
+	std::lock_guard<wz::mutex> lock(profilerMutex);
+	InstanceProfile &profile = profiles[instance];
+	if (--profile.callDepth > 0)
+	{
+		return;
+	}
+	ProfileNode &node = profile.nodes[profile.eventNode];
+	node.selfTime += takeTimeSinceLastSample(profile);
+	node.samples++;
+}
+
+void scriptProfilerSample(wzapi::scripting_instance *instance, const unsigned *frames, size_t count)
+{
+	std::lock_guard<wz::mutex> lock(profilerMutex);
+	auto it = profiles.find(instance);
+	if (it == profiles.end() || it->second.callDepth == 0)
+	{
+		return;  // Running the script's global code, when loading it.
+	}
+	InstanceProfile &profile = it->second;
+	size_t node = profile.eventNode;
+	for (size_t i = count; i-- > 0;)
+	{
+		node = childNode(profile, node, frames[i]);
+	}
+	profile.nodes[node].selfTime += takeTimeSinceLastSample(profile);
+	profile.nodes[node].samples++;
+}
+
+struct FunctionTime
+{
+	uint64_t selfTime = 0;
+	uint64_t totalTime = 0;
+	uint64_t samples = 0;
+};
+
+/// Adds up the time of each function, counting a function which is on a stack more than once only once for its total time.
+static uint64_t addFunctionTimes(const InstanceProfile &profile, size_t node, std::unordered_map<unsigned, FunctionTime> &times, std::unordered_map<unsigned, int> &onStack)
+{
+	const ProfileNode &profileNode = profile.nodes[node];
+	uint64_t totalTime = profileNode.selfTime;
+	int &depth = onStack[profileNode.frame];
+	++depth;
+	for (auto const &child : profileNode.children)
+	{
+		totalTime += addFunctionTimes(profile, child.second, times, onStack);
+	}
+	--depth;
+	FunctionTime &time = times[profileNode.frame];
+	time.selfTime += profileNode.selfTime;
+	time.samples += profileNode.samples;
+	if (depth == 0)
+	{
+		time.totalTime += totalTime;
+	}
+	return totalTime;
+}
+
+void scriptProfilerReport(wzapi::scripting_instance *instance)
+{
+	instance->nameProfilerFrames();
+	std::lock_guard<wz::mutex> lock(profilerMutex);
+	auto it = profiles.find(instance);
+	if (it == profiles.end())
+	{
+		return;
+	}
+	std::unordered_map<unsigned, FunctionTime> times;
+	std::unordered_map<unsigned, int> onStack;
+	for (auto const &event : it->second.nodes[0].children)
+	{
+		addFunctionTimes(it->second, event.second, times, onStack);
+	}
+	std::vector<std::pair<unsigned, FunctionTime>> sorted(times.begin(), times.end());
+	std::sort(sorted.begin(), sorted.end(), [](std::pair<unsigned, FunctionTime> const &a, std::pair<unsigned, FunctionTime> const &b) {
+		return a.second.selfTime > b.second.selfTime;
+	});
+
+	instance->dumpScriptLog("=== PROFILE ===\n");
+	instance->dumpScriptLog("  self (msec) | total (msec) |  samples | function\n");
+	for (auto const &function : sorted)
+	{
+		std::ostringstream info;
+		info << std::fixed << std::setprecision(1);
+		info << std::right << std::setw(12) << function.second.selfTime / 1000. << " | ";
+		info << std::right << std::setw(12) << function.second.totalTime / 1000. << " | ";
+		info << std::right << std::setw(8) << function.second.samples << " | ";
+		info << frameNames[function.first] << "\n";
+		instance->dumpScriptLog(info.str());
+	}
+
+	reportedProfiles.push_back(std::move(it->second));
+	profiles.erase(it);
+}
+
+static void writeStacks(std::ostringstream &out, const InstanceProfile &profile, size_t node, std::string &stack)
+{
+	const ProfileNode &profileNode = profile.nodes[node];
+	size_t stackLength = stack.size();
+	stack += ';';
+	stack += frameNames[profileNode.frame];
+	if (profileNode.selfTime > 0)
+	{
+		out << stack << ' ' << profileNode.selfTime << '\n';
+	}
+	for (auto const &child : profileNode.children)
+	{
+		writeStacks(out, profile, child.second, stack);
+	}
+	stack.resize(stackLength);
+}
+
+void scriptProfilerWriteStacks()
+{
+	std::lock_guard<wz::mutex> lock(profilerMutex);
+	if (reportedProfiles.empty())
+	{
+		return;
+	}
+	std::ostringstream out;
+	for (auto const &profile : reportedProfiles)
+	{
+		for (auto const &event : profile.nodes[0].children)
+		{
+			std::string stack = profile.scriptName + " (player " + std::to_string(profile.player) + ")";
+			writeStacks(out, profile, event.second, stack);
+		}
+	}
+	reportedProfiles.clear();
+
+	std::time_t aclock = std::time(nullptr);
+	struct tm newtime = getLocalTime(aclock);
+	char fileName[100];
+	strftime(fileName, sizeof(fileName), "logs/scriptprofile-%Y%m%d_%H%M%S.folded", &newtime);
+	std::string data = out.str();
+	PHYSFS_file *fileHandle = PHYSFS_openWrite(fileName);
+	if (fileHandle == nullptr)
+	{
+		debug(LOG_ERROR, "Could not write %s: %s", fileName, WZ_PHYSFS_getLastError());
+		return;
+	}
+	WZ_PHYSFS_writeBytes(fileHandle, data.data(), static_cast<PHYSFS_uint32>(data.size()));
+	PHYSFS_close(fileHandle);
+	debug(LOG_INFO, "Script profile written to %s", fileName);
+}
@@ -0,0 +1,56 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#ifndef __INCLUDED_SRC_SCRIPTPROFILER_H__
+#define __INCLUDED_SRC_SCRIPTPROFILER_H__
+
+#include <string>
+
+namespace wzapi
+{
+	class scripting_instance;
+}
+
+/// Enables the script profiler, see --profile-scripts. Must be set before the scripts are loaded.
+void scriptProfilerSetEnabled(bool enabled);
+bool scriptProfilerEnabled();
+
+/// Returns the id of a stack frame name, for scriptProfilerSample().
+unsigned scriptProfilerFrame(const std::string &name);
+/// Returns the id of a new stack frame, which is named by scriptProfilerNameFrame() before the report is written, see
+/// wzapi::scripting_instance::nameProfilerFrames(). Saves working out names while sampling.
+unsigned scriptProfilerUnnamedFrame();
+void scriptProfilerNameFrame(unsigned frame, const std::string &name);
+
+// All of these may be called from the worker threads of scripting_engine::runTimersConcurrently().
+
+/// Called around every call from the game into a script. Only the outermost call of an instance counts.
+void scriptProfilerBeginCall(wzapi::scripting_instance *instance, const std::string &function);
+void scriptProfilerEndCall(wzapi::scripting_instance *instance);
+
+/// Charges the time since the previous sample of the current call to the given stack, frames[0] being the innermost frame.
+void scriptProfilerSample(wzapi::scripting_instance *instance, const unsigned *frames, size_t count);
+
+/// Writes the functions which took the most time to the script log of the instance, and forgets about the instance.
+void scriptProfilerReport(wzapi::scripting_instance *instance);
+
+/// Writes the samples of all instances reported so far, in the folded stack format of flamegraph.pl, and forgets about them.
+void scriptProfilerWriteStacks();
+
+#endif // __INCLUDED_SRC_SCRIPTPROFILER_H__
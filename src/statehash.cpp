@@ -0,0 +1,120 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file statehash.cpp
+ *
+ * Hashes of the synchronised game state, sent with GAME_GAME_TIME.
+ *
+ * The syncDebug() CRC only covers what happens to be logged, so a desynch may go unnoticed until it
+ * changes something that is. These hashes cover the object lists, power and research every tick, one
+ * hash per part of the game state, so the first part to differ shows up in the log straight away.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/gamelib/gtime.h"
+#include "lib/netplay/netplay.h"
+
+#include "statehash.h"
+#include "objmem.h"
+#include "power.h"
+#include "research.h"
+#include "structure.h"
+
+/// Word-at-a-time FNV-1a. Only needs to be fast and the same everywhere, not good.
+class StateHash
+{
+public:
+	StateHash &add(uint32_t value)
+	{
+		hash = (hash ^ value) * 16777619u;
+		return *this;
+	}
+	StateHash &add(Position const &pos)
+	{
+		return add(pos.x).add(pos.y).add(pos.z);
+	}
+	StateHash &add(Rotation const &rot)
+	{
+		return add(rot.direction).add(rot.pitch).add(rot.roll);
+	}
+	uint16_t get() const
+	{
+		return static_cast<uint16_t>(hash ^ hash >> 16);
+	}
+
+private:
+	uint32_t hash = 2166136261u;
+};
+
+void updateGameStateHashes()
+{
+	if (!NetPlay.bComms)
+	{
+		return;  // Nobody to compare with.
+	}
+
+	StateHash position, body, order, power, research;
+
+	for (unsigned player = 0; player < MAX_PLAYERS; ++player)
+	{
+		for (DROID const *psDroid = apsDroidLists[player]; psDroid != nullptr; psDroid = psDroid->psNext)
+		{
+			position.add(psDroid->id).add(psDroid->pos).add(psDroid->rot);
+			body.add(psDroid->id).add(psDroid->body).add(psDroid->experience);
+			order.add(psDroid->id).add(psDroid->order.type).add(psDroid->order.pos.x).add(psDroid->order.pos.y)
+			     .add(psDroid->order.psObj != nullptr ? psDroid->order.psObj->id : 0)
+			     .add(psDroid->action).add(psDroid->secondaryOrder);
+		}
+		for (STRUCTURE const *psStruct = apsStructLists[player]; psStruct != nullptr; psStruct = psStruct->psNext)
+		{
+			position.add(psStruct->id).add(psStruct->pos).add(psStruct->rot);
+			body.add(psStruct->id).add(psStruct->body).add(psStruct->status).add(psStruct->currentBuildPts);
+			if (psStruct->pStructureType->type == REF_RESEARCH && psStruct->pFunctionality != nullptr)
+			{
+				RESEARCH const *psSubject = psStruct->pFunctionality->researchFacility.psSubject;
+				research.add(psStruct->id).add(psSubject != nullptr ? psSubject->index + 1 : 0);
+			}
+		}
+		for (FEATURE const *psFeature = apsFeatureLists[player]; psFeature != nullptr; psFeature = psFeature->psNext)
+		{
+			position.add(psFeature->id).add(psFeature->pos);
+			body.add(psFeature->id).add(psFeature->body);
+		}
+
+		int64_t playerPower = getPrecisePower(player);
+		power.add(static_cast<uint32_t>(playerPower)).add(static_cast<uint32_t>(playerPower >> 32));
+
+		for (PLAYER_RESEARCH const &playerResearch : asPlayerResList[player])
+		{
+			// Only the synchronised bits, the pending ones are still waiting for their GAME_RESEARCHSTATUS.
+			research.add(playerResearch.ResearchStatus & RESBITS).add(playerResearch.currentPoints);
+		}
+	}
+
+	GameStateHashes hashes;
+	hashes[GAME_STATE_POSITION] = position.get();
+	hashes[GAME_STATE_BODY] = body.get();
+	hashes[GAME_STATE_ORDER] = order.get();
+	hashes[GAME_STATE_POWER] = power.get();
+	hashes[GAME_STATE_RESEARCH] = research.get();
+	setGameStateHashes(hashes);
+
+	syncDebug("state hashes = {positions: %04X, body: %04X, orders: %04X, power: %04X, research: %04X}",
+	          hashes[GAME_STATE_POSITION], hashes[GAME_STATE_BODY], hashes[GAME_STATE_ORDER], hashes[GAME_STATE_POWER], hashes[GAME_STATE_RESEARCH]);
+}
@@ -1330,7 +1330,7 @@ int getCompFromName(COMPONENT_TYPE compType, const WzString &name)
 int getCompFromID(COMPONENT_TYPE compType, const WzString &name)
 {
 	COMPONENT_STATS *psComp = nullptr;
-	auto it = lookupStatPtr.find(WzString::fromUtf8(name.toUtf8().c_str()));
+	auto it = lookupStatPtr.find(name);
 	if (it != lookupStatPtr.end())
 	{
 		psComp = (COMPONENT_STATS *)it->second;
@@ -1593,83 +1593,6 @@ bool getWeaponClass(const WzString& weaponClassStr, WEAPON_CLASS *weaponClass)
 	return true;
 }
 
-/*Access functions for the upgradeable stats of a weapon*/
-int weaponFirePause(const WEAPON_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].firePause;
-}
-
-/* Reload time is reduced for weapons with salvo fire */
-int weaponReloadTime(const WEAPON_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].reloadTime;
-}
-
-int weaponLongHit(const WEAPON_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].hitChance;
-}
-
-int weaponShortHit(const WEAPON_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].shortHitChance;
-}
-
-int weaponDamage(const WEAPON_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].damage;
-}
-
-int weaponRadDamage(const WEAPON_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].radiusDamage;
-}
-
-int weaponPeriodicalDamage(const WEAPON_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].periodicalDamage;
-}
-
-int sensorRange(const SENSOR_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].range;
-}
-
-int ecmRange(const ECM_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].range;
-}
-
-int repairPoints(const REPAIR_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].repairPoints;
-}
-
-int constructorPoints(const CONSTRUCT_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].constructPoints;
-}
-
-int bodyPower(const BODY_STATS *psStats, int player)
-{
-	return psStats->upgrade[player].power;
-}
-
-int bodyArmour(const BODY_STATS *psStats, int player, WEAPON_CLASS weaponClass)
-{
-	switch (weaponClass)
-	{
-	case WC_KINETIC:
-		return psStats->upgrade[player].armour;
-	case WC_HEAT:
-		return psStats->upgrade[player].thermal;
-	case WC_NUM_WEAPON_CLASSES:
-		break;
-	}
-	ASSERT(false, "Unknown weapon class");
-	return 0;	// Should never get here.
-}
-
 //calculates the weapons ROF based on the fire pause and the salvos
 int weaponROF(const WEAPON_STATS *psStat, int player)
 {
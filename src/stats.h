@@ -202,19 +202,84 @@ bool getPropulsionType(const char *typeName, PROPULSION_TYPE *type);
 extern const StringToEnumMap<WEAPON_EFFECT> map_WEAPON_EFFECT;
 
 WZ_DECL_PURE int weaponROF(const WEAPON_STATS *psStat, int player);
-WZ_DECL_PURE int weaponFirePause(const WEAPON_STATS *psStats, int player);
-WZ_DECL_PURE int weaponReloadTime(const WEAPON_STATS *psStats, int player);
-WZ_DECL_PURE int weaponShortHit(const WEAPON_STATS *psStats, int player);
-WZ_DECL_PURE int weaponLongHit(const WEAPON_STATS *psStats, int player);
-WZ_DECL_PURE int weaponDamage(const WEAPON_STATS *psStats, int player);
-WZ_DECL_PURE int weaponRadDamage(const WEAPON_STATS *psStats, int player);
-WZ_DECL_PURE int weaponPeriodicalDamage(const WEAPON_STATS *psStats, int player);
-WZ_DECL_PURE int sensorRange(const SENSOR_STATS *psStats, int player);
-WZ_DECL_PURE int ecmRange(const ECM_STATS *psStats, int player);
-WZ_DECL_PURE int repairPoints(const REPAIR_STATS *psStats, int player);
-WZ_DECL_PURE int constructorPoints(const CONSTRUCT_STATS *psStats, int player);
-WZ_DECL_PURE int bodyPower(const BODY_STATS *psStats, int player);
-WZ_DECL_PURE int bodyArmour(const BODY_STATS *psStats, int player, WEAPON_CLASS weaponClass);
+
+/* Access functions for the upgradeable stats. The upgrade tables already hold the upgraded values of each player,
+ * updated when a research upgrade is applied, so these are plain reads, inline since they are all over the combat code. */
+static inline int weaponFirePause(const WEAPON_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].firePause;
+}
+
+/* Reload time is reduced for weapons with salvo fire */
+static inline int weaponReloadTime(const WEAPON_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].reloadTime;
+}
+
+static inline int weaponShortHit(const WEAPON_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].shortHitChance;
+}
+
+static inline int weaponLongHit(const WEAPON_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].hitChance;
+}
+
+static inline int weaponDamage(const WEAPON_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].damage;
+}
+
+static inline int weaponRadDamage(const WEAPON_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].radiusDamage;
+}
+
+static inline int weaponPeriodicalDamage(const WEAPON_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].periodicalDamage;
+}
+
+static inline int sensorRange(const SENSOR_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].range;
+}
+
+static inline int ecmRange(const ECM_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].range;
+}
+
+static inline int repairPoints(const REPAIR_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].repairPoints;
+}
+
+static inline int constructorPoints(const CONSTRUCT_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].constructPoints;
+}
+
+static inline int bodyPower(const BODY_STATS *psStats, int player)
+{
+	return psStats->upgrade[player].power;
+}
+
+static inline int bodyArmour(const BODY_STATS *psStats, int player, WEAPON_CLASS weaponClass)
+{
+	switch (weaponClass)
+	{
+	case WC_KINETIC:
+		return psStats->upgrade[player].armour;
+	case WC_HEAT:
+		return psStats->upgrade[player].thermal;
+	case WC_NUM_WEAPON_CLASSES:
+		break;
+	}
+	ASSERT(false, "Unknown weapon class");
+	return 0;	// Should never get here.
+}
 
 void adjustMaxDesignStats();
 
@@ -64,6 +64,11 @@ struct WARZONE_GLOBALS
 	bool radarJump = false;
 	video_backend gfxBackend = video_backend::opengl; // the actual default value is determined in loadConfig()
 	JS_BACKEND jsBackend = (JS_BACKEND)0;
+	bool concurrentScripts = false;
+	int scriptMemoryLimit = 0;
+	int scriptGCThreshold = 0;
+	int scriptGCBudget = 0;
+	bool binarySaves = true;
 };
 
 static WARZONE_GLOBALS warGlobs;
@@ -402,3 +407,53 @@ void war_setJSBackend(JS_BACKEND backend)
 {
 	warGlobs.jsBackend = backend;
 }
+
+bool war_getConcurrentScripts()
+{
+	return warGlobs.concurrentScripts;
+}
+
+void war_setConcurrentScripts(bool enabled)
+{
+	warGlobs.concurrentScripts = enabled;
+}
+
+int war_getScriptMemoryLimit()
+{
+	return warGlobs.scriptMemoryLimit;
+}
+
+void war_setScriptMemoryLimit(int mebibytes)
+{
+	warGlobs.scriptMemoryLimit = std::max(mebibytes, 0);
+}
+
+int war_getScriptGCThreshold()
+{
+	return warGlobs.scriptGCThreshold;
+}
+
+void war_setScriptGCThreshold(int kibibytes)
+{
+	warGlobs.scriptGCThreshold = std::max(kibibytes, 0);
+}
+
+int war_getScriptGCBudget()
+{
+	return warGlobs.scriptGCBudget;
+}
+
+void war_setScriptGCBudget(int microseconds)
+{
+	warGlobs.scriptGCBudget = std::max(microseconds, 0);
+}
+
+bool war_getBinarySaves()
+{
+	return warGlobs.binarySaves;
+}
+
+void war_setBinarySaves(bool enabled)
+{
+	warGlobs.binarySaves = enabled;
+}
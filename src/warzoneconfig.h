@@ -115,6 +115,20 @@ video_backend war_getGfxBackend();
 void war_setGfxBackend(video_backend backend);
 JS_BACKEND war_getJSBackend();
 void war_setJSBackend(JS_BACKEND backend);
+bool war_getConcurrentScripts();
+void war_setConcurrentScripts(bool enabled);
+/// Heap limit of each script instance, in MiB. 0 for none.
+int war_getScriptMemoryLimit();
+void war_setScriptMemoryLimit(int mebibytes);
+/// Heap size at which a script instance first collects garbage, in KiB. After that, it waits for the heap to grow by half. 0 for the script engine's default.
+int war_getScriptGCThreshold();
+void war_setScriptGCThreshold(int kibibytes);
+/// If not 0, scripts collect garbage only between game ticks, for at most about this many microseconds per tick.
+int war_getScriptGCBudget();
+void war_setScriptGCBudget(int microseconds);
+/// Whether the object, research and message files of save games are written in the binary format of saveJsonFile(). If not, they are written as JSON, for exporting them.
+bool war_getBinarySaves();
+void war_setBinarySaves(bool enabled);
 
 /**
  * Enable or disable sound initialization
@@ -1127,6 +1127,18 @@ wzapi::researchResults wzapi::enumResearch(WZAPI_NO_PARAMS)
 	return result;
 }
 
+/// Whether enumRange() and friends should return the object, seen by player, with the given filter.
+static bool objectMatchesRangeFilter(const BASE_OBJECT *psObj, int player, int filter, bool seen)
+{
+	if ((!psObj->visible[player] && seen) || psObj->died)
+	{
+		return false;
+	}
+	return (filter >= 0 && psObj->player == filter) || filter == ALL_PLAYERS
+	       || (filter == ALLIES && psObj->type != OBJ_FEATURE && aiCheckAlliances(psObj->player, player))
+	       || (filter == ENEMIES && psObj->type != OBJ_FEATURE && !aiCheckAlliances(psObj->player, player));
+}
+
 //-- ## enumRange(x, y, range[, filter[, seen]])
 //--
 //-- Returns an array of game objects seen within range of given position that passes the optional filter
@@ -1150,17 +1162,141 @@ std::vector<const BASE_OBJECT *> wzapi::enumRange(WZAPI_PARAMS(int _x, int _y, i
 	for (GridIterator gi = gridList.begin(); gi != gridList.end(); ++gi)
 	{
 		const BASE_OBJECT *psObj = *gi;
-		if ((psObj->visible[player] || !seen) && !psObj->died)
+		if (objectMatchesRangeFilter(psObj, player, filter, seen))
 		{
-			if ((filter >= 0 && psObj->player == filter) || filter == ALL_PLAYERS
-			    || (filter == ALLIES && psObj->type != OBJ_FEATURE && aiCheckAlliances(psObj->player, player))
-			    || (filter == ENEMIES && psObj->type != OBJ_FEATURE && !aiCheckAlliances(psObj->player, player)))
+			list.push_back(psObj);
+		}
+	}
+	return list;
+}
+
+//-- ## enumRangeNearest(positions, range, count[, filter[, seen]])
+//--
+//-- Batched version of enumRange(), for scripts which look around many droids or places at once.
+//-- The first parameter is an array of game objects or positions, which are objects with ```x``` and ```y```
+//-- in tiles, like the position given to enumRange(). Returns an array with, for each of them,
+//-- an array of the at most count nearest game objects within range, nearest first. Objects passed in the
+//-- first parameter are not returned as their own neighbour. The filter and seen parameters are as for
+//-- enumRange(). Only the returned objects are converted for the script, so this is much faster than
+//-- calling enumRange() for each position and sorting the result. (4.1+ only)
+//--
+std::vector<std::vector<const BASE_OBJECT *>> wzapi::enumRangeNearest(WZAPI_PARAMS(object_or_position_list positions, int _range, int count, optional<int> _filter, optional<bool> _seen))
+{
+	int player = context.player();
+	int range = world_coord(_range);
+	int filter = (_filter.has_value()) ? _filter.value() : ALL_PLAYERS;
+	bool seen = (_seen.has_value()) ? _seen.value() : true;
+	SCRIPT_ASSERT({}, context, count >= 0, "Bad count %d", count);
+
+	std::vector<std::vector<const BASE_OBJECT *>> result;
+	result.reserve(positions.entries.size());
+	std::vector<std::pair<int64_t, const BASE_OBJECT *>> candidates;
+	for (auto const &entry : positions.entries)
+	{
+		candidates.clear();
+		for (const BASE_OBJECT *psObj : gridStartIterate(entry.pos.x, entry.pos.y, range))
+		{
+			if (psObj != entry.psObj && objectMatchesRangeFilter(psObj, player, filter, seen))
 			{
-				list.push_back(psObj);
+				Vector2i diff = psObj->pos.xy() - entry.pos;
+				candidates.emplace_back(static_cast<int64_t>(diff.x) * diff.x + static_cast<int64_t>(diff.y) * diff.y, psObj);
 			}
 		}
+		size_t nearest = std::min<size_t>(count, candidates.size());
+		// Ties are broken by id, so that the result doesn't depend on the order of the grid.
+		std::partial_sort(candidates.begin(), candidates.begin() + nearest, candidates.end(), [](std::pair<int64_t, const BASE_OBJECT *> const &a, std::pair<int64_t, const BASE_OBJECT *> const &b) {
+			return a.first < b.first || (a.first == b.first && a.second->id < b.second->id);
+		});
+		std::vector<const BASE_OBJECT *> list;
+		list.reserve(nearest);
+		for (size_t i = 0; i < nearest; ++i)
+		{
+			list.push_back(candidates[i].second);
+		}
+		result.push_back(std::move(list));
 	}
-	return list;
+	return result;
+}
+
+//-- ## countRange(positions, range[, filter[, seen]])
+//--
+//-- Batched count of the game objects within range of each of an array of game objects or positions.
+//-- Returns an array with, for each of them, an object with the number of droids, structures and features
+//-- found, in its ```droids```, ```structures``` and ```features``` properties. Objects passed in the first
+//-- parameter do not count themselves. The filter and seen parameters are as for enumRange(). (4.1+ only)
+//--
+nlohmann::json wzapi::countRange(WZAPI_PARAMS(object_or_position_list positions, int _range, optional<int> _filter, optional<bool> _seen))
+{
+	int player = context.player();
+	int range = world_coord(_range);
+	int filter = (_filter.has_value()) ? _filter.value() : ALL_PLAYERS;
+	bool seen = (_seen.has_value()) ? _seen.value() : true;
+
+	nlohmann::json result = nlohmann::json::array();
+	for (auto const &entry : positions.entries)
+	{
+		int counts[OBJ_NUM_TYPES] = {};
+		for (const BASE_OBJECT *psObj : gridStartIterate(entry.pos.x, entry.pos.y, range))
+		{
+			if (psObj != entry.psObj && objectMatchesRangeFilter(psObj, player, filter, seen))
+			{
+				++counts[psObj->type];
+			}
+		}
+		nlohmann::json count = nlohmann::json::object();
+		count["droids"] = counts[OBJ_DROID];
+		count["structures"] = counts[OBJ_STRUCTURE];
+		count["features"] = counts[OBJ_FEATURE];
+		result.push_back(std::move(count));
+	}
+	return result;
+}
+
+/// The damage per minute the weapons of the object would deal, if they all fired.
+static int objectThreat(const BASE_OBJECT *psObj)
+{
+	if (psObj->type == OBJ_STRUCTURE && static_cast<const STRUCTURE *>(psObj)->status != SS_BUILT)
+	{
+		return 0;
+	}
+	int threat = 0;
+	for (unsigned i = 0; i < psObj->numWeaps; ++i)
+	{
+		const WEAPON_STATS *psStats = &asWeaponStats[psObj->asWeaps[i].nStat];
+		threat += weaponDamage(psStats, psObj->player) * weaponROF(psStats, psObj->player);
+	}
+	return threat;
+}
+
+//-- ## threatRange(positions, range[, filter[, seen]])
+//--
+//-- Batched threat estimate around each of an array of game objects or positions. Returns an array with,
+//-- for each of them, the summed damage per minute of the weapons of the droids and finished structures
+//-- within range, with upgrades. Objects passed in the first parameter do not count themselves. By default,
+//-- filter is ENEMIES; otherwise the filter and seen parameters are as for enumRange(). (4.1+ only)
+//--
+std::vector<int> wzapi::threatRange(WZAPI_PARAMS(object_or_position_list positions, int _range, optional<int> _filter, optional<bool> _seen))
+{
+	int player = context.player();
+	int range = world_coord(_range);
+	int filter = (_filter.has_value()) ? _filter.value() : ENEMIES;
+	bool seen = (_seen.has_value()) ? _seen.value() : true;
+
+	std::vector<int> result;
+	result.reserve(positions.entries.size());
+	for (auto const &entry : positions.entries)
+	{
+		int threat = 0;
+		for (const BASE_OBJECT *psObj : gridStartIterate(entry.pos.x, entry.pos.y, range))
+		{
+			if (psObj != entry.psObj && psObj->type != OBJ_FEATURE && objectMatchesRangeFilter(psObj, player, filter, seen))
+			{
+				threat += objectThreat(psObj);
+			}
+		}
+		result.push_back(threat);
+	}
+	return result;
 }
 
 //-- ## pursueResearch(lab, research)
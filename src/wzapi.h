@@ -41,6 +41,14 @@
 //-- This section describes functions that can be called from scripts to make
 //-- things happen in the game (usually called our script 'API').
 //--
+//-- If the ```concurrentscripts``` option is set, the timers of skirmish AI scripts may run concurrently with
+//-- those of other AI scripts. While they do, functions which change the game state, such as ```orderDroid()```,
+//-- ```buildDroid()``` or ```pursueResearch()```, only take effect once the timers of the game tick are done, and
+//-- then in player order. So do assignments to ```Upgrades```. Since their outcome isn't known yet, these functions
+//-- always return ```true``` from a concurrently running timer. Functions which have to return something new, namely ```syncRandom()```,
+//-- ```addDroid()```, ```addFeature()```, ```addStructure()```, ```addSpotter()``` and ```newGroup()```, throw
+//-- an error there instead, and the timers of the script then run on the main thread for the rest of the game.
+//--
 //;; # Game objects
 //;;
 //;; This section describes various **game objects** defined by the script interface,
@@ -613,10 +621,61 @@ namespace wzapi
 
 		virtual void setSpecifiedGlobalVariable(const std::string& name, const nlohmann::json& value, GlobalVariableFlags flags = GlobalVariableFlags::ReadOnly | GlobalVariableFlags::DoNotSave) = 0;
 
+	public:
+		// concurrent execution
+		//
+		// if supported, scripting_engine::updateScripts() may run the timers of this instance on a worker thread, concurrently with other
+		// instances (see scripting_engine::GameStateLock)
+		//
+		// while running concurrently, the instance must queue any changes to the game state instead of making them, and make them in
+		// endConcurrentExecution(), which the engine calls for each instance in player order
+		//
+		// only the instances of skirmish AIs may run concurrently (see setMayRunConcurrently()), since the other scripts run on every
+		// client, and must run their timers in the same order everywhere
+		virtual bool supportsConcurrentExecution() const { return false; }
+		// called on the worker thread, with the game state lock held, before the instance's timers run there
+		virtual void beginConcurrentExecution() { }
+		// called on the main thread, once all worker threads are done
+		virtual void endConcurrentExecution() { }
+
+		// whether the script is an AI (including the scavengers'), rather than a global script such as rules.js, which runs for selectedPlayer
+		inline void setIsAIScript(bool value) { m_isAIScript = value; }
+		inline bool isAIScript() const { return m_isAIScript; }
+		// set by the engine when loading the script, and cleared if the script calls a function which can't be queued while running concurrently
+		inline void setMayRunConcurrently(bool value) { m_mayRunConcurrently = value; }
+		inline bool mayRunConcurrently() const { return m_mayRunConcurrently; }
+		inline void setRunningConcurrently(bool value) { m_isRunningConcurrently = value; }
+		inline bool isRunningConcurrently() const { return m_isRunningConcurrently; }
+		inline void setHoldsGameStateLock(bool value) { m_holdsGameStateLock = value; }
+		inline bool holdsGameStateLock() const { return m_holdsGameStateLock; }
+
+	public:
+		// profiling
+		//
+		// called before the script profiler reports the instance, for backends which only identify the frames of their samples
+		// while sampling, see scriptProfilerUnnamedFrame()
+		virtual void nameProfilerFrames() { }
+
+	public:
+		// memory management
+		//
+		// if the "scriptGCBudget" option is set, instances which support it only collect garbage when scripting_engine::updateScripts()
+		// asks them to, between game ticks, instead of whenever an allocation crosses their garbage collection threshold
+		//
+		// whether the heap has grown past the garbage collection threshold since the last collection
+		virtual bool needsGarbageCollection() const { return false; }
+		virtual void collectGarbage() { }
+		// memory usage statistics, for the script debugger
+		virtual nlohmann::json debugGetMemoryUsage() { return nlohmann::json::object(); }
+
 	private:
 		int m_player;
 		std::string m_scriptName;
 		bool m_isReceivingAllEvents = false;
+		bool m_isAIScript = false;
+		bool m_mayRunConcurrently = false;
+		bool m_isRunningConcurrently = false;
+		bool m_holdsGameStateLock = false;
 	};
 
 	class execution_context
@@ -751,6 +810,17 @@ namespace wzapi
 		std::string label;
 	};
 
+	/// The centres of the batched range queries, see enumRangeNearest(). Scripts pass an array of game objects or {x, y} tile positions.
+	struct object_or_position_list
+	{
+		struct entry
+		{
+			Vector2i pos;                           ///< World coordinates.
+			const BASE_OBJECT *psObj = nullptr;     ///< The object which was passed, if any.
+		};
+		std::vector<entry> entries;
+	};
+
 	// retVals
 	struct no_return_value
 	{ };
@@ -954,6 +1024,9 @@ namespace wzapi
 	researchResult getResearch(WZAPI_PARAMS(std::string resName, optional<int> _player));
 	researchResults enumResearch(WZAPI_NO_PARAMS);
 	std::vector<const BASE_OBJECT *> enumRange(WZAPI_PARAMS(int x, int y, int range, optional<int> _filter, optional<bool> _seen));
+	std::vector<std::vector<const BASE_OBJECT *>> enumRangeNearest(WZAPI_PARAMS(object_or_position_list positions, int range, int count, optional<int> _filter, optional<bool> _seen));
+	nlohmann::json countRange(WZAPI_PARAMS(object_or_position_list positions, int range, optional<int> _filter, optional<bool> _seen));
+	std::vector<int> threatRange(WZAPI_PARAMS(object_or_position_list positions, int range, optional<int> _filter, optional<bool> _seen));
 	bool pursueResearch(WZAPI_PARAMS(const STRUCTURE *psStruct, string_or_string_list research));
 	researchResults findResearch(WZAPI_PARAMS(std::string resName, optional<int> _player));
 	int32_t distBetweenTwoPoints(WZAPI_PARAMS(int32_t x1, int32_t y1, int32_t x2, int32_t y2));
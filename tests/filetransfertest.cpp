@@ -0,0 +1,186 @@
+#include "lib/framework/wzglobal.h"
+#include "lib/framework/types.h"
+#include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
+#include "lib/framework/physfs_ext.h"
+#include "lib/netplay/netplay.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// --- dummy rendering library implementation ----
+
+void wzToggleFullscreen()
+{
+}
+
+bool wzIsFullscreen()
+{
+	return false;
+}
+
+void wzDisplayDialog(DialogType, const char *, const char *)
+{
+}
+
+int wzGetTicks()
+{
+	return 1;
+}
+
+void inputInitialise()
+{
+}
+
+// --- end linking hacks ---
+
+// Goes through the same steps as a map download, with the network left out: the client opens its partial file, and
+// asks the host to resume at its size, the host seeks there, and the client starts over if the host sends from 0.
+
+#define SOURCE_FILE "filetransfertest.wz"    // What the host sends.
+#define DOWNLOAD_FILE "filetransfertest.dl"  // Where the client downloads it, in DOWNLOAD_FILE ".part".
+#define SOURCE_SIZE 200000
+#define CHUNK_SIZE (MIN_FILE_TRANSFER_CHUNK * 4)
+#define INTERRUPT_AT 70000
+
+static bool writeWholeFile(const char *fileName, const std::vector<uint8_t> &data)
+{
+	PHYSFS_file *fileHandle = PHYSFS_openWrite(fileName);
+	if (fileHandle == nullptr)
+	{
+		return false;
+	}
+	bool ok = WZ_PHYSFS_writeBytes(fileHandle, data.data(), static_cast<PHYSFS_uint32>(data.size())) == static_cast<PHYSFS_sint64>(data.size());
+	return PHYSFS_close(fileHandle) && ok;
+}
+
+static bool readWholeFile(const char *fileName, std::vector<uint8_t> &data)
+{
+	PHYSFS_file *fileHandle = PHYSFS_openRead(fileName);
+	if (fileHandle == nullptr)
+	{
+		return false;
+	}
+	data.resize(static_cast<size_t>(PHYSFS_fileLength(fileHandle)));
+	bool ok = WZ_PHYSFS_readBytes(fileHandle, data.data(), static_cast<PHYSFS_uint32>(data.size())) == static_cast<PHYSFS_sint64>(data.size());
+	PHYSFS_close(fileHandle);
+	return ok;
+}
+
+/// Downloads SOURCE_FILE, stopping as if disconnected once stopAt bytes of the file are there. Sets *startPos to where the host started.
+static bool download(uint32_t stopAt, uint32_t *startPos)
+{
+	uint32_t clientPos = 0;
+	PHYSFS_file *clientHandle = NETopenPartialFile(DOWNLOAD_FILE, true, &clientPos);
+	PHYSFS_file *hostHandle = PHYSFS_openRead(SOURCE_FILE);
+	if (clientHandle == nullptr || hostHandle == nullptr)
+	{
+		fprintf(stderr, "filetransfertest: Could not open the files: %s\n", WZ_PHYSFS_getLastError());
+		return false;
+	}
+	uint32_t hostPos = NETseekFileStart(hostHandle, SOURCE_SIZE, clientPos);
+	*startPos = hostPos;
+	if (hostPos == 0 && clientPos != 0)
+	{
+		PHYSFS_close(clientHandle);
+		clientHandle = NETopenPartialFile(DOWNLOAD_FILE, false, &clientPos);
+		if (clientHandle == nullptr)
+		{
+			PHYSFS_close(hostHandle);
+			return false;
+		}
+	}
+
+	bool ok = true;
+	std::vector<uint8_t> chunk(CHUNK_SIZE);
+	while (ok && hostPos < std::min<uint32_t>(stopAt, SOURCE_SIZE))
+	{
+		uint32_t size = std::min<uint32_t>(CHUNK_SIZE, SOURCE_SIZE - hostPos);
+		ok = WZ_PHYSFS_readBytes(hostHandle, chunk.data(), size) == size;
+		if (ok && hostPos != clientPos)
+		{
+			fprintf(stderr, "filetransfertest: Chunk at %u, but client is at %u\n", hostPos, clientPos);
+			ok = false;
+		}
+		ok = ok && WZ_PHYSFS_writeBytes(clientHandle, chunk.data(), size) == size;
+		hostPos += size;
+		clientPos += size;
+	}
+	PHYSFS_close(hostHandle);
+	return PHYSFS_close(clientHandle) && ok;
+}
+
+static bool checkDownload(const std::vector<uint8_t> &source, size_t expectedSize)
+{
+	std::vector<uint8_t> partial;
+	if (!readWholeFile(NETpartialFilename(DOWNLOAD_FILE).c_str(), partial))
+	{
+		fprintf(stderr, "filetransfertest: Could not read the partial file\n");
+		return false;
+	}
+	if (partial.size() != expectedSize || !std::equal(partial.begin(), partial.end(), source.begin()))
+	{
+		fprintf(stderr, "filetransfertest: Partial file has %zu bytes, expected the first %zu bytes of the file\n", partial.size(), expectedSize);
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	(void)argc;
+	PHYSFS_init(argv[0]);
+	if (!PHYSFS_setWriteDir(".") || !PHYSFS_mount(".", NULL, PHYSFS_APPEND))
+	{
+		fprintf(stderr, "filetransfertest: Could not use the current directory: %s\n", WZ_PHYSFS_getLastError());
+		return -1;
+	}
+
+	std::vector<uint8_t> source(SOURCE_SIZE);
+	uint32_t seed = 12345;
+	for (uint8_t &byte : source)
+	{
+		seed = seed * 1103515245 + 12345;
+		byte = static_cast<uint8_t>(seed >> 16);
+	}
+	std::string partialFile = NETpartialFilename(DOWNLOAD_FILE);
+	PHYSFS_delete(partialFile.c_str());
+	const uint32_t partialSize = (INTERRUPT_AT + CHUNK_SIZE - 1) / CHUNK_SIZE * CHUNK_SIZE;  // Downloads stop after whole chunks.
+	uint32_t startPos = 0;
+	bool ok = writeWholeFile(SOURCE_FILE, source);
+
+	printf("Testing interrupted download\n");
+	ok = ok && download(INTERRUPT_AT, &startPos) && startPos == 0 && checkDownload(source, partialSize);
+
+	printf("Testing resumed download\n");
+	ok = ok && download(SOURCE_SIZE, &startPos);
+	if (ok && startPos != partialSize)
+	{
+		fprintf(stderr, "filetransfertest: Resumed at %u, expected %u\n", startPos, partialSize);
+		ok = false;
+	}
+	ok = ok && checkDownload(source, SOURCE_SIZE);
+
+	printf("Testing download the host can't resume\n");
+	std::vector<uint8_t> tooBig(SOURCE_SIZE + 1000, 0xAA);  // Can't be the start of the file.
+	ok = ok && writeWholeFile(partialFile.c_str(), tooBig);
+	ok = ok && download(SOURCE_SIZE, &startPos);
+	if (ok && startPos != 0)
+	{
+		fprintf(stderr, "filetransfertest: Resumed at %u, past the end of the file\n", startPos);
+		ok = false;
+	}
+	ok = ok && checkDownload(source, SOURCE_SIZE);
+
+	printf("Testing download which doesn't resume\n");
+	uint32_t resumePos = 1;
+	PHYSFS_file *fileHandle = ok ? NETopenPartialFile(DOWNLOAD_FILE, false, &resumePos) : nullptr;
+	ok = fileHandle != nullptr && PHYSFS_close(fileHandle) && resumePos == 0 && checkDownload(source, 0);
+
+	PHYSFS_delete(SOURCE_FILE);
+	PHYSFS_delete(partialFile.c_str());
+	PHYSFS_deinit();
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,213 @@
+#include "lib/framework/wzglobal.h"
+#include "lib/framework/types.h"
+#include "lib/framework/frame.h"
+#include "lib/framework/file.h"
+#include "lib/framework/wzapp.h"
+#include "lib/framework/wzconfig.h"
+#include "lib/framework/physfs_ext.h"
+
+#include <stdio.h>
+#include <string>
+
+// --- dummy rendering library implementation ----
+
+void wzToggleFullscreen()
+{
+}
+
+bool wzIsFullscreen()
+{
+	return false;
+}
+
+void wzDisplayDialog(DialogType, const char *, const char *)
+{
+}
+
+int wzGetTicks()
+{
+	return 1;
+}
+
+void inputInitialise()
+{
+}
+
+// There is no main loop, so run it right away. Only used by the deferred save file writer.
+void wzAsyncExecOnMainThread(WZ_MAINTHREADEXEC *exec)
+{
+	exec->doExecOnMainThread();
+	delete exec;
+}
+
+// --- end linking hacks ---
+
+#define TEST_FILE "jsonfiletest.json"
+
+static nlohmann::json testDocument()
+{
+	nlohmann::json document = nlohmann::json::object();
+	document["string"] = "Hello, \"world\"\n";
+	document["utf8"] = "\xc3\xa9\xe2\x82\xac";
+	document["int"] = 42;
+	document["negative"] = -123456789012LL;
+	document["unsigned"] = 4000000000u;
+	document["float"] = 0.1;
+	document["true"] = true;
+	document["false"] = false;
+	document["null"] = nullptr;
+	document["empty"] = nlohmann::json::object();
+	document["nested"]["list"] = nlohmann::json::array({1, "two", 3.5, nullptr});
+	// Bigger than the compression buffers, so they fill up and get flushed more than once.
+	nlohmann::json droids = nlohmann::json::array();
+	for (int i = 0; i < 20000; ++i)
+	{
+		nlohmann::json droid = nlohmann::json::object();
+		droid["id"] = i;
+		droid["name"] = "Droid " + std::to_string(i);
+		droid["position"] = nlohmann::json::array({i * 128, i * 64 % 8192, i % 7});
+		droids.push_back(std::move(droid));
+	}
+	document["droids"] = std::move(droids);
+	return document;
+}
+
+static bool loadTestFile(nlohmann::json &document, std::string &contents)
+{
+	char *data = nullptr;
+	UDWORD size = 0;
+	if (!loadFile(TEST_FILE, &data, &size))
+	{
+		fprintf(stderr, "jsonfiletest: Could not load %s\n", TEST_FILE);
+		return false;
+	}
+	contents.assign(data, size);
+	free(data);
+	try
+	{
+		document = parseJsonFile(contents.data(), contents.size());
+	}
+	catch (const std::exception &e)
+	{
+		fprintf(stderr, "jsonfiletest: Could not parse %s: %s\n", TEST_FILE, e.what());
+		return false;
+	}
+	return true;
+}
+
+static bool testRoundTrip(const nlohmann::json &document, bool binary)
+{
+	printf("Testing %s round trip\n", binary ? "binary" : "text");
+	if (!saveJsonFile(TEST_FILE, document, binary))
+	{
+		fprintf(stderr, "jsonfiletest: Could not save %s\n", TEST_FILE);
+		return false;
+	}
+	nlohmann::json loaded;
+	std::string contents;
+	if (!loadTestFile(loaded, contents))
+	{
+		return false;
+	}
+	if ((contents.compare(0, 4, "WZBJ") == 0) != binary)
+	{
+		fprintf(stderr, "jsonfiletest: Saved in the wrong format\n");
+		return false;
+	}
+	if (loaded != document)
+	{
+		fprintf(stderr, "jsonfiletest: Loaded document differs from the saved one\n");
+		return false;
+	}
+	return true;
+}
+
+static bool testDeferred(const nlohmann::json &document)
+{
+	printf("Testing deferred save\n");
+	PHYSFS_delete(TEST_FILE);
+	int calls = 0;
+	bool allWritten = false;
+	beginDeferredSaveFiles();
+	saveJsonFile(TEST_FILE, document, true);
+	if (PHYSFS_exists(TEST_FILE))
+	{
+		fprintf(stderr, "jsonfiletest: Deferred file was written before endDeferredSaveFiles()\n");
+		endDeferredSaveFiles();
+		waitForDeferredSaveFiles();
+		return false;
+	}
+	endDeferredSaveFiles([&calls, &allWritten](bool written) {
+		++calls;
+		allWritten = written;
+	});
+	waitForDeferredSaveFiles();
+	if (calls != 1 || !allWritten)
+	{
+		fprintf(stderr, "jsonfiletest: Deferred save reported %d times, written: %d\n", calls, allWritten);
+		return false;
+	}
+	nlohmann::json loaded;
+	std::string contents;
+	if (!loadTestFile(loaded, contents))
+	{
+		return false;
+	}
+	if (loaded != document)
+	{
+		fprintf(stderr, "jsonfiletest: Deferred document differs from the saved one\n");
+		return false;
+	}
+	return true;
+}
+
+static bool testDamaged(const nlohmann::json &document)
+{
+	printf("Testing damaged binary file\n");
+	if (!saveJsonFile(TEST_FILE, document, true))
+	{
+		fprintf(stderr, "jsonfiletest: Could not save %s\n", TEST_FILE);
+		return false;
+	}
+	char *data = nullptr;
+	UDWORD size = 0;
+	if (!loadFile(TEST_FILE, &data, &size))
+	{
+		fprintf(stderr, "jsonfiletest: Could not load %s\n", TEST_FILE);
+		return false;
+	}
+	bool threw = false;
+	try
+	{
+		parseJsonFile(data, size / 2);  // Cut off in the middle of the compressed data.
+	}
+	catch (const std::exception &)
+	{
+		threw = true;
+	}
+	free(data);
+	if (!threw)
+	{
+		fprintf(stderr, "jsonfiletest: Truncated file was parsed\n");
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	(void)argc;
+	PHYSFS_init(argv[0]);
+	if (!PHYSFS_setWriteDir(".") || !PHYSFS_mount(".", NULL, PHYSFS_APPEND))
+	{
+		fprintf(stderr, "jsonfiletest: Could not use the current directory: %s\n", WZ_PHYSFS_getLastError());
+		return -1;
+	}
+
+	nlohmann::json document = testDocument();
+	bool ok = testRoundTrip(document, false) && testRoundTrip(document, true) && testDeferred(document) && testDamaged(document);
+
+	PHYSFS_delete(TEST_FILE);
+	PHYSFS_deinit();
+	return ok ? 0 : -1;
+}
@@ -380,6 +380,13 @@ static QScriptValue js_debug(QScriptContext *context, QScriptEngine *engine)
 	return QScriptValue();
 }
 
+static QScriptValue js_hackAssert(QScriptContext *context, QScriptEngine *engine)
+{
+	SCRIPT_ASSERT(context, context->argumentCount() >= 2, "Wrong number of arguments - must be at least 2");
+	ARG_BOOL(0);
+	return QScriptValue();
+}
+
 static QScriptValue js_structureIdle(QScriptContext *context, QScriptEngine *)
 {
 	ARG_COUNT_EXACT(1);
@@ -437,6 +444,108 @@ static QScriptValue js_groupAddDroid(QScriptContext *context, QScriptEngine *eng
 	return QScriptValue();
 }
 
+static QScriptValue js_enumRange(QScriptContext *context, QScriptEngine *engine)
+{
+	ARG_COUNT_VAR(3, 5);
+	ARG_NUMBER(0);
+	ARG_NUMBER(1);
+	ARG_NUMBER(2);
+	switch (context->argumentCount())
+	{
+	default:
+	case 5: ARG_BOOL(4); // fall-through
+	case 4: ARG_NUMBER(3); // fall-through
+	case 3: break;
+	}
+	QScriptValue result = engine->newArray(3);
+	for (int i = 0; i < 3; i++)
+	{
+		result.setProperty(i, convObj(engine));
+	}
+	return result;
+}
+
+// The batched range queries take an array of game objects or positions, and return an entry for each.
+#define ARG_POSITIONS(vnum) do { \
+	SCRIPT_ASSERT(context, context->argument(vnum).isArray(), "Argument %d should be an array", vnum); \
+	QScriptValue vlist = context->argument(vnum); \
+	for (int vi = 0; vi < vlist.property("length").toInt32(); ++vi) \
+	{ \
+		QScriptValue vitem = vlist.property(vi); \
+		SCRIPT_ASSERT(context, vitem.property("x").isNumber() && vitem.property("y").isNumber(), "Item %d of argument %d should be a game object or position", vi, vnum); \
+	} \
+	} while(0)
+
+static QScriptValue js_enumRangeNearest(QScriptContext *context, QScriptEngine *engine)
+{
+	ARG_COUNT_VAR(3, 5);
+	ARG_POSITIONS(0);
+	ARG_NUMBER(1);
+	ARG_NUMBER(2);
+	switch (context->argumentCount())
+	{
+	default:
+	case 5: ARG_BOOL(4); // fall-through
+	case 4: ARG_NUMBER(3); // fall-through
+	case 3: break;
+	}
+	int count = context->argument(0).property("length").toInt32();
+	QScriptValue result = engine->newArray(count);
+	for (int i = 0; i < count; i++)
+	{
+		QScriptValue nearest = engine->newArray(1);
+		nearest.setProperty(0, convObj(engine));
+		result.setProperty(i, nearest);
+	}
+	return result;
+}
+
+static QScriptValue js_countRange(QScriptContext *context, QScriptEngine *engine)
+{
+	ARG_COUNT_VAR(2, 4);
+	ARG_POSITIONS(0);
+	ARG_NUMBER(1);
+	switch (context->argumentCount())
+	{
+	default:
+	case 4: ARG_BOOL(3); // fall-through
+	case 3: ARG_NUMBER(2); // fall-through
+	case 2: break;
+	}
+	int count = context->argument(0).property("length").toInt32();
+	QScriptValue result = engine->newArray(count);
+	for (int i = 0; i < count; i++)
+	{
+		QScriptValue counts = engine->newObject();
+		counts.setProperty("droids", 1);
+		counts.setProperty("structures", 1);
+		counts.setProperty("features", 1);
+		result.setProperty(i, counts);
+	}
+	return result;
+}
+
+static QScriptValue js_threatRange(QScriptContext *context, QScriptEngine *engine)
+{
+	ARG_COUNT_VAR(2, 4);
+	ARG_POSITIONS(0);
+	ARG_NUMBER(1);
+	switch (context->argumentCount())
+	{
+	default:
+	case 4: ARG_BOOL(3); // fall-through
+	case 3: ARG_NUMBER(2); // fall-through
+	case 2: break;
+	}
+	int count = context->argument(0).property("length").toInt32();
+	QScriptValue result = engine->newArray(count);
+	for (int i = 0; i < count; i++)
+	{
+		result.setProperty(i, 100);
+	}
+	return result;
+}
+
 static QScriptValue js_distBetweenTwoPoints(QScriptContext *context, QScriptEngine *engine)
 {
 	ARG_COUNT_EXACT(4);
@@ -943,6 +1052,7 @@ bool testPlayerScript(QString path, int player, int difficulty)
 
 	// General functions -- geared for use in AI scripts
 	engine->globalObject().setProperty("debug", engine->newFunction(js_debug));
+	engine->globalObject().setProperty("hackAssert", engine->newFunction(js_hackAssert));
 	engine->globalObject().setProperty("console", engine->newFunction(js_console));
 	engine->globalObject().setProperty("structureIdle", engine->newFunction(js_structureIdle));
 	engine->globalObject().setProperty("enumStruct", engine->newFunction(js_enumStruct));
@@ -951,6 +1061,10 @@ bool testPlayerScript(QString path, int player, int difficulty)
 	engine->globalObject().setProperty("enumGroup", engine->newFunction(js_enumGroup));
 	engine->globalObject().setProperty("enumFeature", engine->newFunction(js_enumFeature));
 	engine->globalObject().setProperty("enumBlips", engine->newFunction(js_enumBlips));
+	engine->globalObject().setProperty("enumRange", engine->newFunction(js_enumRange));
+	engine->globalObject().setProperty("enumRangeNearest", engine->newFunction(js_enumRangeNearest));
+	engine->globalObject().setProperty("countRange", engine->newFunction(js_countRange));
+	engine->globalObject().setProperty("threatRange", engine->newFunction(js_threatRange));
 	engine->globalObject().setProperty("enumResearch", engine->newFunction(js_enumResearch));
 	engine->globalObject().setProperty("getResearch", engine->newFunction(js_getResearch));
 	engine->globalObject().setProperty("pursueResearch", engine->newFunction(js_pursueResearch));
@@ -1080,6 +1194,7 @@ bool testPlayerScript(QString path, int player, int difficulty)
 	engine->globalObject().setProperty("AREA", AREA, QScriptValue::ReadOnly | QScriptValue::Undeletable);
 	engine->globalObject().setProperty("ALL_PLAYERS", -1, QScriptValue::ReadOnly | QScriptValue::Undeletable);
 	engine->globalObject().setProperty("ALLIES", -2, QScriptValue::ReadOnly | QScriptValue::Undeletable);
+	engine->globalObject().setProperty("ENEMIES", -3, QScriptValue::ReadOnly | QScriptValue::Undeletable);
 
 	QScriptValue playerData = engine->newArray(CUR_PLAYERS);
 	for (int i = 0; i < CUR_PLAYERS; i++)
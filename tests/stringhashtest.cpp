@@ -0,0 +1,109 @@
+#include "lib/framework/wzglobal.h"
+#include "lib/framework/types.h"
+#include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
+#include "lib/framework/stringhash.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+// --- dummy rendering library implementation ----
+
+void wzToggleFullscreen()
+{
+}
+
+bool wzIsFullscreen()
+{
+	return false;
+}
+
+void wzDisplayDialog(DialogType, const char *, const char *)
+{
+}
+
+int wzGetTicks()
+{
+	return 1;
+}
+
+void inputInitialise()
+{
+}
+
+// --- end linking hacks ---
+
+#define TEST_ENTRIES 10000
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			fprintf(stderr, "stringhashtest: Check failed at line %d: %s\n", __LINE__, #condition); \
+			return -1; \
+		} \
+	} while (0)
+
+int main(void)
+{
+	StringHashTable table;
+	const char *value = nullptr;
+
+	CHECK(table.size() == 0);
+	CHECK(!table.find("missing", &value));
+	CHECK(table.findKey("missing") == nullptr);
+
+	// Enough entries to make the table grow many times.
+	for (int i = 0; i < TEST_ENTRIES; ++i)
+	{
+		std::string key = "key" + std::to_string(i);
+		std::string copied = "value" + std::to_string(i);
+		table.insert(key.c_str(), copied.c_str(), true);  // The copy must outlive copied.
+	}
+	CHECK(table.size() == TEST_ENTRIES);
+	for (int i = 0; i < TEST_ENTRIES; ++i)
+	{
+		std::string key = "key" + std::to_string(i);
+		CHECK(table.find(key.c_str(), &value));
+		CHECK(value != nullptr && strcmp(value, ("value" + std::to_string(i)).c_str()) == 0);
+	}
+	CHECK(!table.find("key", &value));
+	CHECK(!table.find("key10000", &value));
+	CHECK(!table.find("", &value));
+
+	// Replacing keeps the size.
+	table.insert("key5", "replaced", true);
+	CHECK(table.size() == TEST_ENTRIES);
+	CHECK(table.find("key5", &value) && strcmp(value, "replaced") == 0);
+	CHECK(table.findKey("value5") == nullptr);
+	CHECK(table.findKey("value77") != nullptr && strcmp(table.findKey("value77"), "key77") == 0);
+
+	// Values which aren't copied are stored as they are, including NULL.
+	static const char notCopied[] = "not copied";
+	table.insert("pointer", notCopied, false);
+	CHECK(table.find("pointer", &value) && value == notCopied);
+	table.insert("null", nullptr, false);
+	CHECK(table.find("null", &value) && value == nullptr);
+	CHECK(table.size() == TEST_ENTRIES + 2);
+
+	// Keys are compared as strings, and the empty string is a key like any other.
+	char key[] = "key42";
+	table.insert("", "empty", true);
+	CHECK(table.find(key, &value) && strcmp(value, "value42") == 0);
+	CHECK(table.find("", &value) && strcmp(value, "empty") == 0);
+
+	table.clear();
+	CHECK(table.size() == 0);
+	CHECK(!table.find("key1", &value));
+	table.insert("key1", "again", true);
+	CHECK(table.find("key1", &value) && strcmp(value, "again") == 0);
+
+	// FNV-1a test vectors.
+	CHECK(StringHashTable::hash("") == 2166136261u);
+	CHECK(StringHashTable::hash("a") == 0xe40c292cu);
+
+	printf("stringhashtest: %d entries OK\n", TEST_ENTRIES);
+	return 0;
+}
@@ -37,6 +37,15 @@ function skirmish
 	#run "--autogame --loadskirmish=$1" "$1 : Loading and running"
 }
 
+function skirmish_concurrent
+{
+	echo
+	echo " ==== $1 : $2 (concurrent AI scripts) ===="
+	printf "[General]\nconcurrentscripts=true\n" > tmp/config
+	run "--skirmish=$1.json --autogame" "$1 : Running"
+	rm -f tmp/config
+}
+
 echo
 echo "Running Warzone2100 automated tests"
 echo -n "Time is: "
@@ -51,3 +60,6 @@ cam FASTPLAY "Fastplay"
 skirmish highground "Basic skirmish"
 skirmish miza "All AIs"
 skirmish miza_challenge "Best AI vs 7 old timers"
+skirmish rangequeries "Batched range queries"
+skirmish_concurrent highground "Basic skirmish"
+skirmish_concurrent miza "All AIs"
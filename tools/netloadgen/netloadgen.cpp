@@ -0,0 +1,775 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file netloadgen.cpp
+ *
+ * Network load generator. Connects a number of fake clients to a host, walks them through the
+ * join handshake, and once the game has started keeps them in step with the host while they
+ * send random droid orders. Reports bandwidth, ping round trips and host tick jitter.
+ *
+ * The clients don't run the simulation. They mirror the host's GAME_GAME_TIME messages (same
+ * game time and CRC), so the host doesn't see them as desynched, and the droid orders they send
+ * refer to random droid IDs, which the host ignores unless they happen to belong to the player.
+ *
+ * With --relay-port, a single client is connected, which sends no orders, and everything it gets from
+ * the host is passed on to downstream spectators, see relay.cpp.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/netplay/netplay.h"
+#include "lib/netplay/netqueue.h"
+#include "lib/netplay/netsocket.h"
+#include "lib/netplay/netlog.h"
+#include "lib/netplay/netplay_config.h"
+
+#include "netloadgen.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+static const uint32_t DROID_ORDER_LOCATION = 1;  ///< LocOrder, see the SubType enum in src/multibot.cpp.
+static const uint32_t DROID_ORDER_MOVE = 2;      ///< DORDER_MOVE, see src/orderdef.h.
+static const int32_t WORLD_TILE_UNITS = 128;     ///< World units per map tile.
+static const uint64_t GAME_UPDATE_MICROS = 100000;  ///< GAME_TICKS_PER_UPDATE, in microseconds.
+
+struct Options
+{
+	std::string host = "127.0.0.1";
+	unsigned port = 2100;
+	unsigned clients = 10;
+	std::string name = "loadbot";
+	std::string password;
+	bool ready = false;
+	unsigned joinInterval = 250;        ///< Milliseconds between connection attempts.
+	unsigned duration = 0;              ///< Seconds to run, or 0 to run until every client has disconnected.
+	double ordersPerSecond = 2.;        ///< Per client.
+	unsigned droidsPerOrder = 4;
+	uint32_t droidIdMin = 1;
+	uint32_t droidIdMax = 2000;
+	int mapWidth = 64;                  ///< In tiles.
+	int mapHeight = 64;
+	unsigned pingInterval = 1000;       ///< Milliseconds.
+	unsigned reportInterval = 5;        ///< Seconds.
+	uint32_t seed = 0;
+	bool haveSeed = false;
+	unsigned relayPort = 0;             ///< Port to take spectators on, or 0 to not relay.
+	unsigned relayDelay = 0;            ///< Milliseconds to hold back the game from spectators.
+};
+
+/// Running minimum, maximum and mean of durations, in microseconds.
+struct TimingStats
+{
+	void add(uint64_t micros)
+	{
+		minValue = count == 0 ? micros : std::min(minValue, micros);
+		maxValue = std::max(maxValue, micros);
+		total += micros;
+		++count;
+	}
+	void merge(TimingStats const &other)
+	{
+		if (other.count == 0)
+		{
+			return;
+		}
+		minValue = count == 0 ? other.minValue : std::min(minValue, other.minValue);
+		maxValue = std::max(maxValue, other.maxValue);
+		total += other.total;
+		count += other.count;
+	}
+	double meanMs() const
+	{
+		return count != 0 ? total / 1000. / count : 0.;
+	}
+
+	uint64_t count = 0;
+	uint64_t total = 0;
+	uint64_t minValue = 0;
+	uint64_t maxValue = 0;
+};
+
+struct TrafficStats
+{
+	uint64_t messages[2] = {0, 0};      ///< [received]
+	uint64_t bytes[2] = {0, 0};         ///< [received] Before compression.
+	uint64_t rawBytes[2] = {0, 0};      ///< [received] After compression.
+	uint64_t orders = 0;                ///< GAME_DROIDINFO messages sent.
+	uint64_t gameTimeEchoes = 0;        ///< GAME_GAME_TIME messages mirrored back to the host.
+	TimingStats pingRoundTrip;          ///< Time for the host to answer our NET_PING.
+	TimingStats tickInterval;           ///< Time between GAME_GAME_TIME messages from the host.
+
+	void merge(TrafficStats const &other)
+	{
+		for (int i = 0; i < 2; ++i)
+		{
+			messages[i] += other.messages[i];
+			bytes[i] += other.bytes[i];
+			rawBytes[i] += other.rawBytes[i];
+		}
+		orders += other.orders;
+		gameTimeEchoes += other.gameTimeEchoes;
+		pingRoundTrip.merge(other.pingRoundTrip);
+		tickInterval.merge(other.tickInterval);
+	}
+};
+
+enum ClientState
+{
+	CLIENT_IDLE,                        ///< Not connected yet.
+	CLIENT_JOINING,                     ///< Sent NET_JOIN, waiting for NET_ACCEPTED.
+	CLIENT_LOBBY,                       ///< Accepted, waiting for NET_FIREUP.
+	CLIENT_LOADING,                     ///< Got NET_FIREUP, waiting for the host's first GAME_GAME_TIME.
+	CLIENT_PLAYING,
+	CLIENT_REJECTED,                    ///< Refused by the host.
+	CLIENT_FAILED,                      ///< Couldn't connect.
+	CLIENT_DISCONNECTED,
+	CLIENT_NUM_STATES
+};
+
+static const char *clientStateNames[CLIENT_NUM_STATES] = {"idle", "joining", "lobby", "loading", "playing", "rejected", "failed", "disconnected"};
+
+struct LoadClient
+{
+	unsigned id = 0;
+	std::string name;
+	ClientState state = CLIENT_IDLE;
+	Socket *socket = nullptr;
+	NetQueuePair queues;                ///< Only queues.receive is used, messages are written to the socket directly.
+	uint8_t index = 0;                  ///< Player index given by the host.
+	uint8_t rejectReason = 0;
+	uint64_t joinTime = 0;
+	uint64_t lastPingTime = 0;
+	uint64_t pingSentTime = 0;          ///< 0 if not waiting for a reply.
+	uint64_t lastTickTime = 0;
+	double pendingOrders = 0.;
+	bool wantFlush = false;
+	TrafficStats stats;
+};
+
+static Options options;
+static std::vector<std::unique_ptr<LoadClient>> clients;
+static SocketSet *socketSet = nullptr;
+static std::mt19937 randomGenerator;
+static uint64_t startTime = 0;
+
+static void printUsage(const char *program)
+{
+	fprintf(stderr,
+	        "Usage: %s [options]\n"
+	        "  --host HOST              Host to connect to (default 127.0.0.1)\n"
+	        "  --port PORT              Port to connect to (default 2100)\n"
+	        "  --clients N              Number of clients to connect (default 10)\n"
+	        "  --name NAME              Player name prefix (default loadbot)\n"
+	        "  --password PASSWORD      Game password\n"
+	        "  --ready                  Mark the clients as ready once accepted\n"
+	        "  --join-interval MS       Delay between connection attempts (default 250)\n"
+	        "  --duration SECONDS       Stop after this long (default: run until all clients are gone)\n"
+	        "  --orders-per-sec N       Droid orders sent per client per second once in game (default 2)\n"
+	        "  --droids-per-order N     Droids per order (default 4)\n"
+	        "  --droid-ids MIN-MAX      Range of droid IDs to give orders to (default 1-2000)\n"
+	        "  --map-size WxH           Map size in tiles, for order destinations (default 64x64)\n"
+	        "  --ping-interval MS       Delay between pings sent to the host (default 1000)\n"
+	        "  --report-interval S      Delay between progress reports (default 5)\n"
+	        "  --seed N                 Random seed\n"
+	        "  --relay-port PORT        Connect one idle client, and relay the game to spectators connecting on PORT\n"
+	        "  --relay-delay SECONDS    Delay before spectators see the game (default 0, keep below 50 on release hosts)\n"
+	        "  --debug PART             Enable debug output for PART, such as net\n",
+	        program);
+}
+
+static bool parseOptions(int argc, char **argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		char const *value = i + 1 < argc ? argv[i + 1] : nullptr;
+		auto needValue = [&]() {
+			if (value == nullptr)
+			{
+				fprintf(stderr, "Missing value for %s\n", arg.c_str());
+				return false;
+			}
+			++i;
+			return true;
+		};
+
+		if (arg == "--ready")
+		{
+			options.ready = true;
+		}
+		else if (arg == "--help" || arg == "-h")
+		{
+			return false;
+		}
+		else if (!needValue())
+		{
+			return false;
+		}
+		else if (arg == "--host")
+		{
+			options.host = value;
+		}
+		else if (arg == "--port")
+		{
+			options.port = strtoul(value, nullptr, 10);
+		}
+		else if (arg == "--clients")
+		{
+			options.clients = strtoul(value, nullptr, 10);
+		}
+		else if (arg == "--name")
+		{
+			options.name = value;
+		}
+		else if (arg == "--password")
+		{
+			options.password = value;
+		}
+		else if (arg == "--join-interval")
+		{
+			options.joinInterval = strtoul(value, nullptr, 10);
+		}
+		else if (arg == "--duration")
+		{
+			options.duration = strtoul(value, nullptr, 10);
+		}
+		else if (arg == "--orders-per-sec")
+		{
+			options.ordersPerSecond = std::max(strtod(value, nullptr), 0.);
+		}
+		else if (arg == "--droids-per-order")
+		{
+			options.droidsPerOrder = std::max<unsigned>(strtoul(value, nullptr, 10), 1);
+		}
+		else if (arg == "--droid-ids")
+		{
+			if (sscanf(value, "%u-%u", &options.droidIdMin, &options.droidIdMax) != 2 || options.droidIdMin > options.droidIdMax)
+			{
+				fprintf(stderr, "Bad droid ID range \"%s\"\n", value);
+				return false;
+			}
+		}
+		else if (arg == "--map-size")
+		{
+			if (sscanf(value, "%dx%d", &options.mapWidth, &options.mapHeight) != 2 || options.mapWidth <= 0 || options.mapHeight <= 0)
+			{
+				fprintf(stderr, "Bad map size \"%s\"\n", value);
+				return false;
+			}
+		}
+		else if (arg == "--ping-interval")
+		{
+			options.pingInterval = strtoul(value, nullptr, 10);
+		}
+		else if (arg == "--report-interval")
+		{
+			options.reportInterval = std::max<unsigned>(strtoul(value, nullptr, 10), 1);
+		}
+		else if (arg == "--seed")
+		{
+			options.seed = strtoul(value, nullptr, 10);
+			options.haveSeed = true;
+		}
+		else if (arg == "--relay-port")
+		{
+			options.relayPort = strtoul(value, nullptr, 10);
+		}
+		else if (arg == "--relay-delay")
+		{
+			options.relayDelay = static_cast<unsigned>(std::max(strtod(value, nullptr), 0.) * 1000.);
+		}
+		else if (arg == "--debug")
+		{
+			if (!debug_enable_switch(value))
+			{
+				fprintf(stderr, "Unknown debug part \"%s\"\n", value);
+				return false;
+			}
+		}
+		else
+		{
+			fprintf(stderr, "Unknown option %s\n", arg.c_str());
+			return false;
+		}
+	}
+	return options.clients > 0;
+}
+
+static void disconnectClient(LoadClient &client, ClientState state)
+{
+	if (client.socket != nullptr)
+	{
+		SocketSet_DelSocket(socketSet, client.socket);
+		socketClose(client.socket);
+		client.socket = nullptr;
+	}
+	client.state = state;
+}
+
+static void sendMessage(LoadClient &client, NetMessage const &message)
+{
+	if (client.socket == nullptr)
+	{
+		return;
+	}
+
+	uint8_t *rawData = message.rawDataDup();
+	ssize_t rawLen = message.rawLen();
+	size_t compressedRawLen = 0;
+	ssize_t result = writeAll(client.socket, rawData, rawLen, &compressedRawLen);
+	delete[] rawData;
+
+	if (result == SOCKET_ERROR)
+	{
+		debug(LOG_WARNING, "%s: failed to send message: %s", client.name.c_str(), strSockError(getSockErr()));
+		disconnectClient(client, CLIENT_DISCONNECTED);
+		return;
+	}
+	client.stats.messages[0] += 1;
+	client.stats.bytes[0] += rawLen;
+	client.stats.rawBytes[0] += compressedRawLen;
+	client.wantFlush = true;
+}
+
+/// Sends game messages the way NETflushGameQueues() does on a client, as NET_SHARE_GAME_QUEUE, relayed by the host to everyone.
+static void sendGameMessages(LoadClient &client, std::vector<NetMessage> const &messages)
+{
+	MessageEncoder share(NET_SHARE_GAME_QUEUE);
+	share.uint8(client.index).uint32(static_cast<uint32_t>(messages.size()));
+	for (auto const &message : messages)
+	{
+		share.netMessage(message);
+	}
+
+	MessageEncoder relay(NET_SEND_TO_PLAYER);
+	relay.uint8(client.index).uint8(NET_ALL_PLAYERS).netMessage(share.message);
+	sendMessage(client, relay.message);
+}
+
+static NetMessage randomDroidOrder(LoadClient const &client)
+{
+	std::uniform_int_distribution<int32_t> tileX(0, options.mapWidth - 1);
+	std::uniform_int_distribution<int32_t> tileY(0, options.mapHeight - 1);
+	std::uniform_int_distribution<uint32_t> droidId(options.droidIdMin, options.droidIdMax);
+
+	std::vector<uint32_t> droids;
+	for (unsigned n = 0; n < options.droidsPerOrder; ++n)
+	{
+		droids.push_back(droidId(randomGenerator));
+	}
+	std::sort(droids.begin(), droids.end());
+	droids.erase(std::unique(droids.begin(), droids.end()), droids.end());
+
+	// Same layout as NETQueuedDroidInfo() and sendQueuedDroidInfo() in src/multibot.cpp.
+	MessageEncoder order(GAME_DROIDINFO);
+	order.uint8(client.index);
+	order.uint32(DROID_ORDER_LOCATION);
+	order.uint32(DROID_ORDER_MOVE);
+	order.int32(tileX(randomGenerator) * WORLD_TILE_UNITS + WORLD_TILE_UNITS / 2);
+	order.int32(tileY(randomGenerator) * WORLD_TILE_UNITS + WORLD_TILE_UNITS / 2);
+	order.boolean(false);
+	order.uint32(static_cast<uint32_t>(droids.size()));
+	uint32_t prevDroidId = 0;
+	for (uint32_t id : droids)
+	{
+		order.uint32(id - prevDroidId);
+		prevDroidId = id;
+	}
+	return order.message;
+}
+
+/// Mirrors the host's GAME_GAME_TIME, together with any droid orders due by now.
+static void gameTick(LoadClient &client, NetMessage const &hostGameTime, uint64_t now)
+{
+	if (client.state == CLIENT_LOADING)
+	{
+		debug(LOG_INFO, "%s: game started", client.name.c_str());
+		client.state = CLIENT_PLAYING;
+	}
+	if (client.lastTickTime != 0)
+	{
+		client.stats.tickInterval.add(now - client.lastTickTime);
+	}
+	client.lastTickTime = now;
+
+	std::vector<NetMessage> messages;
+	client.pendingOrders += options.ordersPerSecond * GAME_UPDATE_MICROS / 1000000.;
+	for (; client.pendingOrders >= 1.; client.pendingOrders -= 1.)
+	{
+		messages.push_back(randomDroidOrder(client));
+		++client.stats.orders;
+	}
+
+	// Sending the host's own latency, game time and CRC means the host's sync check passes, and we never hold up the game.
+	messages.push_back(hostGameTime);
+	++client.stats.gameTimeEchoes;
+
+	sendGameMessages(client, messages);
+}
+
+static void handleGameQueue(LoadClient &client, NetMessage const &message, uint64_t now)
+{
+	MessageDecoder decoder(message);
+	uint8_t player = decoder.uint8();
+	uint32_t num = decoder.uint32();
+	for (uint32_t n = 0; n < num && decoder.valid(); ++n)
+	{
+		NetMessage gameMessage = decoder.netMessage();
+		if (gameMessage.type == GAME_GAME_TIME && player == NET_HOST_ONLY && decoder.valid())
+		{
+			gameTick(client, gameMessage, now);
+		}
+	}
+}
+
+static void handleMessage(LoadClient &client, NetMessage const &message, uint64_t now)
+{
+	MessageDecoder decoder(message);
+
+	switch (message.type)
+	{
+	case NET_ACCEPTED:
+		client.index = decoder.uint8();
+		client.state = CLIENT_LOBBY;
+		debug(LOG_INFO, "%s: accepted as player %u after %.1f ms", client.name.c_str(), (unsigned)client.index, (now - client.joinTime) / 1000.);
+		if (options.ready)
+		{
+			MessageEncoder ready(NET_READY_REQUEST);
+			ready.uint8(client.index).boolean(true);
+			sendMessage(client, ready.message);
+		}
+		break;
+	case NET_REJECTED:
+		client.rejectReason = decoder.uint8();
+		debug(LOG_INFO, "%s: rejected, reason %u", client.name.c_str(), (unsigned)client.rejectReason);
+		disconnectClient(client, CLIENT_REJECTED);
+		break;
+	case NET_PING:
+		{
+			uint8_t sender = decoder.uint8();
+			bool isNew = decoder.boolean();
+			if (isNew)
+			{
+				// Answer with an empty signature, which the host accepts from players without an identity.
+				MessageEncoder reply(NET_PING);
+				reply.uint8(client.index).boolean(false).bytes(std::vector<uint8_t>());
+				sendMessage(client, reply.message);
+			}
+			else if (sender == NET_HOST_ONLY && client.pingSentTime != 0)
+			{
+				client.stats.pingRoundTrip.add(now - client.pingSentTime);
+				client.pingSentTime = 0;
+			}
+			break;
+		}
+	case NET_FIREUP:
+		if (client.state == CLIENT_LOBBY)
+		{
+			debug(LOG_INFO, "%s: host is starting the game", client.name.c_str());
+			client.state = CLIENT_LOADING;
+		}
+		break;
+	case NET_KICK:
+		{
+			uint32_t player = decoder.uint32();
+			if (player == client.index)
+			{
+				debug(LOG_INFO, "%s: kicked", client.name.c_str());
+				disconnectClient(client, CLIENT_DISCONNECTED);
+			}
+			break;
+		}
+	case NET_HOST_DROPPED:
+		debug(LOG_INFO, "%s: host dropped", client.name.c_str());
+		disconnectClient(client, CLIENT_DISCONNECTED);
+		break;
+	case NET_SHARE_GAME_QUEUE:
+		// Messages from the host's own game queues are sent directly, not wrapped in NET_SEND_TO_PLAYER.
+		if (client.state == CLIENT_LOADING || client.state == CLIENT_PLAYING)
+		{
+			handleGameQueue(client, message, now);
+		}
+		break;
+	default:
+		// Player info, chat, and game messages relayed from other clients are only counted.
+		break;
+	}
+}
+
+static void readClient(LoadClient &client, uint64_t now)
+{
+	uint8_t buffer[MaxMsgSize];
+	size_t rawBytes = 0;
+	ssize_t size = readNoInt(client.socket, buffer, sizeof(buffer), &rawBytes);
+	client.stats.rawBytes[1] += rawBytes;
+
+	if ((size == 0 && socketReadDisconnected(client.socket)) || size == SOCKET_ERROR)
+	{
+		debug(LOG_INFO, "%s: connection closed by host", client.name.c_str());
+		disconnectClient(client, client.state == CLIENT_JOINING ? CLIENT_REJECTED : CLIENT_DISCONNECTED);
+		return;
+	}
+
+	NetQueue &receive = client.queues.receive;
+	receive.writeRawData(buffer, size);
+	while (client.socket != nullptr && receive.haveMessage())
+	{
+		NetMessage const &message = receive.getMessage();
+		client.stats.messages[1] += 1;
+		client.stats.bytes[1] += message.rawLen();
+		// Pings are between the host and the relay itself, the spectators are never pinged.
+		if (options.relayPort != 0 && client.state >= CLIENT_LOBBY && message.type != NET_PING)
+		{
+			relayRecord(message, now);
+		}
+		handleMessage(client, message, now);
+		receive.popMessage();
+	}
+}
+
+/// Connects, and does the version check and NET_JOIN parts of NETjoinGame().
+static bool connectClient(LoadClient &client, uint64_t now)
+{
+	SocketAddress *hosts = resolveHost(options.host.c_str(), options.port);
+	if (hosts == nullptr)
+	{
+		debug(LOG_ERROR, "Cannot resolve hostname \"%s\": %s", options.host.c_str(), strSockError(getSockErr()));
+		return false;
+	}
+	client.socket = socketOpenAny(hosts, 5000);
+	deleteSocketAddress(hosts);
+	if (client.socket == nullptr)
+	{
+		debug(LOG_ERROR, "%s: cannot connect to [%s]:%u, %s", client.name.c_str(), options.host.c_str(), options.port, strSockError(getSockErr()));
+		return false;
+	}
+
+	uint32_t version[2] = {htonl(NETCODE_VERSION_MAJOR), htonl(NETCODE_VERSION_MINOR)};
+	uint32_t result = ERROR_CONNECTION;
+	if (writeAll(client.socket, version, sizeof(version)) == SOCKET_ERROR
+	    || readAll(client.socket, &result, sizeof(result), 1500) != sizeof(result))
+	{
+		debug(LOG_ERROR, "%s: couldn't send version", client.name.c_str());
+		return false;
+	}
+	result = ntohl(result);
+	if (result != ERROR_NOERROR)
+	{
+		client.rejectReason = static_cast<uint8_t>(result);
+		debug(LOG_INFO, "%s: version check failed, error %u", client.name.c_str(), result);
+		return false;
+	}
+
+	socketBeginCompression(client.socket);
+	SocketSet_AddSocket(socketSet, client.socket);
+
+	MessageEncoder join(NET_JOIN);
+	join.string(client.name, 64).string("", modlist_string_size).string(options.password, password_string_size);
+	client.state = CLIENT_JOINING;
+	client.joinTime = now;
+	client.lastPingTime = now;
+	sendMessage(client, join.message);
+	return client.socket != nullptr;
+}
+
+static void printReport(uint64_t now, bool final)
+{
+	unsigned states[CLIENT_NUM_STATES] = {0};
+	TrafficStats total;
+	for (auto const &client : clients)
+	{
+		++states[client->state];
+		total.merge(client->stats);
+	}
+
+	double seconds = std::max((now - startTime) / 1000000., 0.001);
+	printf("[%7.1fs]", seconds);
+	for (int i = 0; i < CLIENT_NUM_STATES; ++i)
+	{
+		if (states[i] != 0)
+		{
+			printf(" %s %u", clientStateNames[i], states[i]);
+		}
+	}
+	printf(" | sent %llu msgs %.1f kB/s (%.1f kB/s wire) | recv %llu msgs %.1f kB/s (%.1f kB/s wire) | orders %llu\n",
+	       (unsigned long long)total.messages[0], total.bytes[0] / 1024. / seconds, total.rawBytes[0] / 1024. / seconds,
+	       (unsigned long long)total.messages[1], total.bytes[1] / 1024. / seconds, total.rawBytes[1] / 1024. / seconds,
+	       (unsigned long long)total.orders);
+	printf("           ping rtt n %llu mean %.1f ms max %.1f ms | host tick interval n %llu mean %.1f ms max %.1f ms\n",
+	       (unsigned long long)total.pingRoundTrip.count, total.pingRoundTrip.meanMs(), total.pingRoundTrip.maxValue / 1000.,
+	       (unsigned long long)total.tickInterval.count, total.tickInterval.meanMs(), total.tickInterval.maxValue / 1000.);
+
+	if (final)
+	{
+		printf("\n%-16s %6s %-12s %10s %10s %8s %9s %9s %9s\n", "client", "player", "state", "sent kB", "recv kB", "orders", "ping ms", "tick ms", "tick max");
+		for (auto const &client : clients)
+		{
+			TrafficStats const &stats = client->stats;
+			printf("%-16s %6d %-12s %10.1f %10.1f %8llu %9.1f %9.1f %9.1f\n",
+			       client->name.c_str(), client->state >= CLIENT_LOBBY && client->state <= CLIENT_PLAYING ? (int)client->index : -1, clientStateNames[client->state],
+			       stats.bytes[0] / 1024., stats.bytes[1] / 1024., (unsigned long long)stats.orders,
+			       stats.pingRoundTrip.meanMs(), stats.tickInterval.meanMs(), stats.tickInterval.maxValue / 1000.);
+		}
+	}
+	fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+	debug_init();
+	debug_register_callback(debug_callback_stderr, nullptr, nullptr, nullptr);
+
+	if (!parseOptions(argc, argv))
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+	if (options.relayPort != 0)
+	{
+		options.clients = 1;
+		options.ordersPerSecond = 0.;
+	}
+	if (options.clients > MAX_CONNECTED_PLAYERS - 1)
+	{
+		debug(LOG_INFO, "Host has at most %u free slots, the other %u clients should be rejected.", MAX_CONNECTED_PLAYERS - 1, options.clients - (MAX_CONNECTED_PLAYERS - 1));
+	}
+	randomGenerator.seed(options.haveSeed ? options.seed : static_cast<uint32_t>(time(nullptr)));
+
+	SOCKETinit();
+	socketSet = allocSocketSet();
+	if (options.relayPort != 0 && !relayInit(options.relayPort, options.relayDelay))
+	{
+		deleteSocketSet(socketSet);
+		SOCKETshutdown();
+		debug_exit();
+		return 1;
+	}
+
+	for (unsigned i = 0; i < options.clients; ++i)
+	{
+		clients.emplace_back(new LoadClient);
+		clients.back()->id = i;
+		clients.back()->name = options.name + std::to_string(i + 1);
+	}
+
+	startTime = NETlogMicros();
+	uint64_t nextJoinTime = startTime;
+	uint64_t nextReportTime = startTime + options.reportInterval * 1000000ull;
+	size_t nextClient = 0;
+
+	for (;;)
+	{
+		uint64_t now = NETlogMicros();
+
+		if (nextClient < clients.size() && now >= nextJoinTime)
+		{
+			LoadClient &client = *clients[nextClient++];
+			if (!connectClient(client, now))
+			{
+				disconnectClient(client, client.rejectReason != 0 ? CLIENT_REJECTED : CLIENT_FAILED);
+			}
+			nextJoinTime = NETlogMicros() + options.joinInterval * 1000ull;
+		}
+
+		if (checkSockets(socketSet, 10) > 0)
+		{
+			now = NETlogMicros();
+			for (auto &client : clients)
+			{
+				if (client->socket != nullptr && socketReadReady(client->socket))
+				{
+					readClient(*client, now);
+				}
+			}
+		}
+
+		now = NETlogMicros();
+		bool anyConnected = false;
+		for (auto &client : clients)
+		{
+			if (client->socket == nullptr)
+			{
+				continue;
+			}
+			anyConnected = true;
+
+			if (client->state >= CLIENT_LOBBY && options.pingInterval != 0 && now - client->lastPingTime >= options.pingInterval * 1000ull)
+			{
+				// An unanswered ping is dropped, like in sendPing().
+				std::vector<uint8_t> challenge(8);
+				for (auto &b : challenge)
+				{
+					b = static_cast<uint8_t>(randomGenerator());
+				}
+				MessageEncoder ping(NET_PING);
+				ping.uint8(client->index).boolean(true);
+				ping.message.data.insert(ping.message.data.end(), challenge.begin(), challenge.end());
+				sendMessage(*client, ping.message);
+				client->lastPingTime = now;
+				client->pingSentTime = now;
+			}
+
+			if (client->wantFlush && client->socket != nullptr)
+			{
+				size_t compressedRawLen = 0;
+				socketFlush(client->socket, &compressedRawLen);
+				client->stats.rawBytes[0] += compressedRawLen;
+				client->wantFlush = false;
+			}
+		}
+
+		if (options.relayPort != 0)
+		{
+			LoadClient &upstream = *clients.front();
+			relayUpdate(now, upstream.index, upstream.socket != nullptr || nextClient == 0, [&upstream](NetMessage const &message) {
+				sendMessage(upstream, message);
+			});
+		}
+
+		if (now >= nextReportTime)
+		{
+			printReport(now, false);
+			nextReportTime += options.reportInterval * 1000000ull;
+		}
+
+		bool timeUp = options.duration != 0 && now - startTime >= options.duration * 1000000ull;
+		bool allGone = nextClient == clients.size() && !anyConnected && (options.relayPort == 0 || relayFinished());
+		if (timeUp || allGone)
+		{
+			break;
+		}
+	}
+
+	printReport(NETlogMicros(), true);
+
+	for (auto &client : clients)
+	{
+		disconnectClient(*client, client->state);
+	}
+	relayShutdown();
+	deleteSocketSet(socketSet);
+	SOCKETshutdown();
+	debug_exit();
+	return 0;
+}
@@ -0,0 +1,162 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file netloadgen.h
+ *
+ * Message encoding shared by the load generator and the spectator relay.
+ */
+
+#ifndef __INCLUDED_TOOLS_NETLOADGEN_NETLOADGEN_H__
+#define __INCLUDED_TOOLS_NETLOADGEN_NETLOADGEN_H__
+
+#include "lib/netplay/netplay.h"
+#include "lib/netplay/netqueue.h"
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+
+/// Small encoder for NetMessage payloads, using the same wire format as the queue() functions in lib/netplay/nettypes.cpp.
+class MessageEncoder
+{
+public:
+	MessageEncoder(uint8_t type) : message(type) {}
+
+	MessageEncoder &uint8(uint8_t v)
+	{
+		message.data.push_back(v);
+		return *this;
+	}
+	MessageEncoder &uint16(uint16_t v)
+	{
+		return uint8(uint8_t(v >> 8)).uint8(uint8_t(v));
+	}
+	MessageEncoder &uint32(uint32_t v)
+	{
+		bool moreBytes = true;
+		for (unsigned n = 0; moreBytes; ++n)
+		{
+			uint8_t b;
+			moreBytes = encode_uint32_t(b, v, n);
+			uint8(b);
+		}
+		return *this;
+	}
+	MessageEncoder &int32(int32_t v)
+	{
+		return uint32((uint32_t)v << 1 ^ (0 - ((uint32_t)v >> 31)));
+	}
+	MessageEncoder &boolean(bool v)
+	{
+		return uint8(v ? 1 : 0);
+	}
+	MessageEncoder &string(std::string const &v, size_t maxLen)
+	{
+		uint16_t len = static_cast<uint16_t>(std::min(v.size(), maxLen - 1));
+		uint16(len);
+		message.data.insert(message.data.end(), v.begin(), v.begin() + len);
+		return *this;
+	}
+	MessageEncoder &bytes(std::vector<uint8_t> const &v)
+	{
+		uint32(static_cast<uint32_t>(v.size()));
+		message.data.insert(message.data.end(), v.begin(), v.end());
+		return *this;
+	}
+	MessageEncoder &netMessage(NetMessage const &v)
+	{
+		return uint8(v.type).bytes(v.data);
+	}
+
+	NetMessage message;
+};
+
+/// Decoder counterpart of MessageEncoder. Reading past the end yields zeros, and makes valid() return false.
+class MessageDecoder
+{
+public:
+	MessageDecoder(NetMessage const &m) : reader(m) {}
+
+	uint8_t uint8()
+	{
+		uint8_t v;
+		reader.byte(v);
+		return v;
+	}
+	uint16_t uint16()
+	{
+		uint16_t v = uint8() << 8;
+		return v | uint8();
+	}
+	uint32_t uint32()
+	{
+		uint32_t v = 0;
+		bool moreBytes = true;
+		for (unsigned n = 0; moreBytes; ++n)
+		{
+			moreBytes = decode_uint32_t(uint8(), v, n);
+		}
+		return v;
+	}
+	bool boolean()
+	{
+		return uint8() != 0;
+	}
+	void skip(size_t len)
+	{
+		reader.index += len;
+	}
+	NetMessage netMessage()
+	{
+		NetMessage m(uint8());
+		uint32_t len = uint32();
+		if (reader.index + len <= reader.message->data.size())
+		{
+			auto begin = reader.message->data.begin() + reader.index;
+			m.data.assign(begin, begin + len);
+		}
+		skip(len);
+		return m;
+	}
+	bool valid() const
+	{
+		return reader.valid();
+	}
+
+private:
+	MessageReader reader;
+};
+
+/// Starts listening for downstream spectators on port. Game messages are passed on delayMs milliseconds after the relay got them.
+bool relayInit(unsigned port, unsigned delayMs);
+/// Adds a message received from the host to the stream sent to the downstream spectators.
+void relayRecord(NetMessage const &message, uint64_t now);
+/**
+ * Accepts and reads from downstream spectators, and sends them whatever part of the stream is due.
+ * @param playerIndex Player index of the relay's own connection, given to spectators as their NET_ACCEPTED.
+ * @param upstreamConnected False once the relay lost the host, so the spectators are dropped after the rest of the stream.
+ * @param sendUpstream Sends a message to the host on the relay's own connection.
+ */
+void relayUpdate(uint64_t now, uint8_t playerIndex, bool upstreamConnected, std::function<void (NetMessage const &)> const &sendUpstream);
+/// True once the upstream connection is gone and every spectator got the whole stream.
+bool relayFinished();
+void relayShutdown();
+
+#endif // __INCLUDED_TOOLS_NETLOADGEN_NETLOADGEN_H__
@@ -0,0 +1,164 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file platform.cpp
+ *
+ * Headless replacements for the parts of the SDL backend (lib/sdl/main_sdl.cpp) which
+ * lib/netplay/netsocket.cpp and lib/framework need, implemented with the standard library.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
+
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+struct WZ_THREAD
+{
+	std::thread thread;
+	int result = 0;
+};
+
+struct WZ_MUTEX
+{
+	std::recursive_mutex mutex;  // SDL mutexes are recursive.
+};
+
+struct WZ_SEMAPHORE
+{
+	std::mutex mutex;
+	std::condition_variable condition;
+	int value = 0;
+};
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+void wzToggleFullscreen()
+{
+}
+
+bool wzIsFullscreen()
+{
+	return false;
+}
+
+int wzGetTicks()
+{
+	return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+}
+
+void wzDisplayDialog(DialogType type, const char *title, const char *message)
+{
+	(void)type;
+	fprintf(stderr, "%s: %s\n", title, message);
+}
+
+void wzDelay(unsigned int delay)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+}
+
+/**************************/
+/***    Thread support  ***/
+/**************************/
+WZ_THREAD *wzThreadCreate(int (*threadFunc)(void *), void *data)
+{
+	WZ_THREAD *thread = new WZ_THREAD;
+	thread->thread = std::thread([thread, threadFunc, data]() { thread->result = threadFunc(data); });
+	return thread;
+}
+
+unsigned long wzThreadID(WZ_THREAD *thread)
+{
+	std::thread::id id = thread != nullptr ? thread->thread.get_id() : std::this_thread::get_id();
+	return static_cast<unsigned long>(std::hash<std::thread::id>()(id));
+}
+
+int wzThreadJoin(WZ_THREAD *thread)
+{
+	thread->thread.join();
+	int result = thread->result;
+	delete thread;
+	return result;
+}
+
+void wzThreadDetach(WZ_THREAD *thread)
+{
+	thread->thread.detach();  // The WZ_THREAD is leaked, since the detached thread still writes its result to it.
+}
+
+void wzThreadStart(WZ_THREAD *thread)
+{
+	(void)thread; // no-op
+}
+
+void wzYieldCurrentThread()
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(40));
+}
+
+WZ_MUTEX *wzMutexCreate()
+{
+	return new WZ_MUTEX;
+}
+
+void wzMutexDestroy(WZ_MUTEX *mutex)
+{
+	delete mutex;
+}
+
+void wzMutexLock(WZ_MUTEX *mutex)
+{
+	mutex->mutex.lock();
+}
+
+void wzMutexUnlock(WZ_MUTEX *mutex)
+{
+	mutex->mutex.unlock();
+}
+
+WZ_SEMAPHORE *wzSemaphoreCreate(int startValue)
+{
+	WZ_SEMAPHORE *semaphore = new WZ_SEMAPHORE;
+	semaphore->value = startValue;
+	return semaphore;
+}
+
+void wzSemaphoreDestroy(WZ_SEMAPHORE *semaphore)
+{
+	delete semaphore;
+}
+
+void wzSemaphoreWait(WZ_SEMAPHORE *semaphore)
+{
+	std::unique_lock<std::mutex> lock(semaphore->mutex);
+	semaphore->condition.wait(lock, [semaphore]() { return semaphore->value > 0; });
+	--semaphore->value;
+}
+
+void wzSemaphorePost(WZ_SEMAPHORE *semaphore)
+{
+	{
+		std::lock_guard<std::mutex> lock(semaphore->mutex);
+		++semaphore->value;
+	}
+	semaphore->condition.notify_one();
+}
@@ -0,0 +1,335 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file relay.cpp
+ *
+ * Spectator relay. The relay joins the host as a single idle player, and passes everything the host
+ * sends it on to any number of downstream game clients, which see the game as that player. The host
+ * only pays for one connection, however many spectators are watching.
+ *
+ * Downstream clients do the usual version check and NET_JOIN, and are accepted straight away. The
+ * stream is recorded from the relay's own NET_ACCEPTED onwards, so a spectator joining late replays
+ * the lobby and the game from the start, and catches up. Once the recording grows past
+ * MAX_RELAY_HISTORY, what every spectator has been sent is dropped, and no more spectators are taken.
+ *
+ * Nothing a spectator sends reaches the host, except for the first NET_DATA_CHECK, which the host
+ * needs to keep the relay in the game. The data checks of the other spectators are compared with it
+ * instead, and spectators with different data are dropped, as the host would kick them.
+ *
+ * The game itself has no headless mode to run the relay in, so it's part of netloadgen, which is
+ * headless, and shares the netplay code with the game.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/netplay/netsocket.h"
+#include "lib/netplay/netplay_config.h"
+
+#include "netloadgen.h"
+
+#include <deque>
+#include <memory>
+
+struct RelayMessage
+{
+	uint64_t time;                      ///< When the relay got the message from the host.
+	std::vector<uint8_t> rawData;       ///< Message as it goes on the wire, before compression.
+};
+
+#define MAX_RELAY_HISTORY (256 * 1024 * 1024)  // Bytes.
+#define VERSION_CHECK_TIMEOUT 1500              // Milliseconds.
+
+struct Spectator
+{
+	unsigned id = 0;
+	Socket *socket = nullptr;
+	NetQueuePair queues;                ///< Only queues.receive is used.
+	uint64_t connectTime = 0;
+	uint8_t version[8];                 ///< NETCODE_VERSION_MAJOR and NETCODE_VERSION_MINOR, as they arrive.
+	size_t versionBytes = 0;
+	bool versionChecked = false;
+	bool joined = false;                ///< Got NET_JOIN, and was sent NET_ACCEPTED.
+	size_t nextMessage = 0;             ///< Number of the next message to send, counting from the start of the recording.
+	uint64_t bytesSent = 0;
+};
+
+static Socket *listenSocket = nullptr;
+static SocketSet *spectatorSet = nullptr;
+static std::vector<std::unique_ptr<Spectator>> spectators;
+static std::deque<RelayMessage> history;
+static size_t historyStart = 0;        ///< Number of the first message in history, after dropping the start.
+static size_t historyBytes = 0;
+static uint64_t relayDelay = 0;        ///< Microseconds.
+static unsigned nextSpectatorId = 1;
+static std::vector<uint8_t> dataCheck; ///< The NET_DATA_CHECK passed on to the host, if any.
+static bool upstreamLost = false;
+
+static void dropSpectator(Spectator &spectator, char const *reason)
+{
+	debug(LOG_INFO, "Relay: spectator %u %s, got %.1f kB", spectator.id, reason, spectator.bytesSent / 1024.);
+	SocketSet_DelSocket(spectatorSet, spectator.socket);
+	socketClose(spectator.socket);
+	spectator.socket = nullptr;
+}
+
+static bool sendRaw(Spectator &spectator, uint8_t const *rawData, size_t rawLen)
+{
+	if (writeAll(spectator.socket, rawData, rawLen) == SOCKET_ERROR)
+	{
+		dropSpectator(spectator, "disconnected");
+		return false;
+	}
+	spectator.bytesSent += rawLen;
+	return true;
+}
+
+static bool sendMessage(Spectator &spectator, NetMessage const &message)
+{
+	uint8_t *rawData = message.rawDataDup();
+	bool result = sendRaw(spectator, rawData, message.rawLen());
+	delete[] rawData;
+	return result;
+}
+
+/// The version check part of NETallowJoining(). New clients send NETCODE_VERSION_MAJOR and NETCODE_VERSION_MINOR, uncompressed.
+/// Takes whatever has arrived, so a slow spectator doesn't hold up the others.
+static void checkVersion(Spectator &spectator)
+{
+	ssize_t size = readNoInt(spectator.socket, spectator.version + spectator.versionBytes, sizeof(spectator.version) - spectator.versionBytes);
+	if ((size == 0 && socketReadDisconnected(spectator.socket)) || size == SOCKET_ERROR)
+	{
+		dropSpectator(spectator, "sent no version");
+		return;
+	}
+	spectator.versionBytes += size;
+	if (spectator.versionBytes < sizeof(spectator.version))
+	{
+		return;
+	}
+	uint32_t version[2];
+	memcpy(version, spectator.version, sizeof(version));
+	bool correct = ntohl(version[0]) == NETCODE_VERSION_MAJOR && ntohl(version[1]) == NETCODE_VERSION_MINOR;
+	uint32_t result = htonl(correct ? ERROR_NOERROR : ERROR_WRONGVERSION);
+	if (writeAll(spectator.socket, &result, sizeof(result)) == SOCKET_ERROR || !correct)
+	{
+		dropSpectator(spectator, "has the wrong version");
+		return;
+	}
+	socketBeginCompression(spectator.socket);
+	spectator.versionChecked = true;
+}
+
+static void handleSpectatorMessage(Spectator &spectator, NetMessage const &message, uint8_t playerIndex, std::function<void (NetMessage const &)> const &sendUpstream)
+{
+	switch (message.type)
+	{
+	case NET_JOIN:
+		if (!spectator.joined)
+		{
+			MessageDecoder decoder(message);
+			uint16_t nameLen = decoder.uint16();
+			std::string name(message.data.begin() + 2, message.data.begin() + std::min<size_t>(2 + nameLen, message.data.size()));
+			debug(LOG_INFO, "Relay: spectator %u joined as \"%s\"", spectator.id, name.c_str());
+
+			MessageEncoder accepted(NET_ACCEPTED);
+			accepted.uint8(playerIndex);
+			spectator.joined = sendMessage(spectator, accepted.message);
+		}
+		break;
+	case NET_DATA_CHECK:
+		// Without it, a release build host kicks the relay a minute after the game started.
+		if (dataCheck.empty())
+		{
+			debug(LOG_INFO, "Relay: passing on the data check from spectator %u", spectator.id);
+			sendUpstream(message);
+			dataCheck = message.data;
+		}
+		else if (message.data != dataCheck)
+		{
+			dropSpectator(spectator, "has different data");
+		}
+		break;
+	default:
+		// Game messages, chat and pings from spectators would come from the relay's player, so aren't passed on.
+		break;
+	}
+}
+
+static void readSpectator(Spectator &spectator, uint8_t playerIndex, std::function<void (NetMessage const &)> const &sendUpstream)
+{
+	if (!spectator.versionChecked)
+	{
+		checkVersion(spectator);
+		return;
+	}
+
+	uint8_t buffer[MaxMsgSize];
+	ssize_t size = readNoInt(spectator.socket, buffer, sizeof(buffer));
+	if ((size == 0 && socketReadDisconnected(spectator.socket)) || size == SOCKET_ERROR)
+	{
+		dropSpectator(spectator, "disconnected");
+		return;
+	}
+
+	NetQueue &receive = spectator.queues.receive;
+	receive.writeRawData(buffer, size);
+	while (spectator.socket != nullptr && receive.haveMessage())
+	{
+		handleSpectatorMessage(spectator, receive.getMessage(), playerIndex, sendUpstream);
+		receive.popMessage();
+	}
+}
+
+bool relayInit(unsigned port, unsigned delayMs)
+{
+	listenSocket = socketListen(port);
+	if (listenSocket == nullptr)
+	{
+		debug(LOG_ERROR, "Relay: cannot listen on port %u: %s", port, strSockError(getSockErr()));
+		return false;
+	}
+	spectatorSet = allocSocketSet();
+	relayDelay = delayMs * 1000ull;
+	debug(LOG_INFO, "Relay: listening on port %u, delay %u ms", port, delayMs);
+	return true;
+}
+
+void relayRecord(NetMessage const &message, uint64_t now)
+{
+	uint8_t *rawData = message.rawDataDup();
+	history.push_back(RelayMessage{now, std::vector<uint8_t>(rawData, rawData + message.rawLen())});
+	historyBytes += message.rawLen();
+	delete[] rawData;
+}
+
+/// Once the history is too big, drops the messages every spectator has been sent. Spectators joining after that couldn't
+/// start from the beginning, so aren't taken anymore.
+static void trimHistory()
+{
+	if (historyBytes <= MAX_RELAY_HISTORY)
+	{
+		return;
+	}
+	size_t keepFrom = historyStart + history.size();
+	for (auto &spectator : spectators)
+	{
+		keepFrom = std::min(keepFrom, spectator->joined ? spectator->nextMessage : historyStart);
+	}
+	if (historyStart == 0 && keepFrom > 0)
+	{
+		debug(LOG_INFO, "Relay: recorded %.1f MB, not taking more spectators", historyBytes / (1024. * 1024.));
+	}
+	while (historyStart < keepFrom)
+	{
+		historyBytes -= history.front().rawData.size();
+		history.pop_front();
+		++historyStart;
+	}
+}
+
+void relayUpdate(uint64_t now, uint8_t playerIndex, bool upstreamConnected, std::function<void (NetMessage const &)> const &sendUpstream)
+{
+	upstreamLost = upstreamLost || !upstreamConnected;
+
+	// Only take spectators once the relay itself has a player index to give them, and while they can see it all.
+	Socket *newSocket = !upstreamLost && !history.empty() && historyStart == 0 ? socketAccept(listenSocket) : nullptr;
+	if (newSocket != nullptr)
+	{
+		spectators.emplace_back(new Spectator);
+		spectators.back()->id = nextSpectatorId++;
+		spectators.back()->socket = newSocket;
+		spectators.back()->connectTime = now;
+		SocketSet_AddSocket(spectatorSet, newSocket);
+		debug(LOG_INFO, "Relay: spectator %u connected from %s", spectators.back()->id, getSocketTextAddress(newSocket));
+	}
+
+	if (checkSockets(spectatorSet, 0) > 0)
+	{
+		for (auto &spectator : spectators)
+		{
+			if (spectator->socket != nullptr && socketReadReady(spectator->socket))
+			{
+				readSpectator(*spectator, playerIndex, sendUpstream);
+			}
+		}
+	}
+
+	for (auto &spectator : spectators)
+	{
+		if (spectator->socket != nullptr && !spectator->versionChecked && now - spectator->connectTime > VERSION_CHECK_TIMEOUT * 1000ull)
+		{
+			dropSpectator(*spectator, "sent no version");
+		}
+		if (spectator->socket == nullptr || !spectator->joined)
+		{
+			continue;
+		}
+		bool sentAny = false;
+		while (spectator->nextMessage < historyStart + history.size() && history[spectator->nextMessage - historyStart].time + relayDelay <= now)
+		{
+			std::vector<uint8_t> const &rawData = history[spectator->nextMessage - historyStart].rawData;
+			if (!sendRaw(*spectator, rawData.data(), rawData.size()))
+			{
+				break;
+			}
+			++spectator->nextMessage;
+			sentAny = true;
+		}
+		if (sentAny && spectator->socket != nullptr)
+		{
+			socketFlush(spectator->socket);
+		}
+		if (upstreamLost && spectator->socket != nullptr && spectator->nextMessage == historyStart + history.size())
+		{
+			dropSpectator(*spectator, "got the end of the game");
+		}
+	}
+
+	spectators.erase(std::remove_if(spectators.begin(), spectators.end(), [](std::unique_ptr<Spectator> const &spectator) { return spectator->socket == nullptr; }), spectators.end());
+	trimHistory();
+}
+
+bool relayFinished()
+{
+	return upstreamLost && spectators.empty();
+}
+
+void relayShutdown()
+{
+	for (auto &spectator : spectators)
+	{
+		if (spectator->socket != nullptr)
+		{
+			dropSpectator(*spectator, "dropped at shutdown");
+		}
+	}
+	spectators.clear();
+	if (spectatorSet != nullptr)
+	{
+		deleteSocketSet(spectatorSet);
+		spectatorSet = nullptr;
+	}
+	if (listenSocket != nullptr)
+	{
+		socketClose(listenSocket);
+		listenSocket = nullptr;
+	}
+	history.clear();
+	historyStart = 0;
+	historyBytes = 0;
+}